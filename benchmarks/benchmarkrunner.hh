@@ -0,0 +1,505 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \copydoc Ewoms::BenchmarkRunner
+ */
+#ifndef EWOMS_BENCHMARK_RUNNER_HH
+#define EWOMS_BENCHMARK_RUNNER_HH
+
+#include <ewoms/common/start.hh>
+#include <ewoms/common/timer.hh>
+#include <ewoms/disc/common/fvbaseproperties.hh>
+#include <ewoms/io/restart.hh>
+
+#include <dune/common/parallel/mpihelper.hh>
+#include <dune/grid/common/gridenums.hh>
+
+#include <sys/stat.h>
+#include <dirent.h>
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+BEGIN_PROPERTIES
+
+NEW_TYPE_TAG(Benchmark);
+
+NEW_PROP_TAG(Scalar);
+NEW_PROP_TAG(LinearSolverBackend);
+NEW_PROP_TAG(BenchmarkOutputFile);
+NEW_PROP_TAG(BenchmarkMinTime);
+NEW_PROP_TAG(BenchmarkMinRepetitions);
+NEW_PROP_TAG(BenchmarkMaxRepetitions);
+
+//! By default, the results are written to the standard output
+SET_STRING_PROP(Benchmark, BenchmarkOutputFile, "");
+
+//! Each benchmark is repeated for at least one second...
+SET_SCALAR_PROP(Benchmark, BenchmarkMinTime, 1.0);
+
+//! ... but at least three and at most 1000 times
+SET_INT_PROP(Benchmark, BenchmarkMinRepetitions, 3);
+SET_INT_PROP(Benchmark, BenchmarkMaxRepetitions, 1000);
+
+//! The time for writing VTK files ought to include the actual writing
+SET_BOOL_PROP(Benchmark, EnableAsyncVtkOutput, false);
+
+END_PROPERTIES
+
+namespace Ewoms {
+
+/*!
+ * \brief Measures the performance of the computational kernels of a simulator.
+ *
+ * Instead of running a simulation, the initial solution of the problem is used to time
+ * the individual parts of a Newton iteration:
+ *
+ * - the linearization of single elements without assembling the global system
+ * - the linearization of the whole domain including the Jacobian assembly
+ * - the sparse matrix-vector product of the overlapping matrix used by the linear solver
+ * - the setup and the application of the preconditioner
+ * - a single iteration of the Krylov solver
+ * - the exchange of the halo of a global vector
+ * - writing the VTK output and a restart file
+ *
+ * Each part is repeated until both, a minimum number of repetitions and a minimum
+ * time have been reached. The median of the wall clock time is reported, with MPI
+ * the one of the slowest process. The results are written in JSON format, so they can
+ * be compared between versions. The size of the problem is controlled by the usual
+ * run-time parameters of the respective grid, e.g., `--cells-x` or
+ * `--grid-global-refinements`.
+ *
+ * The linear solver related benchmarks require a linear solver backend which is
+ * derived from Ewoms::Linear::ParallelBaseBackend.
+ */
+template <class TypeTag>
+class BenchmarkRunner
+{
+    typedef typename GET_PROP_TYPE(TypeTag, Scalar) Scalar;
+    typedef typename GET_PROP_TYPE(TypeTag, Simulator) Simulator;
+    typedef typename GET_PROP_TYPE(TypeTag, ThreadManager) ThreadManager;
+    typedef typename GET_PROP_TYPE(TypeTag, ElementContext) ElementContext;
+    typedef typename GET_PROP_TYPE(TypeTag, GlobalEqVector) GlobalEqVector;
+    typedef typename GET_PROP_TYPE(TypeTag, LinearSolverBackend) LinearSolverBackend;
+    typedef typename GET_PROP_TYPE(TypeTag, GridCommHandleFactory)::HaloExchange HaloExchange;
+
+    // exposes the internals of the linear solver backend which are required to time
+    // the individual parts of the linear solver
+    class LinearSolverProbe_ : public LinearSolverBackend
+    {
+        typedef LinearSolverBackend ParentType;
+
+    public:
+        LinearSolverProbe_(const Simulator& simulator)
+            : ParentType(simulator)
+        {}
+
+        using ParentType::overlappingMatrix_;
+        using ParentType::overlappingb_;
+        using ParentType::overlappingx_;
+        using ParentType::preparePreconditioner_;
+        using ParentType::cleanupPreconditioner_;
+
+        typedef typename ParentType::ParallelOperator ParallelOperator;
+        typedef typename ParentType::OverlappingVector OverlappingVector;
+    };
+
+    struct Result_
+    {
+        std::string name;
+        double seconds;
+        double minSeconds;
+        int repetitions;
+        double throughput;
+        std::string throughputUnit;
+    };
+
+public:
+    /*!
+     * \brief Register the run-time parameters of the benchmark runner.
+     */
+    static void registerParameters()
+    {
+        EWOMS_REGISTER_PARAM(TypeTag, std::string, BenchmarkOutputFile,
+                             "The name of the file to which the results of the benchmarks "
+                             "are written in JSON format (empty: standard output)");
+        EWOMS_REGISTER_PARAM(TypeTag, Scalar, BenchmarkMinTime,
+                             "The minimum wall clock time [s] for which each benchmark "
+                             "is repeated");
+        EWOMS_REGISTER_PARAM(TypeTag, int, BenchmarkMinRepetitions,
+                             "The minimum number of times each benchmark is repeated");
+        EWOMS_REGISTER_PARAM(TypeTag, int, BenchmarkMaxRepetitions,
+                             "The maximum number of times each benchmark is repeated");
+    }
+
+    /*!
+     * \brief Set up the simulator and run all benchmarks.
+     *
+     * This is the equivalent of Ewoms::start() for benchmarks.
+     */
+    static int start(int argc, char **argv, const std::string& benchmarkName)
+    {
+        Dune::MPIHelper::instance(argc, argv);
+
+        registerAllParameters_<TypeTag>(/*finalizeRegistration=*/false);
+        registerParameters();
+        EWOMS_END_PARAM_REGISTRATION(TypeTag);
+
+        int status = setupParameters_<TypeTag>(argc, const_cast<const char**>(argv),
+                                               /*registerParams=*/false);
+        if (status == 1)
+            return 1;
+        if (status == 2)
+            return 0;
+
+        ThreadManager::init();
+
+        Simulator simulator(/*verbose=*/false);
+        BenchmarkRunner runner(simulator, benchmarkName);
+        runner.run();
+
+        return 0;
+    }
+
+    BenchmarkRunner(Simulator& simulator, const std::string& benchmarkName)
+        : simulator_(simulator)
+        , benchmarkName_(benchmarkName)
+    {
+        minTime_ = EWOMS_GET_PARAM(TypeTag, Scalar, BenchmarkMinTime);
+        minRepetitions_ = EWOMS_GET_PARAM(TypeTag, int, BenchmarkMinRepetitions);
+        maxRepetitions_ = EWOMS_GET_PARAM(TypeTag, int, BenchmarkMaxRepetitions);
+    }
+
+    /*!
+     * \brief Run all benchmarks and write the results.
+     */
+    void run()
+    {
+        simulator_.model().applyInitialSolution();
+
+        benchmarkLinearization_();
+        benchmarkLinearSolver_();
+        benchmarkHaloExchange_();
+        benchmarkOutput_();
+
+        const std::string& outputFile = EWOMS_GET_PARAM(TypeTag, std::string, BenchmarkOutputFile);
+        if (simulator_.gridView().comm().rank() == 0) {
+            if (outputFile.empty())
+                writeJson_(std::cout);
+            else {
+                std::ofstream os(outputFile);
+                writeJson_(os);
+            }
+        }
+    }
+
+private:
+    void benchmarkLinearization_()
+    {
+        const auto& gridView = simulator_.gridView();
+        auto& model = simulator_.model();
+        size_t numElements = numInteriorElements_();
+
+        // the local linearization of all elements, but without assembling the global
+        // Jacobian matrix and without threads
+        ElementContext elemCtx(simulator_);
+        auto& localLinearizer = model.localLinearizer(/*threadId=*/0);
+        measure_("elementLinearization", numElements, "elements/s",
+                 [&]()
+                 {
+                     auto elemIt = gridView.template begin</*codim=*/0>();
+                     const auto& elemEndIt = gridView.template end</*codim=*/0>();
+                     for (; elemIt != elemEndIt; ++elemIt) {
+                         const auto& elem = *elemIt;
+                         if (elem.partitionType() == Dune::InteriorEntity)
+                             localLinearizer.linearize(elemCtx, elem);
+                     }
+                 });
+
+        // linearization of the whole domain, i.e., including the assembly of the global
+        // system of equations
+        auto& linearizer = model.linearizer();
+        measure_("jacobianAssembly", numElements, "elements/s",
+                 [&]()
+                 { linearizer.linearizeDomain(); });
+    }
+
+    void benchmarkLinearSolver_()
+    {
+        typedef typename LinearSolverProbe_::ParallelOperator ParallelOperator;
+        typedef typename LinearSolverProbe_::OverlappingVector OverlappingVector;
+
+        auto& linearizer = simulator_.model().linearizer();
+        linearizer.linearizeDomain();
+        auto& jacobian = linearizer.jacobian();
+        auto residual = linearizer.residual();
+
+        LinearSolverProbe_ linearSolver(simulator_);
+        linearSolver.prepare(jacobian, residual);
+
+        const auto& overlappingMatrix = *linearSolver.overlappingMatrix_;
+        size_t numNonZeros = sum_(overlappingMatrix.nonzeroes());
+
+        OverlappingVector x(*linearSolver.overlappingb_);
+        OverlappingVector y(x);
+        x = 1.0;
+
+        ParallelOperator parOperator(overlappingMatrix);
+        measure_("spmv", numNonZeros, "blocks/s",
+                 [&]()
+                 { parOperator.apply(x, y); });
+
+        double precSetupSeconds =
+            measure_("preconditionerSetup", numNonZeros, "blocks/s",
+                     [&]()
+                     {
+                         linearSolver.preparePreconditioner_();
+                         linearSolver.cleanupPreconditioner_();
+                     }).seconds;
+
+        auto preconditioner = linearSolver.preparePreconditioner_();
+        measure_("preconditionerApply", numNonZeros, "blocks/s",
+                 [&]()
+                 {
+                     y = 0.0;
+                     preconditioner->apply(y, x);
+                 });
+        linearSolver.cleanupPreconditioner_();
+
+        // the cost of a single iteration of the Krylov solver. the preconditioner is
+        // discarded before each solve so that its setup is always included, i.e., it
+        // must be subtracted.
+        size_t numIterations = 0;
+        GlobalEqVector solution(residual.size());
+        Result_ solveResult =
+            measure_("linearSolve", numNonZeros, "blocks/s",
+                     [&]()
+                     {
+                         linearSolver.cleanupPreconditioner_();
+                         solution = 0.0;
+                         linearSolver.solve(solution);
+                         numIterations = linearSolver.iterations();
+                     });
+
+        double iterationSeconds =
+            std::max(0.0, solveResult.seconds - precSetupSeconds)/std::max<size_t>(numIterations, 1);
+        if (numIterations > 0 && iterationSeconds > 0.0)
+            results_.push_back(Result_{"krylovIteration",
+                                       iterationSeconds,
+                                       iterationSeconds,
+                                       solveResult.repetitions,
+                                       numNonZeros/iterationSeconds,
+                                       "blocks/s"});
+    }
+
+    void benchmarkHaloExchange_()
+    {
+        HaloExchange haloExchange;
+        haloExchange.update(simulator_.gridView(), simulator_.model().dofMapper(),
+                            Dune::InteriorBorder_All_Interface);
+
+        GlobalEqVector vector(simulator_.model().numGridDof());
+        vector = 1.0;
+        measure_("haloExchange", 1, "exchanges/s",
+                 [&]()
+                 { haloExchange.sync(vector); });
+    }
+
+    void benchmarkOutput_()
+    {
+        auto& problem = simulator_.problem();
+        const std::string& outputDir = problem.outputDir();
+        const std::string& prefix = problem.name();
+
+        // the VTK writer creates new files for each invocation, so the bandwidth is
+        // given by the growth of the output directory
+        size_t vtkBytes = 0;
+        Result_& vtkResult =
+            measure_("vtkWrite", 0, "",
+                     [&]()
+                     {
+                         size_t sizeBefore = directorySize_(outputDir, prefix);
+                         problem.writeOutput(/*isSubStep=*/false, /*verbose=*/false);
+                         vtkBytes = directorySize_(outputDir, prefix) - sizeBefore;
+                     });
+        setThroughput_(vtkResult, sum_(vtkBytes), "bytes/s");
+
+        size_t restartBytes = 0;
+        Result_& restartResult =
+            measure_("restartWrite", 0, "",
+                     [&]()
+                     {
+                         Ewoms::Restart res;
+                         res.serializeBegin(simulator_);
+                         simulator_.serialize(res);
+                         problem.serialize(res);
+                         simulator_.model().serialize(res);
+                         res.serializeEnd();
+
+                         restartBytes = fileSize_(res.fileName());
+                     });
+        setThroughput_(restartResult, sum_(restartBytes), "bytes/s");
+    }
+
+    // repeat a function until the minimum time and number of repetitions are reached
+    // and record the median of the wall clock time. all processes must call this
+    // collectively.
+    template <class Fn>
+    Result_& measure_(const std::string& name,
+                            size_t workPerRepetition,
+                            const std::string& throughputUnit,
+                            Fn fn)
+    {
+        const auto& comm = simulator_.gridView().comm();
+
+        std::vector<double> samples;
+        Ewoms::Timer totalTimer;
+        totalTimer.start();
+        while (true) {
+            Ewoms::Timer timer;
+            timer.start();
+            fn();
+            samples.push_back(timer.stop());
+
+            // the decision to stop must be the same on all processes
+            int numRepetitions = static_cast<int>(samples.size());
+            double elapsed = comm.max(totalTimer.realTimeElapsed());
+            if (numRepetitions >= maxRepetitions_
+                || (numRepetitions >= minRepetitions_ && elapsed >= minTime_))
+                break;
+        }
+
+        std::sort(samples.begin(), samples.end());
+        Result_ result;
+        result.name = name;
+        result.seconds = comm.max(samples[samples.size()/2]);
+        result.minSeconds = comm.max(samples.front());
+        result.repetitions = static_cast<int>(samples.size());
+        result.throughput = 0.0;
+        if (workPerRepetition > 0 && result.seconds > 0.0) {
+            result.throughput = workPerRepetition/result.seconds;
+            result.throughputUnit = throughputUnit;
+        }
+
+        results_.push_back(result);
+        return results_.back();
+    }
+
+    static void setThroughput_(Result_& result, size_t work, const std::string& unit)
+    {
+        if (result.seconds > 0.0) {
+            result.throughput = work/result.seconds;
+            result.throughputUnit = unit;
+        }
+    }
+
+    size_t numInteriorElements_() const
+    {
+        const auto& gridView = simulator_.gridView();
+        size_t n = 0;
+        auto elemIt = gridView.template begin</*codim=*/0>();
+        const auto& elemEndIt = gridView.template end</*codim=*/0>();
+        for (; elemIt != elemEndIt; ++elemIt)
+            if (elemIt->partitionType() == Dune::InteriorEntity)
+                ++n;
+        return n;
+    }
+
+    // the sum of a quantity over all processes
+    size_t sum_(size_t value) const
+    { return static_cast<size_t>(simulator_.gridView().comm().sum(static_cast<double>(value))); }
+
+    static size_t fileSize_(const std::string& fileName)
+    {
+        struct stat fileStat;
+        if (stat(fileName.c_str(), &fileStat) != 0)
+            return 0;
+        return static_cast<size_t>(fileStat.st_size);
+    }
+
+    // the total size of all files in a directory whose name starts with a given prefix
+    static size_t directorySize_(const std::string& dirName, const std::string& prefix)
+    {
+        size_t result = 0;
+        DIR* dir = opendir(dirName.c_str());
+        if (!dir)
+            return 0;
+
+        while (const struct dirent* entry = readdir(dir)) {
+            const std::string fileName(entry->d_name);
+            if (fileName.compare(0, prefix.size(), prefix) == 0)
+                result += fileSize_(dirName + "/" + fileName);
+        }
+        closedir(dir);
+
+        return result;
+    }
+
+    void writeJson_(std::ostream& os) const
+    {
+        const auto& gridView = simulator_.gridView();
+        const auto& model = simulator_.model();
+
+        os << "{\n"
+           << "  \"benchmark\": \"" << benchmarkName_ << "\",\n"
+           << "  \"numProcesses\": " << gridView.comm().size() << ",\n"
+           << "  \"numThreadsPerProcess\": " << ThreadManager::maxThreads() << ",\n"
+           << "  \"numElements\": " << sum_(numInteriorElements_()) << ",\n"
+           << "  \"numDofPerProcess\": " << model.numGridDof() << ",\n"
+           << "  \"numEq\": " << GET_PROP_VALUE(TypeTag, NumEq) << ",\n"
+           << "  \"results\": [\n";
+        for (size_t i = 0; i < results_.size(); ++i) {
+            const auto& r = results_[i];
+            os << "    {\"name\": \"" << r.name << "\""
+               << ", \"seconds\": " << r.seconds
+               << ", \"minSeconds\": " << r.minSeconds
+               << ", \"repetitions\": " << r.repetitions;
+            if (!r.throughputUnit.empty())
+                os << ", \"throughput\": " << r.throughput
+                   << ", \"throughputUnit\": \"" << r.throughputUnit << "\"";
+            os << "}" << ((i + 1 < results_.size()) ? "," : "") << "\n";
+        }
+        os << "  ]\n"
+           << "}\n";
+    }
+
+    Simulator& simulator_;
+    std::string benchmarkName_;
+    double minTime_;
+    int minRepetitions_;
+    int maxRepetitions_;
+
+    // the references returned by measure_() are only valid until the next benchmark
+    // is run
+    std::vector<Result_> results_;
+};
+
+} // namespace Ewoms
+
+#endif
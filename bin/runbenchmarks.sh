@@ -0,0 +1,45 @@
+#! /bin/bash
+#
+# Runs the eWoms benchmarks for a number of problem sizes and writes
+# the results in JSON format to the "benchmark-results" directory.
+#
+# Usage:
+#
+# runbenchmarks.sh BENCHMARK_NAME [BENCHMARK_NAME ...]
+#
+# The problem sizes are specified by the number of global grid
+# refinements that are applied to the benchmark's default grid. They
+# can be changed using the BENCHMARK_REFINEMENTS environment variable
+# (default: "0 1 2"). Additional command line arguments for all
+# benchmarks can be passed via BENCHMARK_ARGS.
+#
+
+if test "$#" -lt 1; then
+    echo "Usage:"
+    echo
+    echo "runbenchmarks.sh BENCHMARK_NAME [BENCHMARK_NAME ...]"
+    exit 1
+fi
+
+REFINEMENTS="${BENCHMARK_REFINEMENTS:-0 1 2}"
+RESULT_DIR="benchmark-results"
+mkdir -p "$RESULT_DIR"
+
+for BENCHMARK in "$@"; do
+    for REFINEMENT in $REFINEMENTS; do
+        RESULT_FILE="$RESULT_DIR/${BENCHMARK}-refinement${REFINEMENT}.json"
+        echo "######################"
+        echo "# Running benchmark '$BENCHMARK' with $REFINEMENT global refinement(s)"
+        echo "######################"
+        if ! "./bin/benchmark_$BENCHMARK" \
+                --grid-global-refinements="$REFINEMENT" \
+                --benchmark-output-file="$RESULT_FILE" \
+                $BENCHMARK_ARGS; then
+            echo "Benchmark '$BENCHMARK' failed"
+            exit 1
+        fi
+        echo "Results written to '$RESULT_FILE'"
+    done
+done
+
+exit 0
@@ -12,7 +12,7 @@ usage() {
     echo "Usage:"
     echo
     echo "runTest.sh TEST_TYPE TEST_BINARY [TEST_ARGS]"
-    echo "where TEST_TYPE can either be --plain, --simulation or --parallel-simulation=\$NUM_CORES (is '$TEST_TYPE')."
+    echo "where TEST_TYPE can either be --plain, --simulation, --trace or --parallel-simulation=\$NUM_CORES (is '$TEST_TYPE')."
 };
 
 validateResults() {
@@ -226,6 +226,36 @@ EOF
 
         ;;
 
+    "--trace")
+        TRACE_FILE="trace-$RND.json"
+        echo "executing \"$TEST_BINARY $TEST_ARGS --trace-file=$TRACE_FILE\""
+        if ! "$TEST_BINARY" $TEST_ARGS --trace-file="$TRACE_FILE"; then
+            echo "Executing the binary failed!"
+            rm -f "$TRACE_FILE"
+            exit 1
+        fi
+
+        if ! test -r "$TRACE_FILE"; then
+            echo "Trace file $TRACE_FILE has not been written"
+            exit 1
+        fi
+
+        # make sure that the trace is valid JSON and that it contains some events
+        if ! python -c '
+import json, sys
+events = json.load(open(sys.argv[1]))["traceEvents"]
+sys.exit(0 if any("name" in event and "ts" in event for event in events) else 1)
+' "$TRACE_FILE"; then
+            echo "Trace file $TRACE_FILE is not a valid trace in the trace event format"
+            rm "$TRACE_FILE"
+            exit 1
+        fi
+        rm "$TRACE_FILE"
+
+        echo "Test successful"
+        exit 0
+        ;;
+
     "--plain")
         echo "executing \"$TEST_BINARY $TEST_ARGS\""
         if ! "$TEST_BINARY" $TEST_ARGS; then
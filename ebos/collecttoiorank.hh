@@ -39,7 +39,13 @@
 
 #include <dune/grid/common/mcmgmapper.hh>
 
+#if HAVE_MPI
+#include <mpi.h>
+#endif
+
+#include <algorithm>
 #include <stdexcept>
+#include <vector>
 
 namespace Ewoms {
 
@@ -100,7 +106,9 @@ public:
         const std::vector<int>& distributedGlobalIndex_;
         IndexMapType& localIndexMap_;
         IndexMapStorageType& indexMaps_;
-        std::map<int, int> globalPosition_;
+        // maps a Cartesian index to the index of the cell in the global grid. -1 means
+        // that the Cartesian cell is inactive.
+        std::vector<int> globalPosition_;
         std::vector<int>& ranks_;
 
     public:
@@ -117,8 +125,12 @@ public:
         {
             size_t size = globalIndex.size();
             // create mapping globalIndex --> localIndex
+            int maxCartIdx = -1;
+            if (size > 0)
+                maxCartIdx = *std::max_element(globalIndex.begin(), globalIndex.end());
+            globalPosition_.resize(static_cast<size_t>(maxCartIdx + 1), -1);
             for (size_t index = 0; index < size; ++index)
-                globalPosition_.insert(std::make_pair(globalIndex[index], index));
+                globalPosition_[globalIndex[index]] = static_cast<int>(index);
 
             // we need to create a mapping from local to global
             if (!indexMaps_.empty()) {
@@ -165,7 +177,8 @@ public:
             for (int index = 0; index < numCells; ++index) {
                 int globalId = -1;
                 buffer.read(globalId);
-                assert(globalPosition_.find(globalId) != globalPosition_.end());
+                assert(0 <= globalId && globalId < static_cast<int>(globalPosition_.size()));
+                assert(globalPosition_[globalId] >= 0);
                 indexMap[index] = globalPosition_[globalId];
                 ranks_[indexMap[index]] = link + 1;
             }
@@ -179,6 +192,11 @@ public:
 
     CollectDataToIORank(const Vanguard& vanguard)
         : toIORankComm_()
+        , numLocalCells_(0)
+#if HAVE_MPI
+        , gatherComm_(static_cast<MPI_Comm>(vanguard.grid().comm()))
+        , gatherRequest_(MPI_REQUEST_NULL)
+#endif
     {
         // index maps only have to be build when reordering is needed
         if (!needsReordering && !isParallel())
@@ -272,8 +290,13 @@ public:
                                                     globalRanks_);
             toIORankComm_.exchange(distIndexMapping);
         }
+
+        setupCellDataGather_();
     }
 
+    ~CollectDataToIORank()
+    { waitForCellDataGather_(); }
+
     class PackUnPackCellData : public P2PCommunicatorType::DataHandleInterface
     {
         const Opm::data::Solution& localCellData_;
@@ -484,6 +507,10 @@ public:
                  const std::map<std::pair<std::string, int>, double>& localBlockData,
                  const Opm::data::Wells& localWellData)
     {
+        // the send buffer of the previous collection may still be in use on the
+        // processes which are not the I/O rank
+        waitForCellDataGather_();
+
         globalCellData_ = {};
         globalBlockData_.clear();
         globalWellData_.clear();
@@ -492,18 +519,23 @@ public:
         if(!needsReordering && !isParallel())
             return;
 
-        // this also packs and unpacks the local buffers one ioRank
-        PackUnPackCellData
-            packUnpackCellData(localCellData,
-                                globalCellData_,
-                                localIndexMap_,
-                                indexMaps_,
-                                numCells(),
-                                isIORank());
+        if (!isParallel()) {
+            // this packs and unpacks the local buffers on the I/O rank
+            PackUnPackCellData
+                packUnpackCellData(localCellData,
+                                   globalCellData_,
+                                   localIndexMap_,
+                                   indexMaps_,
+                                   numCells(),
+                                   isIORank());
 
-        if (!isParallel())
             // no need to collect anything.
             return;
+        }
+
+        // start gathering the cell data. this is non-blocking, so the well and block
+        // data can be exchanged in the meantime.
+        startCellDataGather_(localCellData);
 
         PackUnPackWellData
             packUnpackWellData(localWellData,
@@ -515,11 +547,15 @@ public:
                                 globalBlockData_,
                                 isIORank());
 
-        toIORankComm_.exchange(packUnpackCellData);
         toIORankComm_.exchange(packUnpackWellData);
         toIORankComm_.exchange(packUnpackBlockData);
 
-
+        // only the I/O rank needs to wait for the cell data to arrive. all other
+        // processes can continue with the next time step while the data is transferred.
+        if (isIORank()) {
+            waitForCellDataGather_();
+            unpackCellData_(localCellData);
+        }
 
 #ifndef NDEBUG
         // mkae sure every process is on the same page
@@ -578,6 +614,118 @@ public:
     }
 
 protected:
+    // determine the number of cells of each rank and the global indices of the cells
+    // in the order in which they are received by the I/O rank
+    void setupCellDataGather_()
+    {
+        if (!isParallel())
+            return;
+
+        numLocalCells_ = static_cast<int>(localIndexMap_.size());
+        if (!isIORank())
+            return;
+
+        // the index map of the I/O rank is the last one, the ones of the remaining
+        // ranks are ordered by their link numbers, i.e., rank - 1.
+        int numRanks = toIORankComm_.size();
+        cellsOfRank_.resize(static_cast<size_t>(numRanks));
+        flatGlobalIndex_.clear();
+        for (int rank = 0; rank < numRanks; ++rank) {
+            const IndexMapType& indexMap =
+                (rank == ioRank) ? indexMaps_.back() : indexMaps_[static_cast<size_t>(rank - 1)];
+            cellsOfRank_[static_cast<size_t>(rank)] = static_cast<int>(indexMap.size());
+            flatGlobalIndex_.insert(flatGlobalIndex_.end(), indexMap.begin(), indexMap.end());
+        }
+    }
+
+    // pack all cell data fields of the local process into a single contiguous buffer
+    // and start gathering them on the I/O rank
+    void startCellDataGather_(const Opm::data::Solution& localCellData)
+    {
+        int numFields = static_cast<int>(localCellData.size());
+
+        sendBuffer_.resize(static_cast<size_t>(numFields*numLocalCells_));
+        size_t offset = 0;
+        for (const auto& pair : localCellData) {
+            const auto& data = pair.second.data;
+            for (int i = 0; i < numLocalCells_; ++i) {
+                unsigned localIdx = static_cast<unsigned>(localIndexMap_[static_cast<size_t>(i)]);
+                assert(localIdx < data.size());
+                sendBuffer_[offset++] = data[localIdx];
+            }
+        }
+
+        if (isIORank()) {
+            int numRanks = toIORankComm_.size();
+            recvCounts_.resize(static_cast<size_t>(numRanks));
+            recvDispls_.resize(static_cast<size_t>(numRanks));
+            int totalSize = 0;
+            for (int rank = 0; rank < numRanks; ++rank) {
+                recvCounts_[static_cast<size_t>(rank)] = numFields*cellsOfRank_[static_cast<size_t>(rank)];
+                recvDispls_[static_cast<size_t>(rank)] = totalSize;
+                totalSize += recvCounts_[static_cast<size_t>(rank)];
+            }
+            recvBuffer_.resize(static_cast<size_t>(totalSize));
+        }
+
+#if HAVE_MPI
+        MPI_Igatherv(sendBuffer_.data(),
+                     static_cast<int>(sendBuffer_.size()),
+                     MPI_DOUBLE,
+                     recvBuffer_.data(),
+                     recvCounts_.data(),
+                     recvDispls_.data(),
+                     MPI_DOUBLE,
+                     ioRank,
+                     gatherComm_,
+                     &gatherRequest_);
+#endif // HAVE_MPI
+    }
+
+    // wait until the last gather operation of the cell data has been completed
+    void waitForCellDataGather_()
+    {
+#if HAVE_MPI
+        if (gatherRequest_ != MPI_REQUEST_NULL)
+            MPI_Wait(&gatherRequest_, MPI_STATUS_IGNORE);
+#endif // HAVE_MPI
+    }
+
+    // distribute the contents of the receive buffer to the fields of the global cell
+    // data. the received data of each rank consists of one block per field.
+    void unpackCellData_(const Opm::data::Solution& localCellData)
+    {
+        size_t globalSize = numCells();
+        for (const auto& pair : localCellData) {
+            const std::string& key = pair.first;
+            auto OPM_OPTIM_UNUSED ret = globalCellData_.insert(key, pair.second.dim,
+                                                               std::vector<double>(globalSize),
+                                                               pair.second.target);
+            assert(ret.second);
+        }
+
+        int numRanks = toIORankComm_.size();
+        size_t flatOffset = 0;
+        for (int rank = 0; rank < numRanks; ++rank) {
+            size_t numRankCells = static_cast<size_t>(cellsOfRank_[static_cast<size_t>(rank)]);
+            const double* rankData = recvBuffer_.data() + recvDispls_[static_cast<size_t>(rank)];
+            const int* globalIdx = flatGlobalIndex_.data() + flatOffset;
+
+            size_t fieldIdx = 0;
+            for (const auto& pair : localCellData) {
+                auto& data = globalCellData_.data(pair.first);
+                const double* fieldData = rankData + fieldIdx*numRankCells;
+                for (size_t i = 0; i < numRankCells; ++i) {
+                    assert(static_cast<size_t>(globalIdx[i]) < data.size());
+                    data[static_cast<size_t>(globalIdx[i])] = fieldData[i];
+                }
+                ++ fieldIdx;
+            }
+
+            flatOffset += numRankCells;
+        }
+    }
+
     P2PCommunicatorType toIORankComm_;
     IndexMapType globalCartesianIndex_;
     IndexMapType localIndexMap_;
@@ -586,6 +734,20 @@ protected:
     Opm::data::Solution globalCellData_;
     std::map<std::pair<std::string, int>, double> globalBlockData_;
     Opm::data::Wells globalWellData_;
+
+    // data structures for gathering the cell data using a single collective operation
+    int numLocalCells_;
+    std::vector<int> cellsOfRank_;
+    IndexMapType flatGlobalIndex_;
+    std::vector<int> recvCounts_;
+    std::vector<int> recvDispls_;
+    std::vector<double> sendBuffer_;
+    std::vector<double> recvBuffer_;
+#if HAVE_MPI
+    // the communicator of the grid, which determines the ranks and the cell counts
+    MPI_Comm gatherComm_;
+    MPI_Request gatherRequest_;
+#endif
 };
 
 } // end namespace Ewoms
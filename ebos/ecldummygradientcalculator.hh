@@ -61,6 +61,9 @@ public:
     static void registerParameters()
     { }
 
+    static constexpr bool isTwoPoint()
+    { return true; }
+
     template <bool prepareValues = true, bool prepareGradients = true>
     void prepare(const ElementContext& elemCtx OPM_UNUSED, unsigned timeIdx OPM_UNUSED)
     { }
@@ -82,6 +85,15 @@ public:
         throw std::logic_error("Generic gradients are not supported by the ECL black-oil simulator");
     }
 
+    template <class QuantityCallback>
+    void calculateNormalGradient(Scalar& quantityGradNormal OPM_UNUSED,
+                                 const ElementContext& elemCtx OPM_UNUSED,
+                                 unsigned fapIdx OPM_UNUSED,
+                                 const QuantityCallback& quantityCallback OPM_UNUSED) const
+    {
+        throw std::logic_error("Generic gradients are not supported by the ECL black-oil simulator");
+    }
+
     template <class QuantityCallback>
     Scalar calculateBoundaryValue(const ElementContext& elemCtx OPM_UNUSED,
                                   unsigned fapIdx OPM_UNUSED,
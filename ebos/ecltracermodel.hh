@@ -28,11 +28,26 @@
 #ifndef EWOMS_ECL_TRACER_MODEL_HH
 #define EWOMS_ECL_TRACER_MODEL_HH
 #include "tracervdtable.hh"
+
+#include <ewoms/linear/matrixblock.hh>
+#include <ewoms/linear/overlappingbcrsmatrix.hh>
+#include <ewoms/linear/overlappingblockvector.hh>
+#include <ewoms/linear/overlappingoperator.hh>
+#include <ewoms/linear/overlappingpreconditioner.hh>
+#include <ewoms/linear/overlappingscalarproduct.hh>
+#include <ewoms/parallel/gridcommhandles.hh>
+#include <ewoms/parallel/threadmanager.hh>
+#include <ewoms/parallel/threadedentityiterator.hh>
+
 #include <dune/istl/operators.hh>
 #include <dune/istl/solvers.hh>
 #include <dune/istl/preconditioners.hh>
+
 #include <string>
 #include <vector>
+#include <memory>
+#include <mutex>
+#include <exception>
 #include <iostream>
 
 BEGIN_PROPERTIES
@@ -47,6 +62,13 @@ namespace Ewoms {
  * \ingroup EclBlackOilSimulator
  *
  * \brief A class which handles tracers as specified in ecl deck
+ *
+ * Since the tracers are passive, the linearized system of equations only depends on the
+ * phase the tracer is transported in. All tracers which share the same phase are thus
+ * linearized in a single threaded pass over the grid and they are solved with the same
+ * matrix and preconditioner. In parallel runs, the overlapping linear algebra of eWoms
+ * is used and the concentrations of the ghost elements are synchronized after each
+ * time step.
  */
 template <class TypeTag>
 class EclTracerModel
@@ -60,6 +82,9 @@ class EclTracerModel
     typedef typename GET_PROP_TYPE(TypeTag, ElementContext) ElementContext;
     typedef typename GET_PROP_TYPE(TypeTag, RateVector) RateVector;
     typedef typename GET_PROP_TYPE(TypeTag, Indices) Indices;
+    typedef typename GET_PROP_TYPE(TypeTag, DofMapper) DofMapper;
+    typedef typename GET_PROP_TYPE(TypeTag, BorderListCreator) BorderListCreator;
+    typedef typename GET_PROP_TYPE(TypeTag, ThreadManager) ThreadManager;
 
     typedef Opm::DenseAd::Evaluation<Scalar,1> TracerEvaluation;
 
@@ -72,14 +97,45 @@ class EclTracerModel
     typedef typename GridView::template Codim<0>::Entity Element;
     typedef typename GridView::template Codim<0>::Iterator ElementIterator;
 
+    typedef Dune::FieldVector<Scalar, 1> TracerVectorBlock;
     typedef Dune::BCRSMatrix<Dune::FieldMatrix<Scalar, 1, 1>> TracerMatrix;
-    typedef Dune::BlockVector< Dune::FieldVector<Scalar,1>> TracerVector;
+    typedef Dune::BlockVector<TracerVectorBlock> TracerVector;
+
+    typedef Dune::BCRSMatrix<Ewoms::MatrixBlock<Scalar, 1, 1>> TracerBaseMatrix;
+    typedef Ewoms::Linear::OverlappingBCRSMatrix<TracerBaseMatrix> OverlappingTracerMatrix;
+    typedef typename OverlappingTracerMatrix::Overlap Overlap;
+    typedef Ewoms::Linear::OverlappingBlockVector<TracerVectorBlock, Overlap> OverlappingTracerVector;
+    typedef Ewoms::Linear::OverlappingOperator<OverlappingTracerMatrix,
+                                               OverlappingTracerVector,
+                                               OverlappingTracerVector> TracerOperator;
+    typedef Ewoms::Linear::OverlappingScalarProduct<OverlappingTracerVector, Overlap> TracerScalarProduct;
+#if DUNE_VERSION_NEWER(DUNE_ISTL, 2,7)
+    typedef Dune::SeqILU<OverlappingTracerMatrix,
+                         OverlappingTracerVector,
+                         OverlappingTracerVector> SeqTracerPreconditioner;
+#else
+    typedef Dune::SeqILU0<OverlappingTracerMatrix,
+                          OverlappingTracerVector,
+                          OverlappingTracerVector> SeqTracerPreconditioner;
+#endif
+    typedef Ewoms::Linear::OverlappingPreconditioner<SeqTracerPreconditioner, Overlap> TracerPreconditioner;
+
+    typedef GridCommHandleGhostSync<TracerVectorBlock,
+                                    TracerVector,
+                                    DofMapper,
+                                    /*commCodim=*/0> TracerGhostSyncHandle;
 
 public:
     EclTracerModel(Simulator& simulator)
         : simulator_(simulator)
     { }
 
+    ~EclTracerModel()
+    {
+        for (unsigned threadId = 0; threadId < elementCtx_.size(); ++threadId)
+            delete elementCtx_[threadId];
+    }
+
 
     /*!
      * \brief Initialize all internal data structures needed by the tracer module
@@ -101,22 +157,18 @@ public:
         if (!deck.hasKeyword("TRACER")){
             throw std::runtime_error("the deck does not contain the TRACER keyword");
         }
-        if (simulator_.gridView().comm().size() > 1) {
-            tracerNames_.resize(0);
-            std::cout << "Warning: Tracer model is not compatible with mpi run"  << std::endl;
-            return;
-        }
-
         //how many tracers?
         const int numTracers = deck.getKeyword("TRACER").size();
         tracerNames_.resize(numTracers);
         tracerConcentration_.resize(numTracers);
+        tracerResidual_.resize(numTracers);
         wTracer_.resize(numTracers,0.0);
         storageOfTimeIndex1_.resize(numTracers);
         size_t numAllDof =  simulator_.model().numTotalDof();
 
         // the phase where the tracer is
         tracerPhaseIdx_.resize(numTracers);
+        phaseTracers_.resize(numPhases);
         for (int tracerIdx = 0;  tracerIdx < numTracers; ++tracerIdx) {
             const auto& tracerRecord = deck.getKeyword("TRACER").getRecord(tracerIdx);
             tracerNames_[tracerIdx] = tracerRecord.getItem("NAME").template get<std::string>(0);
@@ -130,8 +182,10 @@ public:
             else
                 throw std::invalid_argument("Tracer: invalid fluid name "
                                             +fluidName+" for "+tracerNames_[tracerIdx]);
+            phaseTracers_[tracerPhaseIdx_[tracerIdx]].push_back(tracerIdx);
 
             tracerConcentration_[tracerIdx].resize(numAllDof);
+            tracerResidual_[tracerIdx].resize(numAllDof);
             storageOfTimeIndex1_[tracerIdx].resize(numAllDof);
             std::string tmp = "TVDPF" +tracerNames_[tracerIdx];
 
@@ -177,10 +231,8 @@ public:
         tracerConcentration0_ = tracerConcentration_;
 
 
-        //tracerResidual
-        tracerResidual_.resize(numAllDof);
         // allocate raw matrix
-        tracerMatrix_ = new TracerMatrix(numAllDof, numAllDof, TracerMatrix::random);
+        tracerMatrix_.reset(new TracerMatrix(numAllDof, numAllDof, TracerMatrix::random));
 
         Stencil stencil(simulator_.gridView(), simulator_.model().dofMapper() );
 
@@ -222,13 +274,29 @@ public:
         }
         tracerMatrix_->endindices();
 
+        // the tracer matrices of all phases exhibit the same sparsity pattern, so a
+        // single overlapping matrix is sufficient for the linear solver. since the
+        // grid does not change during ECL simulations, it only needs to be created
+        // once.
+        BorderListCreator borderListCreator(simulator_.gridView(),
+                                            simulator_.model().dofMapper());
+        overlappingMatrix_.reset(new OverlappingTracerMatrix(*tracerMatrix_,
+                                                             borderListCreator.borderList(),
+                                                             borderListCreator.blackList(),
+                                                             /*overlapSize=*/1));
+
+        // cells which are not present on the local process are mapped to -1
         const int sizeCartGrid = simulator_.vanguard().cartesianSize();
-        cartToGlobal_.resize(sizeCartGrid);
+        cartToGlobal_.resize(sizeCartGrid, -1);
         for (unsigned i = 0; i < numAllDof; ++i) {
             int cartIdx = simulator_.vanguard().cartesianIndex(i);
             cartToGlobal_[cartIdx] = i;
         }
 
+        // create the per-thread context objects
+        elementCtx_.resize(ThreadManager::maxThreads());
+        for (unsigned threadId = 0; threadId != ThreadManager::maxThreads(); ++ threadId)
+            elementCtx_[threadId] = new ElementContext(simulator_);
     }
 
     /*!
@@ -269,17 +337,23 @@ public:
         if (!EWOMS_GET_PARAM(TypeTag, bool, EnableStorageCache))
             return;
 
-        // compute storageCache
-        ElementContext elemCtx(simulator_);
-        auto elemIt = simulator_.gridView().template begin</*codim=*/0>();
-        auto elemEndIt = simulator_.gridView().template end</*codim=*/0>();
-        for (; elemIt != elemEndIt; ++ elemIt) {
-            elemCtx.updateAll(*elemIt);
-            int globalDofIdx = elemCtx.globalSpaceIndex(0, 0);
-            for (int tracerIdx = 0; tracerIdx < numTracers(); ++ tracerIdx){
-                Scalar storageOfTimeIndex1;
-                computeStorage_(storageOfTimeIndex1, elemCtx, 0, /*timIdx=*/0, tracerIdx);
-                storageOfTimeIndex1_[tracerIdx][globalDofIdx] = storageOfTimeIndex1;
+        // compute storageCache. every element only writes the entry of its own degree
+        // of freedom, so this does not need any locking.
+        ThreadedEntityIterator<GridView, /*codim=*/0> threadedElemIt(simulator_.gridView());
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+        {
+            ElementContext& elemCtx = *elementCtx_[ThreadManager::threadId()];
+            ElementIterator elemIt = threadedElemIt.beginParallel();
+            for (; !threadedElemIt.isFinished(elemIt); elemIt = threadedElemIt.increment()) {
+                elemCtx.updateAll(*elemIt);
+                int globalDofIdx = elemCtx.globalSpaceIndex(0, 0);
+                for (int tracerIdx = 0; tracerIdx < numTracers(); ++ tracerIdx){
+                    Scalar storageOfTimeIndex1;
+                    computeStorage_(storageOfTimeIndex1, elemCtx, 0, /*timIdx=*/0, tracerIdx);
+                    storageOfTimeIndex1_[tracerIdx][globalDofIdx] = storageOfTimeIndex1;
+                }
             }
         }
     }
@@ -292,17 +366,38 @@ public:
         if (numTracers()==0)
             return;
 
-        for (int tracerIdx = 0; tracerIdx < numTracers(); ++ tracerIdx){
-
-            TracerVector dx(tracerResidual_.size());
-            // Newton step (currently the system is linear, converge in one iteration)
-            for (int iter = 0; iter < 5; ++ iter){
-                linearize_(tracerIdx);
-                linearSolve_(*tracerMatrix_, dx, tracerResidual_);
-                tracerConcentration_[tracerIdx] -= dx;
+        // the tracer equations are linear in the concentrations, i.e., a single Newton
+        // step is sufficient. Also, the Jacobian matrix only depends on the phase in
+        // which the tracers are transported, so all tracers of a phase can be handled
+        // using the same linearization and preconditioner.
+        for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
+            const auto& tracerIndices = phaseTracers_[phaseIdx];
+            if (tracerIndices.empty())
+                continue;
 
-                if (dx.two_norm()<1e-2)
-                    break;
+            linearize_(phaseIdx);
+
+            std::vector<TracerVector> dx(tracerIndices.size());
+            bool converged = linearSolve_(dx, tracerIndices);
+            if (!converged && simulator_.gridView().comm().rank() == 0)
+                std::cout << "Warning: Linear solver for tracers in phase "
+                          << FluidSystem::phaseName(phaseIdx) << " did not converge"
+                          << std::endl;
+
+            for (unsigned i = 0; i < tracerIndices.size(); ++i) {
+                int tracerIdx = tracerIndices[i];
+                tracerConcentration_[tracerIdx] -= dx[i];
+
+                // the linear solver only yields the concentrations of the interior
+                // elements, so get the ones of the ghost elements from their master
+                // processes
+                if (simulator_.gridView().comm().size() > 1) {
+                    TracerGhostSyncHandle ghostSync(tracerConcentration_[tracerIdx],
+                                                    simulator_.model().dofMapper());
+                    simulator_.gridView().communicate(ghostSync,
+                                                      Dune::InteriorBorder_All_Interface,
+                                                      Dune::ForwardCommunication);
+                }
             }
         }
     }
@@ -391,100 +486,119 @@ protected:
 
     }
 
-    bool linearSolve_(const TracerMatrix& M, TracerVector& x, TracerVector& b)
+    // solve the linear systems of equations for all tracers of a phase. the
+    // preconditioner is set up only once and then used for all right hand sides.
+    bool linearSolve_(std::vector<TracerVector>& x, const std::vector<int>& tracerIndices)
     {
 #if ! DUNE_VERSION_NEWER(DUNE_COMMON, 2,7)
         Dune::FMatrixPrecision<Scalar>::set_singular_limit(1.e-30);
         Dune::FMatrixPrecision<Scalar>::set_absolute_limit(1.e-30);
 #endif
-        x = 0.0;
-        Scalar tolerance = 1e-2;
+        // since only a single Newton step is done, the linear system must be solved
+        // accurately
+        Scalar tolerance = 1e-6;
         int maxIter = 100;
 
         int verbosity = 0;
-        typedef Dune::BiCGSTABSolver<TracerVector> TracerSolver;
-        typedef Dune::MatrixAdapter<TracerMatrix, TracerVector , TracerVector > TracerOperator;
-        typedef Dune::SeqScalarProduct< TracerVector > TracerScalarProduct ;
-#if DUNE_VERSION_NEWER(DUNE_ISTL, 2,6)
-        typedef Dune::SeqILU< TracerMatrix, TracerVector, TracerVector  > TracerPreconditioner;
-#else
-        typedef Dune::SeqILUn< TracerMatrix, TracerVector, TracerVector  > TracerPreconditioner;
-#endif
+        typedef Dune::BiCGSTABSolver<OverlappingTracerVector> TracerSolver;
+
+        overlappingMatrix_->assignFromNative(*tracerMatrix_);
+        overlappingMatrix_->syncAdd();
 
-        TracerOperator tracerOperator(M);
-        TracerScalarProduct tracerScalarProduct;
-        TracerPreconditioner tracerPreconditioner(M, 0, 1); // results in ILU0
+        int preconditionerIsReady = 1;
+        std::unique_ptr<SeqTracerPreconditioner> seqPreconditioner;
+        try {
+            seqPreconditioner.reset(new SeqTracerPreconditioner(*overlappingMatrix_, /*relaxation=*/1.0));
+        }
+        catch (const Dune::Exception& e) {
+            std::cout << "Tracer preconditioner threw exception \"" << e.what()
+                      << " on rank " << overlappingMatrix_->overlap().myRank()
+                      << "\n"  << std::flush;
+            preconditionerIsReady = 0;
+        }
+        preconditionerIsReady = simulator_.gridView().comm().min(preconditionerIsReady);
+        if (!preconditionerIsReady)
+            throw Opm::NumericalIssue("Creating the preconditioner for the tracers failed");
+
+        TracerOperator tracerOperator(*overlappingMatrix_);
+        TracerScalarProduct tracerScalarProduct(overlappingMatrix_->overlap());
+        TracerPreconditioner tracerPreconditioner(*seqPreconditioner, overlappingMatrix_->overlap());
 
-        TracerSolver solver (tracerOperator, tracerScalarProduct,
-                             tracerPreconditioner, tolerance, maxIter,
-                             verbosity);
+        TracerSolver solver(tracerOperator, tracerScalarProduct,
+                            tracerPreconditioner, tolerance, maxIter,
+                            verbosity);
 
-        Dune::InverseOperatorResult result;
-        solver.apply(x, b, result);
+        OverlappingTracerVector overlappingb(overlappingMatrix_->overlap());
+        OverlappingTracerVector overlappingx(overlappingb);
 
-        // return the result of the solver
-        return result.converged;
+        bool converged = true;
+        for (unsigned i = 0; i < tracerIndices.size(); ++i) {
+            overlappingb.assignAddBorder(tracerResidual_[tracerIndices[i]]);
+            overlappingx = 0.0;
+
+            Dune::InverseOperatorResult result;
+            solver.apply(overlappingx, overlappingb, result);
+            converged = converged && result.converged;
+
+            overlappingx.assignTo(x[i]);
+        }
+
+        return converged;
     }
 
-    void linearize_(int tracerIdx)
+    // linearize the equations of all tracers which are transported in a given phase
+    void linearize_(unsigned phaseIdx)
     {
-        (*tracerMatrix_) = 0.0;
-        tracerResidual_ = 0.0;
-
-        size_t numAllDof =  simulator_.model().numTotalDof();
-        std::vector<double> volumes(numAllDof, 0.0);
-        ElementContext elemCtx(simulator_);
-        auto elemIt = simulator_.gridView().template begin</*codim=*/0>();
-        auto elemEndIt = simulator_.gridView().template end</*codim=*/0>();
-        for (; elemIt != elemEndIt; ++ elemIt) {
-            elemCtx.updateAll(*elemIt);
-
-            Scalar extrusionFactor =
-                    elemCtx.intensiveQuantities(/*dofIdx=*/ 0, /*timeIdx=*/0).extrusionFactor();
-            Opm::Valgrind::CheckDefined(extrusionFactor);
-            assert(Opm::isfinite(extrusionFactor));
-            assert(extrusionFactor > 0.0);
-            Scalar scvVolume =
-                    elemCtx.stencil(/*timeIdx=*/0).subControlVolume(/*dofIdx=*/ 0).volume()
-                    * extrusionFactor;
-            Scalar dt = elemCtx.simulator().timeStepSize();
-
-            size_t I = elemCtx.globalSpaceIndex(/*dofIdx=*/ 0, /*timIdx=*/0);
-            volumes[I] = scvVolume;
-            TracerEvaluation localStorage;
-            TracerEvaluation storageOfTimeIndex0;
-            Scalar storageOfTimeIndex1;
-            computeStorage_(storageOfTimeIndex0, elemCtx, 0, /*timIdx=*/0, tracerIdx);
-            if (elemCtx.enableStorageCache())
-                storageOfTimeIndex1 = storageOfTimeIndex1_[tracerIdx][I];
-            else
-                computeStorage_(storageOfTimeIndex1, elemCtx, 0, /*timIdx=*/1, tracerIdx);
+        const auto& tracerIndices = phaseTracers_[phaseIdx];
 
-            localStorage = (storageOfTimeIndex0 - storageOfTimeIndex1) * scvVolume/dt;
-            tracerResidual_[I][0] += localStorage.value(); //residual + flux
-            (*tracerMatrix_)[I][I][0][0] = localStorage.derivative(0);
-            size_t numInteriorFaces = elemCtx.numInteriorFaces(/*timIdx=*/0);
-            for (unsigned scvfIdx = 0; scvfIdx < numInteriorFaces; scvfIdx++) {
-                TracerEvaluation flux;
-                const auto& face = elemCtx.stencil(0).interiorFace(scvfIdx);
-                unsigned j = face.exteriorIndex();
-                unsigned J = elemCtx.globalSpaceIndex(/*dofIdx=*/ j, /*timIdx=*/0);
-                computeFlux_(flux, elemCtx, scvfIdx, 0, tracerIdx);
-                tracerResidual_[I][0] += flux.value(); //residual + flux
-                (*tracerMatrix_)[J][I][0][0] = -flux.derivative(0);
-                (*tracerMatrix_)[I][J][0][0] = flux.derivative(0);
+        (*tracerMatrix_) = 0.0;
+        for (int tracerIdx : tracerIndices)
+            tracerResidual_[tracerIdx] = 0.0;
+
+        // to avoid a race condition if two threads handle an exception at the same time,
+        // we use an explicit lock to control access to the exception storage object
+        // amongst thread-local handlers
+        std::mutex exceptionLock;
+        std::exception_ptr exceptionPtr = nullptr;
+
+        // the ghost elements need to be linearized as well because their fluxes
+        // contribute to the off-diagonal entries of the border elements. since every
+        // entry of the matrix and the residual is written by exactly one element, no
+        // further locking is required.
+        ThreadedEntityIterator<GridView, /*codim=*/0> threadedElemIt(simulator_.gridView());
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+        {
+            ElementContext& elemCtx = *elementCtx_[ThreadManager::threadId()];
+            ElementIterator elemIt = threadedElemIt.beginParallel();
+            try {
+                for (; !threadedElemIt.isFinished(elemIt); elemIt = threadedElemIt.increment())
+                    linearizeElement_(elemCtx, *elemIt, tracerIndices);
+            }
+            catch(...) {
+                std::lock_guard<std::mutex> take(exceptionLock);
+                exceptionPtr = std::current_exception();
+                threadedElemIt.setFinished();
             }
-
         }
+
+        if (exceptionPtr)
+            std::rethrow_exception(exceptionPtr);
+
         // Wells
         const int episodeIdx = simulator_.episodeIndex();
         const auto& wells = simulator_.vanguard().schedule().getWells(episodeIdx);
+        const auto& wellModel = simulator_.problem().wellModel();
         for (auto well : wells) {
 
             if (well->getStatus(episodeIdx) == Opm::WellCommon::SHUT)
                 continue;
 
-            const double wtracer = well->getTracerProperties(episodeIdx).getConcentration(tracerNames_[tracerIdx]);
+            if (!wellModel.hasWell(well->name()))
+                continue;
+
+            const auto& eclWell = wellModel.well(well->name());
             std::array<int, 3> cartesianCoordinate;
             for( auto& connection : well->getConnections(episodeIdx)) {
 
@@ -496,26 +610,107 @@ protected:
                 cartesianCoordinate[ 2 ] = connection.getK();
                 const size_t cartIdx = simulator_.vanguard().cartesianIndex( cartesianCoordinate );
                 const int I = cartToGlobal_[cartIdx];
-                Scalar rate = simulator_.problem().wellModel().well(well->name())->volumetricSurfaceRateForConnection(I, tracerPhaseIdx_[tracerIdx]);
-                if (rate > 0)
-                    tracerResidual_[I][0] -= rate*wtracer;
-                else if (rate < 0)
-                    tracerResidual_[I][0] -= rate*tracerConcentration_[tracerIdx][I];
+
+                // only consider the connections to the interior of the local process
+                if (I < 0 || !isInteriorDof_(I))
+                    continue;
+
+                Scalar rate = eclWell->volumetricSurfaceRateForConnection(I, phaseIdx);
+                if (rate < 0)
+                    // production: the term is linear in the concentration of the cell
+                    (*tracerMatrix_)[I][I][0][0] -= rate;
+
+                for (int tracerIdx : tracerIndices) {
+                    if (rate > 0) {
+                        const double wtracer =
+                            well->getTracerProperties(episodeIdx).getConcentration(tracerNames_[tracerIdx]);
+                        tracerResidual_[tracerIdx][I][0] -= rate*wtracer;
+                    }
+                    else if (rate < 0)
+                        tracerResidual_[tracerIdx][I][0] -= rate*tracerConcentration_[tracerIdx][I];
+                }
             }
         }
     }
 
+    // linearize the tracer equations for the cell of a single element
+    void linearizeElement_(ElementContext& elemCtx,
+                           const Element& elem,
+                           const std::vector<int>& tracerIndices)
+    {
+        elemCtx.updateAll(elem);
+
+        Scalar extrusionFactor =
+                elemCtx.intensiveQuantities(/*dofIdx=*/ 0, /*timeIdx=*/0).extrusionFactor();
+        Opm::Valgrind::CheckDefined(extrusionFactor);
+        assert(Opm::isfinite(extrusionFactor));
+        assert(extrusionFactor > 0.0);
+        Scalar scvVolume =
+                elemCtx.stencil(/*timeIdx=*/0).subControlVolume(/*dofIdx=*/ 0).volume()
+                * extrusionFactor;
+        Scalar dt = elemCtx.simulator().timeStepSize();
+
+        size_t I = elemCtx.globalSpaceIndex(/*dofIdx=*/ 0, /*timIdx=*/0);
+        size_t numInteriorFaces = elemCtx.numInteriorFaces(/*timIdx=*/0);
+        for (unsigned i = 0; i < tracerIndices.size(); ++i) {
+            int tracerIdx = tracerIndices[i];
+
+            // the Jacobian matrix is the same for all tracers of a phase, so it only
+            // needs to be written once
+            bool writeMatrix = (i == 0);
+
+            TracerEvaluation localStorage;
+            TracerEvaluation storageOfTimeIndex0;
+            Scalar storageOfTimeIndex1;
+            computeStorage_(storageOfTimeIndex0, elemCtx, 0, /*timIdx=*/0, tracerIdx);
+            if (elemCtx.enableStorageCache())
+                storageOfTimeIndex1 = storageOfTimeIndex1_[tracerIdx][I];
+            else
+                computeStorage_(storageOfTimeIndex1, elemCtx, 0, /*timIdx=*/1, tracerIdx);
+
+            localStorage = (storageOfTimeIndex0 - storageOfTimeIndex1) * scvVolume/dt;
+            tracerResidual_[tracerIdx][I][0] += localStorage.value(); //residual + flux
+            if (writeMatrix)
+                (*tracerMatrix_)[I][I][0][0] = localStorage.derivative(0);
+
+            for (unsigned scvfIdx = 0; scvfIdx < numInteriorFaces; scvfIdx++) {
+                TracerEvaluation flux;
+                const auto& face = elemCtx.stencil(0).interiorFace(scvfIdx);
+                unsigned j = face.exteriorIndex();
+                unsigned J = elemCtx.globalSpaceIndex(/*dofIdx=*/ j, /*timIdx=*/0);
+                computeFlux_(flux, elemCtx, scvfIdx, 0, tracerIdx);
+                tracerResidual_[tracerIdx][I][0] += flux.value(); //residual + flux
+                if (writeMatrix) {
+                    // the flux only depends on the concentration of the interior cell
+                    // if it is the upstream one. this derivative is the negative of the
+                    // one of the neighbor's residual.
+                    (*tracerMatrix_)[J][I][0][0] = -flux.derivative(0);
+                    (*tracerMatrix_)[I][I][0][0] += flux.derivative(0);
+                }
+            }
+        }
+    }
+
+    bool isInteriorDof_(unsigned globalDofIdx) const
+    {
+        const auto& overlap = overlappingMatrix_->overlap();
+        return overlap.nativeToDomestic(static_cast<Linear::Index>(globalDofIdx)) >= 0;
+    }
+
     Simulator& simulator_;
 
     std::vector<std::string> tracerNames_;
     std::vector<int> tracerPhaseIdx_;
-    std::vector<Dune::BlockVector<Dune::FieldVector<Scalar, 1>>> tracerConcentration_;
-    std::vector<Dune::BlockVector<Dune::FieldVector<Scalar, 1>>> tracerConcentration0_;
-    TracerMatrix *tracerMatrix_;
-    TracerVector tracerResidual_;
+    std::vector<std::vector<int>> phaseTracers_;
+    std::vector<TracerVector> tracerConcentration_;
+    std::vector<TracerVector> tracerConcentration0_;
+    std::unique_ptr<TracerMatrix> tracerMatrix_;
+    std::unique_ptr<OverlappingTracerMatrix> overlappingMatrix_;
+    std::vector<TracerVector> tracerResidual_;
     std::vector<Scalar> wTracer_;
     std::vector<int> cartToGlobal_;
-    std::vector<Dune::BlockVector<Dune::FieldVector<Scalar, 1>>> storageOfTimeIndex1_;
+    std::vector<TracerVector> storageOfTimeIndex1_;
+    std::vector<ElementContext*> elementCtx_;
 
 };
 } // namespace Ewoms
@@ -49,6 +49,7 @@
 #include <dune/common/fmatrix.hh>
 
 #include <array>
+#include <cassert>
 #include <vector>
 #include <unordered_map>
 
@@ -182,6 +183,7 @@ public:
             thermalHalfTrans_->reserve(numElements*6*1.05);
 
             thermalHalfTransBoundary_.clear();
+            thermalHalfTransBoundaryOffsets_.resize(numElements);
         }
 
         // compute the transmissibilities for all intersections
@@ -193,6 +195,8 @@ public:
             auto isIt = gridView.ibegin(elem);
             const auto& isEndIt = gridView.iend(elem);
             unsigned boundaryIsIdx = 0;
+            if (enableEnergy)
+                thermalHalfTransBoundaryOffsets_[elemIdx] = thermalHalfTransBoundary_.size();
             for (; isIt != isEndIt; ++ isIt) {
                 // store intersection, this might be costly
                 const auto& intersection = *isIt;
@@ -233,8 +237,7 @@ public:
                         // the transmissibility with the face area here
                         Scalar thermalHalfTrans = std::abs(n*d)/(d*d);
 
-                        thermalHalfTransBoundary_[std::make_pair(elemIdx, boundaryIsIdx)] =
-                            thermalHalfTrans;
+                        thermalHalfTransBoundary_.push_back(thermalHalfTrans);
                     }
 
                     ++ boundaryIsIdx;
@@ -411,7 +414,11 @@ public:
     { return thermalHalfTrans_->at(directionalIsId_(insideElemIdx, outsideElemIdx)); }
 
     Scalar thermalHalfTransBoundary(unsigned insideElemIdx, unsigned boundaryFaceIdx) const
-    { return thermalHalfTransBoundary_.at(std::make_pair(insideElemIdx, boundaryFaceIdx)); }
+    {
+        unsigned idx = thermalHalfTransBoundaryOffsets_[insideElemIdx] + boundaryFaceIdx;
+        assert(idx < thermalHalfTransBoundary_.size());
+        return thermalHalfTransBoundary_[idx];
+    }
 
 private:
 
@@ -827,7 +834,11 @@ private:
     std::vector<DimMatrix> permeability_;
     std::unordered_map<std::uint64_t, Scalar> trans_;
     std::map<std::pair<unsigned, unsigned>, Scalar> transBoundary_;
-    std::map<std::pair<unsigned, unsigned>, Scalar> thermalHalfTransBoundary_;
+    // the thermal half transmissibilities of the boundary intersections. this is
+    // looked up for each boundary face in each linearization, so the values are stored
+    // contiguously in the order of the boundary intersections of each element.
+    std::vector<Scalar> thermalHalfTransBoundary_;
+    std::vector<unsigned> thermalHalfTransBoundaryOffsets_;
     Opm::ConditionalStorage<enableEnergy,
                             std::unordered_map<std::uint64_t, Scalar> > thermalHalfTrans_;
 };
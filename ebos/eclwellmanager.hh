@@ -44,6 +44,7 @@
 
 #include <ewoms/common/propertysystem.hh>
 #include <ewoms/parallel/threadedentityiterator.hh>
+#include <ewoms/common/tracer.hh>
 
 #include <dune/grid/common/gridenums.hh>
 
@@ -400,6 +401,8 @@ public:
      */
     void beginIteration()
     {
+        Ewoms::TraceScope traceScope("wellsBeginIteration", "wells");
+
         // call the preprocessing routines
         const size_t wellSize = wells_.size();
         for (size_t wellIdx = 0; wellIdx < wellSize; ++wellIdx)
@@ -436,6 +439,8 @@ public:
      */
     void endIteration()
     {
+        Ewoms::TraceScope traceScope("wellsEndIteration", "wells");
+
         // iterate over all wells and notify them individually
         const size_t wellSize = wells_.size();
         for (size_t wellIdx = 0; wellIdx < wellSize; ++wellIdx)
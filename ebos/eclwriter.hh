@@ -34,6 +34,7 @@
 #include <ewoms/disc/ecfv/ecfvdiscretization.hh>
 #include <ewoms/io/baseoutputwriter.hh>
 #include <ewoms/parallel/tasklets.hh>
+#include <ewoms/common/tracer.hh>
 
 #include <opm/output/eclipse/EclipseIO.hpp>
 #include <opm/output/eclipse/RestartValue.hpp>
@@ -226,9 +227,10 @@ public:
                                                                      blockData,
                                                                      enableDoublePrecisionOutput);
 
-            // then, make sure that the previous I/O request has been completed and the
-            // number of incomplete tasklets does not increase between time steps
-            taskletRunner_->barrier();
+            // then, make sure that the number of incomplete tasklets does not increase
+            // between time steps. since the tasklet owns copies of all data, the
+            // previous I/O request may still be in flight while this one is queued.
+            taskletRunner_->waitUntilPendingAtMost(1);
 
             // finally, start a new output writing job
             taskletRunner_->dispatch(eclWriteTasklet);
@@ -309,9 +311,10 @@ public:
                                                                      blockData,
                                                                      enableDoublePrecisionOutput);
 
-            // then, make sure that the previous I/O request has been completed and the
-            // number of incomplete tasklets does not increase between time steps
-            taskletRunner_->barrier();
+            // then, make sure that the number of incomplete tasklets does not increase
+            // between time steps. since the tasklet owns copies of all data, the
+            // previous I/O request may still be in flight while this one is queued.
+            taskletRunner_->waitUntilPendingAtMost(1);
 
             // finally, start a new output writing job
             taskletRunner_->dispatch(eclWriteTasklet);
@@ -543,6 +546,8 @@ private:
         // callback to eclIO serial writeTimeStep method
         void run()
         {
+            Ewoms::TraceScope traceScope("writeEcl", "output");
+
             eclIO_.writeTimeStep(episodeIdx_,
                                  isSubStep_,
                                  secondsElapsed_,
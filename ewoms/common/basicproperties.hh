@@ -116,6 +116,9 @@ NEW_PROP_TAG(RestartTime);
 //! The name of the file with a number of forced time step lengths
 NEW_PROP_TAG(PredeterminedTimeStepsFile);
 
+//! The name of the file to which a trace of the simulation is written
+NEW_PROP_TAG(TraceFile);
+
 ///////////////////////////////////
 // Values for the properties
 ///////////////////////////////////
@@ -185,6 +188,9 @@ SET_SCALAR_PROP(NumericModel, RestartTime, -1e35);
 //! By default, do not force any time steps
 SET_STRING_PROP(NumericModel, PredeterminedTimeStepsFile, "");
 
+//! By default, do not record a trace
+SET_STRING_PROP(NumericModel, TraceFile, "");
+
 
 END_PROPERTIES
 
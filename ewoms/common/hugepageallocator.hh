@@ -0,0 +1,327 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \copydoc Ewoms::HugePageAllocator
+ */
+#ifndef EWOMS_HUGE_PAGE_ALLOCATOR_HH
+#define EWOMS_HUGE_PAGE_ALLOCATOR_HH
+
+#include "alignedallocator.hh"
+
+#include <sys/mman.h>
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace Ewoms {
+
+/*!
+ * \brief Specifies how the memory of large arrays is backed by huge pages.
+ *
+ * - None: Do not request huge pages. (Whether the operating system uses transparent huge
+ *         pages anyway depends on its configuration.)
+ * - Transparent: Ask the kernel to back the memory by transparent huge pages using
+ *                madvise(MADV_HUGEPAGE).
+ * - Explicit: Use pages from the pool of pre-reserved huge pages (MAP_HUGETLB). If the
+ *             pool is exhausted, transparent huge pages are used instead.
+ */
+enum class HugePageMode { None, Transparent, Explicit };
+
+template <class Dummy = void>
+struct HugePageAllocatorHelper_
+{
+    static std::atomic<int> mode_;
+
+    // the start addresses and lengths of the blocks which are currently mapped directly
+    // from the operating system. this allows hugePageFree() to release blocks correctly
+    // even if the huge page mode was changed after they were allocated.
+    static std::map<const void*, std::size_t> mappedBlocks_;
+    static std::mutex mappedBlocksMutex_;
+};
+
+template <class Dummy>
+std::atomic<int> HugePageAllocatorHelper_<Dummy>::mode_(static_cast<int>(HugePageMode::None));
+
+template <class Dummy>
+std::map<const void*, std::size_t> HugePageAllocatorHelper_<Dummy>::mappedBlocks_;
+
+template <class Dummy>
+std::mutex HugePageAllocatorHelper_<Dummy>::mappedBlocksMutex_;
+
+//! \brief The size of a huge page [bytes]
+static constexpr std::size_t hugePageSize = 2*1024*1024;
+
+/*!
+ * \brief Set the process-wide huge page mode for all future allocations.
+ */
+inline void setHugePageMode(HugePageMode mode)
+{ HugePageAllocatorHelper_<>::mode_ = static_cast<int>(mode); }
+
+/*!
+ * \brief Returns the process-wide huge page mode.
+ */
+inline HugePageMode hugePageMode()
+{ return static_cast<HugePageMode>(HugePageAllocatorHelper_<>::mode_.load()); }
+
+/*!
+ * \brief Convert the value of a run-time parameter to a huge page mode.
+ *
+ * Valid values are 'none', 'transparent' and 'explicit'.
+ */
+inline HugePageMode parseHugePageMode(const std::string& name)
+{
+    if (name == "none")
+        return HugePageMode::None;
+    else if (name == "transparent")
+        return HugePageMode::Transparent;
+    else if (name == "explicit")
+        return HugePageMode::Explicit;
+
+    throw std::invalid_argument("Unknown huge page mode '"+name+"'. Valid values are "
+                                "'none', 'transparent' and 'explicit'");
+}
+
+namespace detail {
+// map a block of memory which starts at a huge page boundary. 'len' must be a multiple
+// of the huge page size.
+inline void* mapHugePageAligned_(std::size_t len) noexcept
+{
+    // over-allocate by one huge page and unmap the parts before and after the first
+    // huge page boundary: the kernel can only use huge pages for aligned regions
+    std::size_t mapLen = len + hugePageSize;
+    void* rawPtr = ::mmap(nullptr, mapLen, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS,
+                          /*fd=*/-1, /*offset=*/0);
+    if (rawPtr == MAP_FAILED)
+        return nullptr;
+
+    std::uintptr_t raw = reinterpret_cast<std::uintptr_t>(rawPtr);
+    std::uintptr_t aligned = (raw + hugePageSize - 1)/hugePageSize*hugePageSize;
+    std::size_t head = aligned - raw;
+    std::size_t tail = mapLen - head - len;
+    if (head > 0)
+        ::munmap(rawPtr, head);
+    if (tail > 0)
+        ::munmap(reinterpret_cast<void*>(aligned + len), tail);
+
+    return reinterpret_cast<void*>(aligned);
+}
+} // namespace detail
+
+/*!
+ * \brief Allocate a block of memory which is suitable to be backed by huge pages.
+ *
+ * If no huge pages were requested (i.e., the mode is HugePageMode::None) or the block is
+ * smaller than a huge page, it is allocated using aligned_alloc(). Otherwise the block
+ * is directly mapped from the operating system at huge page boundaries and its size is
+ * rounded up to the next multiple of the huge page size. Independent of the current
+ * huge page mode, memory obtained by this function must be released by
+ * hugePageFree() with the same size.
+ *
+ * \return A pointer to the memory or nullptr if it could not be allocated.
+ */
+inline void* hugePageAlloc(std::size_t alignment, std::size_t size) noexcept
+{
+    HugePageMode mode = hugePageMode();
+    if (size < hugePageSize || mode == HugePageMode::None)
+        return aligned_alloc(alignment, size);
+
+    assert(alignment <= hugePageSize);
+    std::size_t len = (size + hugePageSize - 1)/hugePageSize*hugePageSize;
+    void* p = nullptr;
+
+#if defined(MAP_HUGETLB)
+    if (mode == HugePageMode::Explicit) {
+        int flags = MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB;
+#ifdef MAP_HUGE_SHIFT
+        flags |= (21 << MAP_HUGE_SHIFT); // 2 MiB pages
+#endif
+        p = ::mmap(nullptr, len, PROT_READ | PROT_WRITE, flags, /*fd=*/-1, /*offset=*/0);
+        if (p == MAP_FAILED)
+            // the pool of explicit huge pages is exhausted. fall back to transparent
+            // huge pages...
+            p = nullptr;
+    }
+#endif
+
+    if (!p) {
+        p = detail::mapHugePageAligned_(len);
+        if (!p)
+            return nullptr;
+#ifdef MADV_HUGEPAGE
+        ::madvise(p, len, MADV_HUGEPAGE);
+#endif
+    }
+
+    try {
+        std::lock_guard<std::mutex> lock(HugePageAllocatorHelper_<>::mappedBlocksMutex_);
+        HugePageAllocatorHelper_<>::mappedBlocks_[p] = len;
+    }
+    catch (...) {
+        ::munmap(p, len);
+        return nullptr;
+    }
+
+    return p;
+}
+
+/*!
+ * \brief Release a block of memory which was allocated using hugePageAlloc().
+ */
+inline void hugePageFree(void* ptr, std::size_t size) noexcept
+{
+    if (!ptr)
+        return;
+
+    if (size >= hugePageSize) {
+        std::lock_guard<std::mutex> lock(HugePageAllocatorHelper_<>::mappedBlocksMutex_);
+        auto blockIt = HugePageAllocatorHelper_<>::mappedBlocks_.find(ptr);
+        if (blockIt != HugePageAllocatorHelper_<>::mappedBlocks_.end()) {
+            ::munmap(ptr, blockIt->second);
+            HugePageAllocatorHelper_<>::mappedBlocks_.erase(blockIt);
+            return;
+        }
+    }
+
+    aligned_free(ptr);
+}
+
+/*!
+ * \brief Returns true if an address is located in a block of memory which was mapped
+ *        at huge page boundaries by hugePageAlloc().
+ *
+ * The pages of such blocks must only be moved as a whole, i.e., in chunks of
+ * hugePageSize bytes which start at a multiple of hugePageSize.
+ */
+inline bool isInHugePageBlock(const void* ptr)
+{
+    std::lock_guard<std::mutex> lock(HugePageAllocatorHelper_<>::mappedBlocksMutex_);
+    const auto& mappedBlocks = HugePageAllocatorHelper_<>::mappedBlocks_;
+    auto blockIt = mappedBlocks.upper_bound(ptr);
+    if (blockIt == mappedBlocks.begin())
+        return false;
+    --blockIt;
+
+    std::uintptr_t addr = reinterpret_cast<std::uintptr_t>(ptr);
+    std::uintptr_t blockBegin = reinterpret_cast<std::uintptr_t>(blockIt->first);
+    return addr < blockBegin + blockIt->second;
+}
+
+/*!
+ * \brief An allocator which backs large arrays by huge pages.
+ *
+ * Huge pages considerably reduce the number of TLB misses when traversing arrays which
+ * span many megabytes, i.e., the solution vectors and the per-DOF caches of large
+ * simulations. Whether huge pages are requested is determined at run time by
+ * setHugePageMode(). If the mode is HugePageMode::None, and for allocations which are
+ * smaller than a huge page, this allocator behaves like Ewoms::aligned_allocator.
+ *
+ * The default vector and matrix types of the discretizations use the standard
+ * allocators, i.e., huge pages are opt-in: To use them, set the GlobalEqVector,
+ * SolutionVector and SparseMatrixAdapter properties to types which use this allocator
+ * and select a huge page mode via the HugePages parameter.
+ */
+template <class T, std::size_t Alignment = alignof(T)>
+class HugePageAllocator
+{
+    static_assert(detail::is_alignment_constant<Alignment>::value,
+                  "Alignment must be powers of two!");
+
+public:
+    typedef T value_type;
+    typedef T* pointer;
+    typedef const T* const_pointer;
+    typedef void* void_pointer;
+    typedef const void* const_void_pointer;
+    typedef std::size_t size_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef T& reference;
+    typedef const T& const_reference;
+
+    template <class U>
+    struct rebind
+    { typedef HugePageAllocator<U, Alignment> other; };
+
+    HugePageAllocator() noexcept = default;
+
+    template <class U>
+    HugePageAllocator(const HugePageAllocator<U, Alignment>&) noexcept
+    {}
+
+    pointer address(reference value) const noexcept
+    { return detail::addressof(value); }
+
+    const_pointer address(const_reference value) const noexcept
+    { return detail::addressof(value); }
+
+    pointer allocate(size_type n, const_void_pointer = 0)
+    {
+        void* p = hugePageAlloc(alignment_(), sizeof(T)*n);
+        if (!p && n > 0)
+            throw std::bad_alloc();
+        return static_cast<pointer>(p);
+    }
+
+    void deallocate(pointer ptr, size_type n) noexcept
+    { hugePageFree(ptr, sizeof(T)*n); }
+
+    constexpr size_type max_size() const noexcept
+    { return detail::max_count_of<T>::value; }
+
+    // the containers of older versions of dune-istl do not use std::allocator_traits
+    template <class U, class... Args>
+    void construct(U* ptr, Args&&... args)
+    {
+        void* p = ptr;
+        ::new(p) U(std::forward<Args>(args)...);
+    }
+
+    template <class U>
+    void destroy(U* ptr)
+    { ptr->~U(); }
+
+private:
+    static constexpr std::size_t alignment_()
+    { return detail::max_align<Alignment, alignof(T)>::value; }
+};
+
+template <class T1, class T2, std::size_t Alignment>
+inline bool operator==(const HugePageAllocator<T1, Alignment>&,
+                       const HugePageAllocator<T2, Alignment>&) noexcept
+{ return true; }
+
+template <class T1, class T2, std::size_t Alignment>
+inline bool operator!=(const HugePageAllocator<T1, Alignment>&,
+                       const HugePageAllocator<T2, Alignment>&) noexcept
+{ return false; }
+
+} // namespace Ewoms
+
+#endif
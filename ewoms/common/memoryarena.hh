@@ -0,0 +1,250 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \copydoc Ewoms::MemoryArena
+ */
+#ifndef EWOMS_MEMORY_ARENA_HH
+#define EWOMS_MEMORY_ARENA_HH
+
+#include "hugepageallocator.hh"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+namespace Ewoms {
+
+/*!
+ * \brief A region of memory from which objects are allocated which share the same
+ *        lifetime.
+ *
+ * Memory is handed out from large chunks by simply advancing a pointer and individual
+ * allocations are never given back. Instead, all memory of the arena is released at
+ * once by calling release(), e.g., after the grid has changed and all per-DOF data
+ * becomes obsolete. The chunks are allocated using hugePageAlloc(), i.e., they are
+ * backed by huge pages if this was requested.
+ *
+ * Note that this class is not thread safe.
+ */
+class MemoryArena
+{
+    struct Chunk_
+    {
+        char* data;
+        std::size_t size;
+    };
+
+public:
+    /*!
+     * \brief Create an empty arena.
+     *
+     * \param chunkSize The minimum number of bytes which are requested from the
+     *                  operating system at once.
+     */
+    explicit MemoryArena(std::size_t chunkSize = 32*1024*1024)
+        : chunkSize_(chunkSize)
+        , curPos_(nullptr)
+        , curEnd_(nullptr)
+        , bytesUsed_(0)
+    {}
+
+    MemoryArena(const MemoryArena&) = delete;
+    MemoryArena& operator=(const MemoryArena&) = delete;
+
+    ~MemoryArena()
+    { release(); }
+
+    /*!
+     * \brief Allocate a block of memory from the arena.
+     *
+     * The memory stays valid until release() is called or the arena is destroyed.
+     */
+    void* allocate(std::size_t size, std::size_t alignment)
+    {
+        assert(detail::is_alignment(alignment));
+
+        char* p = alignUp_(curPos_, alignment);
+        if (!curPos_ || p + size > curEnd_) {
+            // the current chunk is exhausted. objects which are larger than the usual
+            // chunk size get a chunk of their own.
+            std::size_t allocSize = std::max(chunkSize_, size + alignment);
+            void* data = hugePageAlloc(std::max<std::size_t>(alignment, 64), allocSize);
+            if (!data)
+                throw std::bad_alloc();
+
+            chunks_.push_back(Chunk_{static_cast<char*>(data), allocSize});
+            curPos_ = static_cast<char*>(data);
+            curEnd_ = curPos_ + allocSize;
+            p = alignUp_(curPos_, alignment);
+        }
+
+        curPos_ = p + size;
+        bytesUsed_ += size;
+        return p;
+    }
+
+    /*!
+     * \brief Give all memory of the arena back to the operating system.
+     *
+     * All objects which were allocated from the arena must have been destroyed before
+     * this method is called.
+     */
+    void release()
+    {
+        for (const auto& chunk : chunks_)
+            hugePageFree(chunk.data, chunk.size);
+        chunks_.clear();
+        curPos_ = nullptr;
+        curEnd_ = nullptr;
+        bytesUsed_ = 0;
+    }
+
+    /*!
+     * \brief The number of bytes which have been handed out since the last release.
+     */
+    std::size_t bytesUsed() const
+    { return bytesUsed_; }
+
+    /*!
+     * \brief The number of bytes which the arena has currently obtained from the
+     *        operating system.
+     */
+    std::size_t bytesReserved() const
+    {
+        std::size_t result = 0;
+        for (const auto& chunk : chunks_)
+            result += chunk.size;
+        return result;
+    }
+
+private:
+    static char* alignUp_(char* p, std::size_t alignment)
+    {
+        std::uintptr_t i = reinterpret_cast<std::uintptr_t>(p);
+        i = (i + alignment - 1) & ~static_cast<std::uintptr_t>(alignment - 1);
+        return reinterpret_cast<char*>(i);
+    }
+
+    std::size_t chunkSize_;
+    std::vector<Chunk_> chunks_;
+    char* curPos_;
+    char* curEnd_;
+    std::size_t bytesUsed_;
+};
+
+/*!
+ * \brief A standard conforming allocator which obtains its memory from a MemoryArena.
+ *
+ * Deallocating memory is a no-op: it is returned when the arena is released. Containers
+ * which use this allocator thus should be allocated only once per arena lifetime, i.e.,
+ * they should be sized before they are filled. A default constructed allocator is not
+ * associated with an arena and uses HugePageAllocator semantics.
+ */
+template <class T, std::size_t Alignment = alignof(T)>
+class ArenaAllocator
+{
+    static_assert(detail::is_alignment_constant<Alignment>::value,
+                  "Alignment must be powers of two!");
+
+    template <class U, std::size_t A>
+    friend class ArenaAllocator;
+
+public:
+    typedef T value_type;
+    typedef T* pointer;
+    typedef const T* const_pointer;
+    typedef std::size_t size_type;
+    typedef std::ptrdiff_t difference_type;
+
+    typedef std::true_type propagate_on_container_copy_assignment;
+    typedef std::true_type propagate_on_container_move_assignment;
+    typedef std::true_type propagate_on_container_swap;
+
+    template <class U>
+    struct rebind
+    { typedef ArenaAllocator<U, Alignment> other; };
+
+    ArenaAllocator() noexcept
+        : arena_(nullptr)
+    {}
+
+    explicit ArenaAllocator(MemoryArena* arena) noexcept
+        : arena_(arena)
+    {}
+
+    template <class U>
+    ArenaAllocator(const ArenaAllocator<U, Alignment>& other) noexcept
+        : arena_(other.arena_)
+    {}
+
+    pointer allocate(size_type n)
+    {
+        if (arena_)
+            return static_cast<pointer>(arena_->allocate(sizeof(T)*n, alignment_()));
+
+        void* p = hugePageAlloc(alignment_(), sizeof(T)*n);
+        if (!p && n > 0)
+            throw std::bad_alloc();
+        return static_cast<pointer>(p);
+    }
+
+    void deallocate(pointer ptr, size_type n) noexcept
+    {
+        if (!arena_)
+            hugePageFree(ptr, sizeof(T)*n);
+    }
+
+    constexpr size_type max_size() const noexcept
+    { return detail::max_count_of<T>::value; }
+
+    /*!
+     * \brief Returns the arena from which the memory is allocated.
+     */
+    MemoryArena* arena() const noexcept
+    { return arena_; }
+
+private:
+    static constexpr std::size_t alignment_()
+    { return detail::max_align<Alignment, alignof(T)>::value; }
+
+    MemoryArena* arena_;
+};
+
+template <class T1, class T2, std::size_t Alignment>
+inline bool operator==(const ArenaAllocator<T1, Alignment>& a,
+                       const ArenaAllocator<T2, Alignment>& b) noexcept
+{ return a.arena() == b.arena(); }
+
+template <class T1, class T2, std::size_t Alignment>
+inline bool operator!=(const ArenaAllocator<T1, Alignment>& a,
+                       const ArenaAllocator<T2, Alignment>& b) noexcept
+{ return a.arena() != b.arena(); }
+
+} // namespace Ewoms
+
+#endif
@@ -52,6 +52,8 @@
 #include <iostream>
 #include <fstream>
 #include <unordered_map>
+#include <mutex>
+#include <cstring>
 
 #include <unistd.h>
 #include <sys/ioctl.h>
@@ -166,12 +168,50 @@ const ParamType get(const char *propTagName,
                     const char *paramName,
                     bool errorIfNotRegistered = true);
 
+/*!
+ * \brief The typed storage of the cached value of a parameter.
+ *
+ * The values are only cached by cacheParamValues(), i.e., after the parameter tree has
+ * been filled.
+ */
+template <class TypeTag, class ParamType, class PropTag>
+struct ParamSlot_
+{
+    static ParamType value;
+    static bool isCached;
+    static bool isRegistered;
+};
+
+template <class TypeTag, class ParamType, class PropTag>
+ParamType ParamSlot_<TypeTag, ParamType, PropTag>::value;
+
+template <class TypeTag, class ParamType, class PropTag>
+bool ParamSlot_<TypeTag, ParamType, PropTag>::isCached = false;
+
+template <class TypeTag, class ParamType, class PropTag>
+bool ParamSlot_<TypeTag, ParamType, PropTag>::isRegistered = false;
+
+/*!
+ * \brief Describes a parameter which is retrieved somewhere in the code.
+ *
+ * This is only used by debug builds to find the parameters which are looked up but
+ * which have not been registered.
+ */
+struct ParamLookup_
+{
+    const bool *isRegistered;
+    std::string propertyName;
+    std::string paramTypeName;
+};
+
 class ParamRegFinalizerBase_
 {
 public:
     virtual ~ParamRegFinalizerBase_()
     {}
     virtual void retrieve() = 0;
+    virtual void cache() = 0;
+    virtual void uncache() = 0;
 };
 
 template <class TypeTag, class ParamType, class PropTag>
@@ -192,6 +232,21 @@ public:
                                              /*errorIfNotRegistered=*/true);
     }
 
+    void cache()
+    {
+        typedef ParamSlot_<TypeTag, ParamType, PropTag> Slot;
+
+        // make sure that the value is read from the parameter tree
+        Slot::isCached = false;
+        Slot::value = get<TypeTag, ParamType, PropTag>(/*propTagName=*/paramName_.data(),
+                                                       paramName_.data(),
+                                                       /*errorIfNotRegistered=*/true);
+        Slot::isCached = true;
+    }
+
+    void uncache()
+    { ParamSlot_<TypeTag, ParamType, PropTag>::isCached = false; }
+
 private:
     std::string paramName_;
 };
@@ -226,6 +281,12 @@ SET_PROP(ParameterSystem, ParameterMetaData)
     registrationFinalizers()
     { return storage_().finalizers; }
 
+    static std::list< ::Ewoms::Parameters::ParamLookup_>& lookups()
+    { return storage_().lookups; }
+
+    static std::mutex& lookupsMutex()
+    { return storage_().lookupsMutex; }
+
     static bool& registrationOpen()
     { return storage_().registrationOpen; }
 
@@ -238,9 +299,17 @@ private:
         Storage_()
         { registrationOpen = true; }
 
+        ~Storage_()
+        {
+            for (auto finalizer : finalizers)
+                delete finalizer;
+        }
+
         Dune::ParameterTree tree;
         std::map<std::string, ::Ewoms::Parameters::ParamInfo> registry;
         std::list< ::Ewoms::Parameters::ParamRegFinalizerBase_ *> finalizers;
+        std::list< ::Ewoms::Parameters::ParamLookup_> lookups;
+        std::mutex lookupsMutex;
         bool registrationOpen;
     };
     static Storage_& storage_() {
@@ -900,7 +969,66 @@ bool printUnused(std::ostream& os = std::cout)
     return false;
 }
 
+/*!
+ * \ingroup Parameter
+ * \brief Print the list of parameters which are retrieved by the code, but which have
+ *        not been registered.
+ *
+ * A parameter is recorded the first time it is retrieved, so this only covers the
+ * parameters which have been retrieved so far. In particular, a lookup of an
+ * unregistered parameter cannot be detected at startup if the code which retrieves it
+ * has not been executed yet. Note that these lookups are only recorded for debug
+ * builds.
+ *
+ * \param os The \c std::ostream on which the message should be printed
+ *
+ * \return true if something was printed
+ */
+template <class TypeTag>
+bool printUnregisteredLookups(std::ostream& os = std::cout)
+{
+    typedef typename GET_PROP(TypeTag, ParameterMetaData) ParamsMeta;
+
+    std::set<std::string> unregisteredList;
+    {
+        std::lock_guard<std::mutex> lock(ParamsMeta::lookupsMutex());
+        for (const auto& lookup : ParamsMeta::lookups()) {
+            if (!*lookup.isRegistered)
+                unregisteredList.insert(lookup.propertyName+" (type: "+lookup.paramTypeName+")");
+        }
+    }
+
+    if (unregisteredList.empty())
+        return false;
+
+    os << "# [retrieved parameters which were not registered]\n";
+    for (const auto& paramDesc : unregisteredList)
+        os << paramDesc << "\n";
+    os << std::flush;
+    return true;
+}
+
 //! \cond SKIP_THIS
+#ifndef NDEBUG
+template <class TypeTag, class ParamType, class PropTag>
+bool recordParamLookup_(const char *paramName)
+{
+    typedef typename GET_PROP(TypeTag, ParameterMetaData) ParamsMeta;
+    typedef ParamSlot_<TypeTag, ParamType, PropTag> Slot;
+
+    ParamLookup_ lookup;
+    lookup.isRegistered = &Slot::isRegistered;
+    lookup.propertyName = paramName;
+    lookup.paramTypeName = Dune::className<ParamType>();
+
+    // the first lookups of different parameters may happen concurrently, e.g., if a
+    // parameter is first retrieved by the linearizer's threads
+    std::lock_guard<std::mutex> lock(ParamsMeta::lookupsMutex());
+    ParamsMeta::lookups().push_back(lookup);
+    return true;
+}
+#endif // NDEBUG
+
 template <class TypeTag>
 class Param
 {
@@ -912,6 +1040,18 @@ public:
                                const char *paramName,
                                bool errorIfNotRegistered = true)
     {
+#ifndef NDEBUG
+        // record the lookup the first time the parameter is retrieved
+        static const bool isRecorded OPM_UNUSED =
+            recordParamLookup_<TypeTag, ParamType, PropTag>(paramName);
+#endif
+
+        // once the parameter values have been cached, retrieving a parameter boils
+        // down to loading its value
+        typedef ParamSlot_<TypeTag, ParamType, PropTag> Slot;
+        if (Slot::isCached)
+            return Slot::value;
+
         return retrieve_<ParamType, PropTag>(propTagName,
                                              paramName,
                                              errorIfNotRegistered);
@@ -1058,6 +1198,7 @@ void registerParam(const char *paramName, const char *propertyName, const char *
 
     ParamsMeta::registrationFinalizers().push_back(
         new ParamRegFinalizer_<TypeTag, ParamType, PropTag>(paramName));
+    ParamSlot_<TypeTag, ParamType, PropTag>::isRegistered = true;
 
     ParamInfo paramInfo;
     paramInfo.paramName = paramName;
@@ -1117,10 +1258,43 @@ void endParamRegistration()
     // that there is no syntax error
     auto pIt = ParamsMeta::registrationFinalizers().begin();
     const auto& pEndIt = ParamsMeta::registrationFinalizers().end();
-    for (; pIt != pEndIt; ++pIt) {
+    for (; pIt != pEndIt; ++pIt)
         (*pIt)->retrieve();
-        delete *pIt;
-    }
+}
+
+/*!
+ * \ingroup Parameter
+ * \brief Resolve the values of all registered parameters and store them in typed slots.
+ *
+ * Afterwards, retrieving a registered parameter via EWOMS_GET_PARAM only loads its cached
+ * value instead of looking it up in the parameter tree. This must be called after the
+ * parameter tree has been filled and again each time it is modified.
+ */
+template <class TypeTag>
+void cacheParamValues()
+{
+    typedef typename GET_PROP(TypeTag, ParameterMetaData) ParamsMeta;
+    if (ParamsMeta::registrationOpen())
+        throw std::logic_error("Parameter values can only be cached after all parameters "
+                               "have been registered.");
+
+    for (auto finalizer : ParamsMeta::registrationFinalizers())
+        finalizer->cache();
+}
+
+/*!
+ * \ingroup Parameter
+ * \brief Discard the cached values of all registered parameters.
+ *
+ * Afterwards, the parameters are looked up in the parameter tree again until
+ * cacheParamValues() is called.
+ */
+template <class TypeTag>
+void clearParamCache()
+{
+    typedef typename GET_PROP(TypeTag, ParameterMetaData) ParamsMeta;
+    for (auto finalizer : ParamsMeta::registrationFinalizers())
+        finalizer->uncache();
 }
 //! \endcond
 
@@ -113,6 +113,14 @@ public:
         return elemData_[elemIdx][localDofIdx];
     }
 
+    /*!
+     * \brief Returns the storage of the data of all DOFs.
+     *
+     * The entries are ordered by the elements whose stencils they belong to.
+     */
+    const std::vector<Data>& data() const
+    { return data_; }
+
 private:
     unsigned computeNumLocalDofs_() const
     {
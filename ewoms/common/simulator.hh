@@ -34,6 +34,7 @@
 #include <ewoms/common/propertysystem.hh>
 #include <ewoms/common/timer.hh>
 #include <ewoms/common/timerguard.hh>
+#include <ewoms/common/tracer.hh>
 
 #include <dune/common/version.hh>
 #include <dune/common/parallel/mpihelper.hh>
@@ -56,6 +57,7 @@ NEW_PROP_TAG(EndTime);
 NEW_PROP_TAG(RestartTime);
 NEW_PROP_TAG(InitialTimeStepSize);
 NEW_PROP_TAG(PredeterminedTimeStepsFile);
+NEW_PROP_TAG(TraceFile);
 
 END_PROPERTIES
 
@@ -94,6 +96,14 @@ public:
 
         verbose_ = verbose && Dune::MPIHelper::getCollectiveCommunication().rank() == 0;
 
+        traceFile_ = EWOMS_GET_PARAM(TypeTag, std::string, TraceFile);
+        if (!traceFile_.empty()) {
+            // make the start of the trace coincide on all processes
+            Dune::MPIHelper::getCollectiveCommunication().barrier();
+            Ewoms::Tracer::enable();
+        }
+        Ewoms::TraceScope traceScope("setupSimulator", "simulator");
+
         timeStepIdx_ = 0;
         startTime_ = 0.0;
         time_ = 0.0;
@@ -161,6 +171,9 @@ public:
         EWOMS_REGISTER_PARAM(TypeTag, std::string, PredeterminedTimeStepsFile,
                              "A file with a list of predetermined time step sizes (one "
                              "time step per line)");
+        EWOMS_REGISTER_PARAM(TypeTag, std::string, TraceFile,
+                             "The name of the file to which a trace of the simulation is "
+                             "written in the Chrome/Perfetto JSON format (empty: no trace)");
 
         Vanguard::registerParameters();
         Model::registerParameters();
@@ -586,6 +599,8 @@ public:
         bool episodeBegins = episodeIsOver() || (timeStepIdx_ == 0);
         // do the time steps
         while (!finished()) {
+            Ewoms::TraceScope timeStepTraceScope("timeStep", "simulator");
+
             prePostProcessTimer_.start();
             if (episodeBegins) {
                 // notify the problem that a new episode has just been
@@ -623,6 +638,7 @@ public:
 
             try {
                 // execute the time integration scheme
+                Ewoms::TraceScope traceScope("timeIntegration", "simulator");
                 problem_->timeIntegration();
             }
             catch (...) {
@@ -648,8 +664,10 @@ public:
 
             // write the result to disk
             writeTimer_.start();
-            if (problem_->shouldWriteOutput())
+            if (problem_->shouldWriteOutput()) {
+                Ewoms::TraceScope traceScope("writeOutput", "output");
                 problem_->writeOutput(/*isSubstep=*/!episodeWillBeOver());
+            }
             writeTimer_.stop();
 
             // do the next time integration
@@ -693,13 +711,18 @@ public:
 
             // write restart file if mandated by the problem
             writeTimer_.start();
-            if (problem_->shouldWriteRestartFile())
+            if (problem_->shouldWriteRestartFile()) {
+                Ewoms::TraceScope traceScope("writeRestart", "output");
                 serialize();
+            }
             writeTimer_.stop();
         }
         executionTimer_.stop();
 
         problem_->finalize();
+
+        if (!traceFile_.empty())
+            Ewoms::Tracer::writeChromeJson(traceFile_);
     }
 
     /*!
@@ -868,6 +891,7 @@ private:
     Ewoms::Timer writeTimer_;
 
     std::vector<Scalar> forcedTimeSteps_;
+    std::string traceFile_;
     Scalar startTime_;
     Scalar time_;
     Scalar endTime_;
@@ -138,6 +138,10 @@ static inline int setupParameters_(int argc, const char **argv, bool registerPar
     // set the parameter values
     ////////////////////////////////////////////////////////////
 
+    // if the parameters have already been set up before, their cached values are
+    // stale. they need to be retrieved from the parameter tree until it is complete.
+    Parameters::clearParamCache<TypeTag>();
+
     // fill the parameter tree with the options from the command line
     const auto& positionalParamCallback = Problem::handlePositionalParameter;
     std::string helpPreamble = "";
@@ -174,6 +178,10 @@ static inline int setupParameters_(int argc, const char **argv, bool registerPar
         Parameters::parseParameterFile<TypeTag>(paramFileName, /*overwrite=*/false);
     }
 
+    // all parameter values are known now, so we can resolve them once. this makes
+    // retrieving them cheap in the performance critical parts of the code.
+    Parameters::cacheParamValues<TypeTag>();
+
     return /*status=*/0;
 }
 
@@ -220,6 +228,34 @@ static inline void resetTerminal_(int signum)
     // after we did our best to clean the pedestrian way, re-raise the signal
     raise(signum);
 }
+
+#ifndef NDEBUG
+/*!
+ * \brief Complains about the parameters which have been retrieved but which have never
+ *        been registered when it goes out of scope.
+ *
+ * Parameter lookups are only recorded once they are executed, so this can only be done
+ * at the end of a run. Using the destructor makes sure that it is also done if the
+ * simulation is aborted by an exception.
+ */
+template <class TypeTag>
+class UnregisteredLookupReporter_
+{
+public:
+    UnregisteredLookupReporter_(int rank)
+        : rank_(rank)
+    {}
+
+    ~UnregisteredLookupReporter_()
+    {
+        if (rank_ == 0 && Parameters::printUnregisteredLookups<TypeTag>(std::cerr))
+            std::cerr << "# [end of parameters]\n";
+    }
+
+private:
+    int rank_;
+};
+#endif
 //! \endcond
 
 /*!
@@ -334,6 +370,12 @@ static inline int start(int argc, char **argv)
                 Ewoms::Properties::printValues<TypeTag>();
         }
 
+#ifndef NDEBUG
+        // for debug builds, complain about the parameters which have been retrieved
+        // but which have never been registered once the simulation is over
+        UnregisteredLookupReporter_<TypeTag> unregisteredLookupReporter(myRank);
+#endif
+
         // instantiate and run the concrete problem. make sure to
         // deallocate the problem and before the time manager and the
         // grid
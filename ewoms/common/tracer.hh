@@ -0,0 +1,324 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \copydoc Ewoms::Tracer
+ */
+#ifndef EWOMS_TRACER_HH
+#define EWOMS_TRACER_HH
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#if HAVE_MPI
+#include <mpi.h>
+#endif
+
+namespace Ewoms {
+
+class Tracer;
+
+// this class stores the static attributes of the Tracer class. we cannot put them
+// directly into Tracer because defining static members for non-template classes in
+// headers leads the linker to choke in case multiple compile units are used.
+template <class Dummy = void>
+struct TracerHelper_
+{
+    struct Event
+    {
+        const char* name;
+        const char* category;
+        int64_t beginUs;
+        int64_t durationUs;
+    };
+
+    struct ThreadBuffer
+    {
+        int threadIdx;
+        // the buffer is only contended while the trace is written
+        std::mutex mutex;
+        std::vector<Event> events;
+    };
+
+    static std::atomic<bool> enabled_;
+    static std::chrono::steady_clock::time_point origin_;
+    static std::mutex buffersMutex_;
+    static std::vector<std::unique_ptr<ThreadBuffer> > buffers_;
+    static thread_local ThreadBuffer* threadBuffer_;
+};
+
+template <class Dummy>
+std::atomic<bool> TracerHelper_<Dummy>::enabled_(false);
+
+template <class Dummy>
+std::chrono::steady_clock::time_point TracerHelper_<Dummy>::origin_;
+
+template <class Dummy>
+std::mutex TracerHelper_<Dummy>::buffersMutex_;
+
+template <class Dummy>
+std::vector<std::unique_ptr<typename TracerHelper_<Dummy>::ThreadBuffer> > TracerHelper_<Dummy>::buffers_;
+
+template <class Dummy>
+thread_local typename TracerHelper_<Dummy>::ThreadBuffer* TracerHelper_<Dummy>::threadBuffer_ = nullptr;
+
+/*!
+ * \ingroup Common
+ *
+ * \brief Records timed events of the individual threads and processes of a simulation.
+ *
+ * In contrast to Ewoms::Timer, which accumulates the time spend for a given task, this
+ * records when each task started and how long it took. The result can be written in the
+ * JSON trace event format which is understood by Chrome's trace viewer
+ * (chrome://tracing) and by Perfetto (https://ui.perfetto.dev), where load imbalances
+ * and serialization show up as gaps.
+ *
+ * Recording is disabled by default. In this case, recording an event costs a single
+ * branch. If it is enabled, each thread records into its own buffer.
+ *
+ * The names and categories of the events are not copied, i.e., they must be string
+ * literals or otherwise outlive the tracer.
+ */
+class Tracer
+{
+    typedef TracerHelper_<void> Helper;
+    typedef Helper::Event Event;
+    typedef Helper::ThreadBuffer ThreadBuffer;
+
+public:
+    /*!
+     * \brief Start recording events.
+     *
+     * The point in time at which this is called becomes t=0 of the trace. If events of
+     * multiple processes are recorded, it should thus be called collectively right after
+     * a barrier.
+     */
+    static void enable()
+    {
+        Helper::origin_ = std::chrono::steady_clock::now();
+        Helper::enabled_ = true;
+    }
+
+    /*!
+     * \brief Stop recording events.
+     */
+    static void disable()
+    { Helper::enabled_ = false; }
+
+    /*!
+     * \brief Returns true iff events are recorded.
+     */
+    static bool isEnabled()
+    { return Helper::enabled_; }
+
+    /*!
+     * \brief Returns the time in microseconds since the tracer was enabled.
+     */
+    static int64_t now()
+    {
+        const auto& dt = std::chrono::steady_clock::now() - Helper::origin_;
+        return std::chrono::duration_cast<std::chrono::microseconds>(dt).count();
+    }
+
+    /*!
+     * \brief Record an event of the current thread.
+     */
+    static void record(const char* name, const char* category, int64_t beginUs, int64_t endUs)
+    {
+        ThreadBuffer& buffer = threadBuffer_();
+        std::lock_guard<std::mutex> lock(buffer.mutex);
+        buffer.events.push_back(Event{name, category, beginUs, endUs - beginUs});
+    }
+
+    /*!
+     * \brief Discard all recorded events.
+     */
+    static void clear()
+    {
+        std::lock_guard<std::mutex> lock(Helper::buffersMutex_);
+        for (auto& buffer : Helper::buffers_) {
+            std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+            buffer->events.clear();
+        }
+    }
+
+    /*!
+     * \brief Write the events of all threads and processes to a file in the trace event
+     *        format.
+     *
+     * Each process appears as a separate row group named after its MPI rank. If MPI is
+     * used, this method must be called collectively and only the first process writes
+     * the file.
+     */
+    static void writeChromeJson(const std::string& fileName)
+    {
+        int rank = 0;
+        int numRanks = 1;
+#if HAVE_MPI
+        int mpiIsInitialized = 0;
+        MPI_Initialized(&mpiIsInitialized);
+        if (mpiIsInitialized) {
+            MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+            MPI_Comm_size(MPI_COMM_WORLD, &numRanks);
+        }
+#endif
+
+        std::string localEvents = serializeEvents_(rank);
+
+#if HAVE_MPI
+        if (numRanks > 1) {
+            // collect the events of all processes on the first one
+            int localSize = static_cast<int>(localEvents.size());
+            std::vector<int> sizes(static_cast<size_t>(numRanks));
+            MPI_Gather(&localSize, 1, MPI_INT, sizes.data(), 1, MPI_INT,
+                       /*root=*/0, MPI_COMM_WORLD);
+
+            std::vector<int> offsets(static_cast<size_t>(numRanks), 0);
+            for (size_t i = 1; i < offsets.size(); ++i)
+                offsets[i] = offsets[i - 1] + sizes[i - 1];
+
+            std::string allEvents;
+            if (rank == 0)
+                allEvents.resize(static_cast<size_t>(offsets.back() + sizes.back()));
+
+            MPI_Gatherv(const_cast<char*>(localEvents.data()), localSize, MPI_CHAR,
+                        &allEvents[0], sizes.data(), offsets.data(), MPI_CHAR,
+                        /*root=*/0, MPI_COMM_WORLD);
+            localEvents.swap(allEvents);
+        }
+#endif
+
+        if (rank != 0)
+            return;
+
+        std::ofstream os(fileName);
+        if (!os)
+            throw std::runtime_error("Could not open trace file '"+fileName+"'");
+
+        // every event is terminated by a comma, so the last entry of the array is an
+        // empty object
+        os << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n"
+           << localEvents
+           << "{}]}\n";
+    }
+
+private:
+    static ThreadBuffer& threadBuffer_()
+    {
+        if (!Helper::threadBuffer_) {
+            // the buffers are owned by the tracer because the threads may terminate
+            // before the trace is written
+            std::lock_guard<std::mutex> lock(Helper::buffersMutex_);
+            Helper::buffers_.emplace_back(new ThreadBuffer);
+            Helper::buffers_.back()->threadIdx = static_cast<int>(Helper::buffers_.size()) - 1;
+            Helper::threadBuffer_ = Helper::buffers_.back().get();
+        }
+
+        return *Helper::threadBuffer_;
+    }
+
+    static std::string serializeEvents_(int rank)
+    {
+        std::ostringstream oss;
+        oss << "{\"ph\":\"M\",\"name\":\"process_name\",\"pid\":" << rank
+            << ",\"args\":{\"name\":\"rank " << rank << "\"}},\n";
+
+        std::lock_guard<std::mutex> lock(Helper::buffersMutex_);
+        for (auto& buffer : Helper::buffers_) {
+            std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+            oss << "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":" << rank
+                << ",\"tid\":" << buffer->threadIdx
+                << ",\"args\":{\"name\":\"thread " << buffer->threadIdx << "\"}},\n";
+
+            for (const auto& event : buffer->events)
+                oss << "{\"ph\":\"X\",\"name\":\"" << escape_(event.name)
+                    << "\",\"cat\":\"" << escape_(event.category)
+                    << "\",\"pid\":" << rank
+                    << ",\"tid\":" << buffer->threadIdx
+                    << ",\"ts\":" << event.beginUs
+                    << ",\"dur\":" << event.durationUs << "},\n";
+        }
+
+        return oss.str();
+    }
+
+    static std::string escape_(const char* str)
+    {
+        std::string result;
+        for (; *str; ++str) {
+            if (*str == '"' || *str == '\\')
+                result += '\\';
+            result += *str;
+        }
+        return result;
+    }
+};
+
+/*!
+ * \ingroup Common
+ *
+ * \brief Records the lifetime of the object as an event of the current thread.
+ *
+ * Usage:
+ * \code
+ * {
+ *     Ewoms::TraceScope traceScope("linearize", "newton");
+ *     // ... do the work ...
+ * }
+ * \endcode
+ */
+class TraceScope
+{
+public:
+    TraceScope(const char* name, const char* category = "ewoms")
+        : name_(name)
+        , category_(category)
+        , beginUs_(Tracer::isEnabled() ? Tracer::now() : -1)
+    { }
+
+    TraceScope(const TraceScope&) = delete;
+
+    ~TraceScope()
+    {
+        if (beginUs_ >= 0 && Tracer::isEnabled())
+            Tracer::record(name_, category_, beginUs_, Tracer::now());
+    }
+
+private:
+    const char* name_;
+    const char* category_;
+    int64_t beginUs_;
+};
+
+} // namespace Ewoms
+
+#endif
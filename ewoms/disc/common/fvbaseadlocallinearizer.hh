@@ -191,14 +191,18 @@ public:
         resize_(elemCtx);
         reset_(elemCtx);
 
+        // the values precomputed by the gradient calculator only depend on the geometry
+        // of the stencil, so they are shared by all focus DOFs
+        elemCtx.prepareGradientCalculator(/*timeIdx=*/0);
+
         // compute the local residual and its Jacobian
         unsigned numPrimaryDof = elemCtx.numPrimaryDof(/*timeIdx=*/0);
         for (unsigned focusDofIdx = 0; focusDofIdx < numPrimaryDof; focusDofIdx++) {
             elemCtx.setFocusDofIndex(focusDofIdx);
-            elemCtx.updateAllExtensiveQuantities();
+            elemCtx.updatePreparedExtensiveQuantities(/*timeIdx=*/0);
 
-            // calculate the local residual
-            localResidual_.eval(elemCtx);
+            // calculate the parts of the local residual which depend on the focus DOF
+            localResidual_.evalFocusDofResidual(elemCtx);
 
             // convert the local Jacobian matrix and the right hand side from the data
             // structures used by the automatic differentiation code to the conventional
@@ -53,8 +53,11 @@
 #include <ewoms/linear/istlsparsematrixadapter.hh>
 #include <ewoms/common/simulator.hh>
 #include <ewoms/common/alignedallocator.hh>
+#include <ewoms/common/hugepageallocator.hh>
+#include <ewoms/common/memoryarena.hh>
 #include <ewoms/common/timer.hh>
 #include <ewoms/common/timerguard.hh>
+#include <ewoms/common/tracer.hh>
 #include <ewoms/linear/matrixblock.hh>
 
 #include <opm/material/common/MathToolbox.hpp>
@@ -78,10 +81,15 @@
 #include <dune/fem/misc/capabilities.hh>
 #endif
 
+#include <algorithm>
+#include <atomic>
+#include <exception>
 #include <limits>
 #include <list>
+#include <mutex>
 #include <sstream>
 #include <string>
+#include <utility>
 #include <vector>
 
 namespace Ewoms {
@@ -214,6 +222,7 @@ SET_TYPE_PROP(FvBaseDiscretization, ConstraintsContext, Ewoms::FvBaseConstraints
  */
 SET_TYPE_PROP(FvBaseDiscretization, ThreadManager, Ewoms::ThreadManager<TypeTag>);
 SET_INT_PROP(FvBaseDiscretization, ThreadsPerProcess, 1);
+SET_STRING_PROP(FvBaseDiscretization, ThreadPinning, "none");
 SET_BOOL_PROP(FvBaseDiscretization, UseLinearizationLock, true);
 
 /*!
@@ -241,12 +250,24 @@ SET_BOOL_PROP(FvBaseDiscretization, EnableVtkOutput, true);
 //! This has only an effect if EnableVtkOutput is true
 SET_BOOL_PROP(FvBaseDiscretization, EnableAsyncVtkOutput, true);
 
+//! By default, write self-contained VTK files for each time step
+SET_BOOL_PROP(FvBaseDiscretization, EnableVtkGeometryCache, false);
+
 //! Set the format of the VTK output to ASCII by default
 SET_INT_PROP(FvBaseDiscretization, VtkOutputFormat, Dune::VTK::ascii);
 
 // disable caching the storage term by default
 SET_BOOL_PROP(FvBaseDiscretization, EnableStorageCache, false);
 
+// compute the geometry of the stencils on the fly by default
+SET_BOOL_PROP(FvBaseDiscretization, EnableStencilCache, false);
+
+// do not explicitly request huge pages for the large per-DOF arrays by default
+SET_STRING_PROP(FvBaseDiscretization, HugePages, "none");
+
+// linearize all elements in every Newton iteration by default
+SET_SCALAR_PROP(FvBaseDiscretization, SelectiveLinearizationTolerance, 0.0);
+
 // disable constraints by default
 SET_BOOL_PROP(FvBaseDiscretization, EnableConstraints, false);
 
@@ -256,6 +277,9 @@ SET_BOOL_PROP(FvBaseDiscretization, EnableConstraints, false);
 // CPU caches...
 SET_BOOL_PROP(FvBaseDiscretization, EnableIntensiveQuantityCache, false);
 
+// update the intensive quantities in the order of the elements by default
+SET_INT_PROP(FvBaseDiscretization, IntensiveQuantityBatchSize, 0);
+
 // do not use thermodynamic hints by default. If you enable this, make sure to also
 // enable the intensive quantity cache above to avoid getting an exception...
 SET_BOOL_PROP(FvBaseDiscretization, EnableThermodynamicHints, false);
@@ -317,6 +341,7 @@ class FvBaseDiscretization
     typedef typename GET_PROP_TYPE(TypeTag, Stencil) Stencil;
     typedef typename GET_PROP_TYPE(TypeTag, DiscBaseOutputModule) DiscBaseOutputModule;
     typedef typename GET_PROP_TYPE(TypeTag, GridCommHandleFactory) GridCommHandleFactory;
+    typedef typename GridCommHandleFactory::HaloExchange HaloExchange;
     typedef typename GET_PROP_TYPE(TypeTag, NewtonMethod) NewtonMethod;
     typedef typename GET_PROP_TYPE(TypeTag, ThreadManager) ThreadManager;
 
@@ -328,10 +353,16 @@ class FvBaseDiscretization
         historySize = GET_PROP_VALUE(TypeTag, TimeDiscHistorySize),
     };
 
-    typedef std::vector<IntensiveQuantities, Ewoms::aligned_allocator<IntensiveQuantities, alignof(IntensiveQuantities)> > IntensiveQuantitiesVector;
+    // the per-DOF caches are allocated from an arena which is released as a whole if the
+    // grid changes
+    typedef Ewoms::ArenaAllocator<IntensiveQuantities> IntensiveQuantitiesAllocator;
+    typedef std::vector<IntensiveQuantities, IntensiveQuantitiesAllocator> IntensiveQuantitiesVector;
+    typedef Ewoms::ArenaAllocator<EqVector> StorageCacheAllocator;
+    typedef std::vector<EqVector, StorageCacheAllocator> StorageCacheVector;
 
     typedef typename GridView::template Codim<0>::Entity Element;
     typedef typename GridView::template Codim<0>::Iterator ElementIterator;
+    typedef typename Element::EntitySeed ElementSeed;
 
     typedef Opm::MathToolbox<Evaluation> Toolbox;
     typedef Dune::FieldVector<Evaluation, numEq> VectorBlock;
@@ -403,7 +434,10 @@ public:
         , enableIntensiveQuantityCache_(EWOMS_GET_PARAM(TypeTag, bool, EnableIntensiveQuantityCache))
         , enableStorageCache_(EWOMS_GET_PARAM(TypeTag, bool, EnableStorageCache))
         , enableThermodynamicHints_(EWOMS_GET_PARAM(TypeTag, bool, EnableThermodynamicHints))
+        , intensiveQuantityBatchSize_(EWOMS_GET_PARAM(TypeTag, unsigned, IntensiveQuantityBatchSize))
     {
+        haloExchangeSeqNum_ = -1;
+
 #if HAVE_DUNE_FEM
         if (enableGridAdaptation_ && !Dune::Fem::Capabilities::isLocallyAdaptive<Grid>::v)
             throw std::invalid_argument("Grid adaptation enabled, but chosen Grid is not capable"
@@ -421,19 +455,14 @@ public:
 
         enableStorageCache_ = EWOMS_GET_PARAM(TypeTag, bool, EnableStorageCache);
 
-        size_t numDof = asImp_().numGridDof();
-        for (unsigned timeIdx = 0; timeIdx < historySize; ++timeIdx) {
-            solution_[timeIdx].reset(new DiscreteFunction("solution", space_));
-
-            if (storeIntensiveQuantities()) {
-                intensiveQuantityCache_[timeIdx].resize(numDof);
-                intensiveQuantityCacheUpToDate_[timeIdx].resize(numDof, /*value=*/false);
-            }
+        const std::string& hugePages = EWOMS_GET_PARAM(TypeTag, std::string, HugePages);
+        Ewoms::setHugePageMode(Ewoms::parseHugePageMode(hugePages));
 
-            if (enableStorageCache_)
-                storageCache_[timeIdx].resize(numDof);
-        }
+        for (unsigned timeIdx = 0; timeIdx < historySize; ++timeIdx)
+            solution_[timeIdx].reset(new DiscreteFunction("solution", space_));
 
+        // the caches are allocated by resizeAndResetIntensiveQuantitiesCache_()
+        cacheArenaSeqNum_ = -1;
         resizeAndResetIntensiveQuantitiesCache_();
         asImp_().registerOutputModules_();
     }
@@ -469,7 +498,15 @@ public:
         EWOMS_REGISTER_PARAM(TypeTag, bool, EnableVtkOutput, "Global switch for turning on writing VTK files");
         EWOMS_REGISTER_PARAM(TypeTag, bool, EnableThermodynamicHints, "Enable thermodynamic hints");
         EWOMS_REGISTER_PARAM(TypeTag, bool, EnableIntensiveQuantityCache, "Turn on caching of intensive quantities");
+        EWOMS_REGISTER_PARAM(TypeTag, unsigned, IntensiveQuantityBatchSize,
+                             "The number of degrees of freedom of the same region whose "
+                             "intensive quantities are updated as a batch before "
+                             "linearizing. 0 disables batched updates");
         EWOMS_REGISTER_PARAM(TypeTag, bool, EnableStorageCache, "Store previous storage terms and avoid re-calculating them.");
+        EWOMS_REGISTER_PARAM(TypeTag, std::string, HugePages,
+                             "Back the large per-DOF arrays by huge pages. Possible values: "
+                             "'none', 'transparent' and 'explicit' (use the pool of reserved "
+                             "huge pages if possible)");
         EWOMS_REGISTER_PARAM(TypeTag, std::string, OutputDir, "The directory to which result files are written");
     }
 
@@ -521,12 +558,7 @@ public:
             isLocalDof_[dofIdx] = (dofTotalVolume_[dofIdx] != 0.0);
 
         // add the volumes of the DOFs on the process boundaries
-        const auto sumHandle =
-            GridCommHandleFactory::template sumHandle<Scalar>(dofTotalVolume_,
-                                                              asImp_().dofMapper());
-        gridView_.communicate(*sumHandle,
-                              Dune::InteriorBorder_All_Interface,
-                              Dune::ForwardCommunication);
+        haloExchange_().syncAdd(dofTotalVolume_);
 
         // sum up the volumes of the grid partitions
         gridTotalVolume_ = gridView_.comm().sum(gridTotalVolume_);
@@ -728,6 +760,81 @@ public:
         }
     }
 
+    /*!
+     * \brief Update all invalid entries of the intensive quantity cache for a time index.
+     *
+     * The degrees of freedom are visited in batches of at most IntensiveQuantityBatchSize
+     * entries. Each batch only contains degrees of freedom which use the same parameter
+     * regions (see dofParameterRegions_()), and the batches of a region are consecutive.
+     * Thus the fluid system and the material laws are evaluated with the same tables
+     * for a long stretch of degrees of freedom, instead of jumping between the regions
+     * in the order of the elements. The linearizer then finds the intensive quantities
+     * in the cache.
+     *
+     * This method is a no-op if the intensive quantity cache or batched updates are
+     * disabled.
+     *
+     * \param timeIdx The index used by the time discretization.
+     */
+    void updateIntensiveQuantityCacheBatched(unsigned timeIdx) const
+    {
+        if (!enableIntensiveQuantityCache_ || intensiveQuantityBatchSize_ == 0)
+            return;
+
+        if (timeIdx > 0 && enableStorageCache_)
+            // only the intensive quantities of the most recent time index are cached
+            return;
+
+        Ewoms::TraceScope traceScope("updateIntensiveQuantityCacheBatched", "discretization");
+
+        if (iqBatchOffsets_.empty())
+            buildIntensiveQuantityBatches_();
+
+        // to avoid a race condition if two threads handle an exception at the same time,
+        // we use an explicit lock to control access to the exception storage object
+        std::mutex exceptionLock;
+        std::exception_ptr exceptionPtr = nullptr;
+        std::atomic<bool> failed(false);
+
+        const auto& grid = gridView_.grid();
+        int numBatches = static_cast<int>(iqBatchOffsets_.size()) - 1;
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+        {
+            ElementContext elemCtx(simulator_);
+
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic)
+#endif
+            for (int batchIdx = 0; batchIdx < numBatches; ++batchIdx) {
+                if (failed)
+                    continue;
+
+                try {
+                    unsigned batchBegin = iqBatchOffsets_[batchIdx];
+                    unsigned batchEnd = iqBatchOffsets_[batchIdx + 1];
+                    for (unsigned i = batchBegin; i < batchEnd; ++i) {
+                        if (intensiveQuantityCacheUpToDate_[timeIdx][iqBatchDofIndices_[i]])
+                            continue;
+
+                        const auto& elem = grid.entity(iqBatchElementSeeds_[i]);
+                        elemCtx.updateStencil(elem);
+                        elemCtx.updateDofIntensiveQuantities(iqBatchLocalDofIndices_[i], timeIdx);
+                    }
+                }
+                catch (...) {
+                    std::lock_guard<std::mutex> take(exceptionLock);
+                    exceptionPtr = std::current_exception();
+                    failed = true;
+                }
+            }
+        }
+
+        if (exceptionPtr)
+            std::rethrow_exception(exceptionPtr);
+    }
+
     /*!
      * \brief Move the intensive quantities for a given time index to the back.
      *
@@ -1777,6 +1884,16 @@ public:
     bool storeIntensiveQuantities() const
     { return enableIntensiveQuantityCache_ || enableThermodynamicHints_; }
 
+    /*!
+     * \brief Make a stencil use the geometric data which was precomputed by the
+     *        discretization.
+     *
+     * This is called by the element contexts for their stencils. By default, nothing
+     * is precomputed and the stencils compute their geometries themselves.
+     */
+    void attachStencilCache(Stencil& stencil OPM_UNUSED) const
+    { }
+
 #if HAVE_DUNE_FEM
     AdaptationManager& adaptationManager()
     {
@@ -1806,8 +1923,40 @@ public:
     { return updateTimer_; }
 
 protected:
+    /*!
+     * \brief Returns the object which exchanges the values of the degrees of freedom on
+     *        the process boundaries with the peer processes.
+     *
+     * The index lists of the exchange are rebuilt each time the grid was changed.
+     */
+    const HaloExchange& haloExchange_()
+    {
+        int curSeqNum = simulator_.vanguard().gridSequenceNumber();
+        if (!gridHaloExchange_.isInitialized() || haloExchangeSeqNum_ != curSeqNum) {
+            gridHaloExchange_.update(gridView_, asImp_().dofMapper(),
+                                  Dune::InteriorBorder_All_Interface);
+            haloExchangeSeqNum_ = curSeqNum;
+        }
+
+        return gridHaloExchange_;
+    }
+
     void resizeAndResetIntensiveQuantitiesCache_()
     {
+        // if the grid has changed, all data of the caches is obsolete. release the
+        // memory of the old caches in one go and allocate the new ones from the empty
+        // arena.
+        int curSeqNum = simulator_.vanguard().gridSequenceNumber();
+        if (cacheArenaSeqNum_ != curSeqNum) {
+            for (unsigned timeIdx = 0; timeIdx < historySize; ++timeIdx) {
+                storageCache_[timeIdx] = StorageCacheVector(StorageCacheAllocator(&cacheArena_));
+                intensiveQuantityCache_[timeIdx] =
+                    IntensiveQuantitiesVector(IntensiveQuantitiesAllocator(&cacheArena_));
+            }
+            cacheArena_.release();
+            cacheArenaSeqNum_ = curSeqNum;
+        }
+
         // allocate the storage cache
         if (enableStorageCache()) {
             size_t numDof = asImp_().numGridDof();
@@ -1816,6 +1965,13 @@ protected:
             }
         }
 
+        // the batches of the intensive quantity updates are rebuilt when they are used
+        // the next time
+        iqBatchOffsets_.clear();
+        iqBatchDofIndices_.clear();
+        iqBatchElementSeeds_.clear();
+        iqBatchLocalDofIndices_.clear();
+
         // allocate the intensive quantities cache
         if (storeIntensiveQuantities()) {
             size_t numDof = asImp_().numGridDof();
@@ -1825,7 +1981,86 @@ protected:
                 invalidateIntensiveQuantitiesCache(timeIdx);
             }
         }
+
+        // place the per-DOF data into the memory of the NUMA nodes which run the
+        // threads that handle the respective DOFs
+        for (unsigned timeIdx = 0; timeIdx < historySize; ++timeIdx) {
+            ThreadManager::distributeContainer(solution(timeIdx));
+            ThreadManager::distributeContainer(storageCache_[timeIdx]);
+            ThreadManager::distributeContainer(intensiveQuantityCache_[timeIdx]);
+        }
     }
+    // group the degrees of freedom into the batches of updateIntensiveQuantityCacheBatched()
+    void buildIntensiveQuantityBatches_() const
+    {
+        size_t numDof = asImp_().numGridDof();
+        std::vector<std::pair<unsigned, unsigned> > dofRegions(numDof);
+        std::vector<ElementSeed> dofElementSeeds(numDof);
+        std::vector<unsigned> dofLocalIndices(numDof);
+        std::vector<unsigned char> dofVisited(numDof, 0);
+
+        // remember an element and the local index of each degree of freedom. the element
+        // context will be updated for these to compute the intensive quantities
+        ElementContext elemCtx(simulator_);
+        auto elemIt = gridView_.template begin</*codim=*/0>();
+        const auto& elemEndIt = gridView_.template end</*codim=*/0>();
+        for (; elemIt != elemEndIt; ++elemIt) {
+            const Element& elem = *elemIt;
+            elemCtx.updateStencil(elem);
+            for (unsigned dofIdx = 0; dofIdx < elemCtx.numPrimaryDof(/*timeIdx=*/0); ++dofIdx) {
+                unsigned globalIdx = elemCtx.globalSpaceIndex(dofIdx, /*timeIdx=*/0);
+                if (dofVisited[globalIdx])
+                    continue;
+
+                dofVisited[globalIdx] = 1;
+                dofRegions[globalIdx] = asImp_().dofParameterRegions_(elemCtx, dofIdx);
+                dofElementSeeds[globalIdx] = elem.seed();
+                dofLocalIndices[globalIdx] = dofIdx;
+            }
+        }
+
+        // sort the degrees of freedom by their regions. within a region, the order of
+        // the global indices is kept to access the solution and the cache sequentially
+        std::vector<unsigned> order;
+        order.reserve(numDof);
+        for (unsigned globalIdx = 0; globalIdx < numDof; ++globalIdx)
+            if (dofVisited[globalIdx])
+                order.push_back(globalIdx);
+        std::stable_sort(order.begin(), order.end(),
+                         [&dofRegions](unsigned a, unsigned b)
+                         { return dofRegions[a] < dofRegions[b]; });
+
+        // store the batches in structure-of-arrays layout. a new batch is started when it
+        // is full or when the region changes
+        iqBatchDofIndices_.resize(order.size());
+        iqBatchElementSeeds_.resize(order.size());
+        iqBatchLocalDofIndices_.resize(order.size());
+        iqBatchOffsets_.clear();
+        for (unsigned i = 0; i < order.size(); ++i) {
+            unsigned globalIdx = order[i];
+            if (i == 0
+                || i - iqBatchOffsets_.back() >= intensiveQuantityBatchSize_
+                || dofRegions[globalIdx] != dofRegions[order[i - 1]])
+                iqBatchOffsets_.push_back(i);
+
+            iqBatchDofIndices_[i] = globalIdx;
+            iqBatchElementSeeds_[i] = dofElementSeeds[globalIdx];
+            iqBatchLocalDofIndices_[i] = dofLocalIndices[globalIdx];
+        }
+        iqBatchOffsets_.push_back(static_cast<unsigned>(order.size()));
+    }
+
+    /*!
+     * \brief Returns the indices of the regions which determine the parameters used to
+     *        compute the intensive quantities of a degree of freedom.
+     *
+     * updateIntensiveQuantityCacheBatched() groups the degrees of freedom by these
+     * indices. By default, all degrees of freedom are in the same region.
+     */
+    std::pair<unsigned, unsigned> dofParameterRegions_(const ElementContext& elemCtx OPM_UNUSED,
+                                                       unsigned dofIdx OPM_UNUSED) const
+    { return std::make_pair(0u, 0u); }
+
     template <class Context>
     void supplementInitialSolution_(PrimaryVariables& priVars OPM_UNUSED,
                                     const Context& context OPM_UNUSED,
@@ -1891,10 +2126,25 @@ protected:
     // local jacobian
     Linearizer *linearizer_;
 
+    // the memory for the per-DOF caches. this must be declared before the caches
+    // themselves so that it outlives them
+    MemoryArena cacheArena_;
+    int cacheArenaSeqNum_;
+
     // cur is the current iterative solution, prev the converged
     // solution of the previous time step
     mutable IntensiveQuantitiesVector intensiveQuantityCache_[historySize];
-    mutable std::vector<bool> intensiveQuantityCacheUpToDate_[historySize];
+    // this is not a std::vector<bool> because the entries of different degrees of
+    // freedom are written concurrently by the threads
+    mutable std::vector<unsigned char> intensiveQuantityCacheUpToDate_[historySize];
+
+    // the batches of updateIntensiveQuantityCacheBatched(): the offsets of the batches
+    // and the global index, an element and the local index within this element of each
+    // degree of freedom
+    mutable std::vector<unsigned> iqBatchOffsets_;
+    mutable std::vector<unsigned> iqBatchDofIndices_;
+    mutable std::vector<ElementSeed> iqBatchElementSeeds_;
+    mutable std::vector<unsigned> iqBatchLocalDofIndices_;
 
     DiscreteFunctionSpace space_;
     mutable std::array< std::unique_ptr< DiscreteFunction >, historySize > solution_;
@@ -1909,14 +2159,19 @@ protected:
 
     Scalar gridTotalVolume_;
     std::vector<Scalar> dofTotalVolume_;
+
+    // exchange of the values on the process boundaries using precomputed index lists
+    HaloExchange gridHaloExchange_;
+    int haloExchangeSeqNum_;
     std::vector<bool> isLocalDof_;
 
-    mutable GlobalEqVector storageCache_[historySize];
+    mutable StorageCacheVector storageCache_[historySize];
 
     bool enableGridAdaptation_;
     bool enableIntensiveQuantityCache_;
     bool enableStorageCache_;
     bool enableThermodynamicHints_;
+    unsigned intensiveQuantityBatchSize_;
 };
 } // namespace Ewoms
 
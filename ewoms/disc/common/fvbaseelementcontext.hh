@@ -100,6 +100,8 @@ public:
         enableStorageCache_ = EWOMS_GET_PARAM(TypeTag, bool, EnableStorageCache);
         stashedDofIdx_ = -1;
         focusDofIdx_ = -1;
+
+        simulator.model().attachStencilCache(stencil_);
     }
 
     static void *operator new(size_t size) {
@@ -227,6 +229,20 @@ public:
     void updateIntensiveQuantities(const PrimaryVariables& priVars, unsigned dofIdx, unsigned timeIdx)
     { asImp_().updateSingleIntQuants_(priVars, dofIdx, timeIdx); }
 
+    /*!
+     * \brief Compute the intensive quantities of a single sub-control volume of the
+     *        current element from the global solution.
+     *
+     * Like updateIntensiveQuantities(timeIdx), this method considers the intensive
+     * quantities cache.
+     *
+     * \param dofIdx The local index in the current element of the sub-control volume
+     *               which should be updated.
+     * \param timeIdx The index of the solution vector used by the time discretization.
+     */
+    void updateDofIntensiveQuantities(unsigned dofIdx, unsigned timeIdx)
+    { updateDofIntensiveQuantities_(model().solution(timeIdx), dofIdx, timeIdx); }
+
     /*!
      * \brief Compute the extensive quantities of all sub-control volume
      *        faces of the current element for all time indices.
@@ -243,8 +259,35 @@ public:
      */
     void updateExtensiveQuantities(unsigned timeIdx)
     {
-        gradientCalculator_.prepare(/*context=*/asImp_(), timeIdx);
+        prepareGradientCalculator(timeIdx);
+        updatePreparedExtensiveQuantities(timeIdx);
+    }
+
+    /*!
+     * \brief Precompute the values of the gradient calculator for the current stencil.
+     *
+     * These values only depend on the geometry of the stencil, so they stay valid until
+     * the stencil is updated.
+     *
+     * \param timeIdx The index of the solution vector used by the
+     *                time discretization.
+     */
+    void prepareGradientCalculator(unsigned timeIdx)
+    { gradientCalculator_.prepare(/*context=*/asImp_(), timeIdx); }
 
+    /*!
+     * \brief Compute the extensive quantities of all sub-control volume faces of the
+     *        current element without preparing the gradient calculator.
+     *
+     * This requires that prepareGradientCalculator() has been called after the stencil
+     * was last updated. It is useful if the extensive quantities need to be
+     * re-evaluated several times for the same stencil, e.g., once for each focus DOF.
+     *
+     * \param timeIdx The index of the solution vector used by the
+     *                time discretization.
+     */
+    void updatePreparedExtensiveQuantities(unsigned timeIdx)
+    {
         for (unsigned fluxIdx = 0; fluxIdx < numInteriorFaces(timeIdx); fluxIdx++) {
             extensiveQuantities_[fluxIdx].update(/*context=*/asImp_(),
                                                  /*localIndex=*/fluxIdx,
@@ -252,6 +295,33 @@ public:
         }
     }
 
+    /*!
+     * \brief Compute the extensive quantities of the sub-control volume faces of the
+     *        current element which are adjacent to a given degree of freedom.
+     *
+     * Like updatePreparedExtensiveQuantities(), this requires that the gradient
+     * calculator has been prepared for the current stencil. The extensive quantities of
+     * all other faces are left untouched, so this is only sufficient if the extensive
+     * quantities of a face exclusively depend on the two degrees of freedom adjacent to
+     * it.
+     *
+     * \param dofIdx The local index of the degree of freedom in the current element.
+     * \param timeIdx The index of the solution vector used by the
+     *                time discretization.
+     */
+    void updateAdjacentExtensiveQuantities(unsigned dofIdx, unsigned timeIdx)
+    {
+        for (unsigned fluxIdx = 0; fluxIdx < numInteriorFaces(timeIdx); fluxIdx++) {
+            const auto& face = stencil_.interiorFace(fluxIdx);
+            if (face.interiorIndex() != dofIdx && face.exteriorIndex() != dofIdx)
+                continue;
+
+            extensiveQuantities_[fluxIdx].update(/*context=*/asImp_(),
+                                                 /*localIndex=*/fluxIdx,
+                                                 timeIdx);
+        }
+    }
+
     /*!
      * \brief Sets the degree of freedom on which the simulator is currently "focused" on
      *
@@ -553,24 +623,28 @@ protected:
         const SolutionVector& globalSol = model().solution(timeIdx);
 
         // update the non-gradient quantities
-        for (unsigned dofIdx = 0; dofIdx < numDof; dofIdx++) {
-            unsigned globalIdx = globalSpaceIndex(dofIdx, timeIdx);
-            const PrimaryVariables& dofSol = globalSol[globalIdx];
-            dofVars_[dofIdx].priVars[timeIdx] = dofSol;
-
-            dofVars_[dofIdx].thermodynamicHint[timeIdx] =
-                model().thermodynamicHint(globalIdx, timeIdx);
-
-            const auto *cachedIntQuants = model().cachedIntensiveQuantities(globalIdx, timeIdx);
-            if (cachedIntQuants) {
-                dofVars_[dofIdx].intensiveQuantities[timeIdx] = *cachedIntQuants;
-            }
-            else {
-                updateSingleIntQuants_(dofSol, dofIdx, timeIdx);
-                model().updateCachedIntensiveQuantities(dofVars_[dofIdx].intensiveQuantities[timeIdx],
-                                                        globalIdx,
-                                                        timeIdx);
-            }
+        for (unsigned dofIdx = 0; dofIdx < numDof; dofIdx++)
+            updateDofIntensiveQuantities_(globalSol, dofIdx, timeIdx);
+    }
+
+    void updateDofIntensiveQuantities_(const SolutionVector& globalSol, unsigned dofIdx, unsigned timeIdx)
+    {
+        unsigned globalIdx = globalSpaceIndex(dofIdx, timeIdx);
+        const PrimaryVariables& dofSol = globalSol[globalIdx];
+        dofVars_[dofIdx].priVars[timeIdx] = dofSol;
+
+        dofVars_[dofIdx].thermodynamicHint[timeIdx] =
+            model().thermodynamicHint(globalIdx, timeIdx);
+
+        const auto *cachedIntQuants = model().cachedIntensiveQuantities(globalIdx, timeIdx);
+        if (cachedIntQuants) {
+            dofVars_[dofIdx].intensiveQuantities[timeIdx] = *cachedIntQuants;
+        }
+        else {
+            updateSingleIntQuants_(dofSol, dofIdx, timeIdx);
+            model().updateCachedIntensiveQuantities(dofVars_[dofIdx].intensiveQuantities[timeIdx],
+                                                    globalIdx,
+                                                    timeIdx);
         }
     }
 
@@ -58,6 +58,7 @@ NEW_PROP_TAG(LocalLinearizer);
 NEW_PROP_TAG(Evaluation);
 NEW_PROP_TAG(NumericDifferenceMethod);
 NEW_PROP_TAG(BaseEpsilon);
+NEW_PROP_TAG(EnableLocalFdPerturbations);
 
 NEW_PROP_TAG(LocalResidual);
 NEW_PROP_TAG(Simulator);
@@ -68,6 +69,8 @@ NEW_PROP_TAG(ElementContext);
 NEW_PROP_TAG(Scalar);
 NEW_PROP_TAG(Evaluation);
 NEW_PROP_TAG(GridView);
+NEW_PROP_TAG(GradientCalculator);
+NEW_PROP_TAG(ExtensiveStorageTerm);
 NEW_PROP_TAG(NumEq);
 
 // set the properties to be spliced in
@@ -91,6 +94,15 @@ SET_SCALAR_PROP(FiniteDifferenceLocalLinearizer,
                 BaseEpsilon,
                 std::max<Scalar>(0.9123e-10, std::numeric_limits<Scalar>::epsilon()*1.23e3));
 
+/*!
+ * \brief Specify whether only the terms of the local residual which involve the perturbed
+ *        degree of freedom should be re-evaluated for each perturbation.
+ *
+ * This only has an effect if the gradient calculator is two-point based and the storage
+ * term does not depend on the extensive quantities.
+ */
+SET_BOOL_PROP(FiniteDifferenceLocalLinearizer, EnableLocalFdPerturbations, false);
+
 END_PROPERTIES
 
 namespace Ewoms {
@@ -130,6 +142,13 @@ namespace Ewoms {
  * Here, \f$ f \f$ is the residual function for all equations, \f$x\f$ is the value of a
  * sub-control volume's primary variable at the evaluation point and \f$\epsilon\f$ is a
  * small scalar value larger than 0.
+ *
+ * If the fluxes over a face only depend on the two adjacent degrees of freedom, all
+ * terms of the local residual which do not involve the perturbed degree of freedom
+ * cancel out in the differences. If the "EnableLocalFdPerturbations" parameter is set,
+ * only the intensive quantities of the perturbed degree of freedom, the extensive
+ * quantities of its adjacent faces and the terms of the local residual associated with
+ * it are thus re-evaluated for each perturbation.
  */
 template<class TypeTag>
 class FvBaseFdLocalLinearizer
@@ -144,9 +163,11 @@ private:
     typedef typename GET_PROP_TYPE(TypeTag, ElementContext) ElementContext;
     typedef typename GET_PROP_TYPE(TypeTag, Scalar) Scalar;
     typedef typename GET_PROP_TYPE(TypeTag, GridView) GridView;
+    typedef typename GET_PROP_TYPE(TypeTag, GradientCalculator) GradientCalculator;
     typedef typename GridView::template Codim<0>::Entity Element;
 
     enum { numEq = GET_PROP_VALUE(TypeTag, NumEq) };
+    enum { extensiveStorageTerm = GET_PROP_VALUE(TypeTag, ExtensiveStorageTerm) };
 
     // extract local matrices from jacobian matrix for consistency
     typedef typename GET_PROP_TYPE(TypeTag, SparseMatrixAdapter)::MatrixBlock ScalarMatrixBlock;
@@ -186,6 +207,10 @@ public:
         EWOMS_REGISTER_PARAM(TypeTag, int, NumericDifferenceMethod,
                              "The method used for numeric differentiation (-1: backward "
                              "differences, 0: central differences, 1: forward differences)");
+        EWOMS_REGISTER_PARAM(TypeTag, bool, EnableLocalFdPerturbations,
+                             "Only re-evaluate the terms of the local residual which involve "
+                             "the perturbed degree of freedom when calculating finite "
+                             "differences");
     }
 
     /*!
@@ -249,6 +274,18 @@ public:
         // calculate the local jacobian matrix
         size_t numPrimaryDof = elemCtx.numPrimaryDof(/*timeIdx=*/0);
         for (unsigned dofIdx = 0; dofIdx < numPrimaryDof; dofIdx++) {
+            if (localPerturbations_()) {
+                // the extensive quantities of the faces adjacent to the DOF may still
+                // have been calculated using a perturbed neighbor
+                elemCtx.setFocusDofIndex(dofIdx);
+                elemCtx.updateAdjacentExtensiveQuantities(dofIdx, /*timeIdx=*/0);
+
+                // the unperturbed terms associated with the DOF take the role of f(x)
+                // for forward and backward differences
+                if (numericDifferenceMethod_() != 0)
+                    localResidual_.evalFocusDofTerms(unperturbedResidual_, elemCtx);
+            }
+
             for (unsigned pvIdx = 0; pvIdx < numEq; pvIdx++) {
                 asImp_().evalPartialDerivative_(elemCtx, dofIdx, pvIdx);
 
@@ -338,6 +375,43 @@ protected:
     static int numericDifferenceMethod_()
     { return EWOMS_GET_PARAM(TypeTag, int, NumericDifferenceMethod); }
 
+    /*!
+     * \brief Returns true if only the terms of the local residual which involve the
+     *        perturbed degree of freedom are re-evaluated.
+     *
+     * This is only possible if the fluxes over a face only depend on the two adjacent
+     * degrees of freedom and if the storage term does not depend on the extensive
+     * quantities.
+     */
+    static bool localPerturbations_()
+    {
+        return
+            GradientCalculator::isTwoPoint()
+            && !extensiveStorageTerm
+            && EWOMS_GET_PARAM(TypeTag, bool, EnableLocalFdPerturbations);
+    }
+
+    /*!
+     * \brief Evaluate the local residual after the primary variables of a degree of
+     *        freedom have been perturbed.
+     *
+     * If local perturbations are enabled, only the terms associated with the perturbed
+     * degree of freedom are calculated.
+     */
+    void evalPerturbedResidual_(LocalEvalBlockVector& residual,
+                                ElementContext& elemCtx,
+                                unsigned dofIdx)
+    {
+        if (localPerturbations_()) {
+            elemCtx.updateAdjacentExtensiveQuantities(dofIdx, /*timeIdx=*/0);
+            localResidual_.evalFocusDofTerms(residual, elemCtx);
+        }
+        else {
+            elemCtx.updateAllExtensiveQuantities();
+            localResidual_.eval(residual, elemCtx);
+        }
+    }
+
     /*!
      * \brief Resize all internal attributes to the size of the
      *        element.
@@ -351,6 +425,8 @@ protected:
         jacobian_.setSize(numDof, numPrimaryDof);
 
         derivResidual_.resize(numDof);
+        perturbedResidual_.resize(numDof);
+        unperturbedResidual_.resize(numDof);
     }
 
     /*!
@@ -432,14 +508,13 @@ protected:
 
             // calculate the deflected residual
             elemCtx.updateIntensiveQuantities(priVars, dofIdx, /*timeIdx=*/0);
-            elemCtx.updateAllExtensiveQuantities();
-            localResidual_.eval(derivResidual_, elemCtx);
+            evalPerturbedResidual_(derivResidual_, elemCtx, dofIdx);
         }
         else {
             // we are using backward differences, i.e. we don't need
             // to calculate f(x + \epsilon) and we can recycle the
             // (already calculated) residual f(x)
-            derivResidual_ = residual_;
+            derivResidual_ = localPerturbations_() ? unperturbedResidual_ : residual_;
         }
 
         if (numericDifferenceMethod_() <= 0) {
@@ -450,19 +525,17 @@ protected:
             priVars[pvIdx] -= delta + eps;
             delta += eps;
 
-            // calculate the deflected residual again, this time we use the local
-            // residual's internal storage.
+            // calculate the deflected residual again
             elemCtx.updateIntensiveQuantities(priVars, dofIdx, /*timeIdx=*/0);
-            elemCtx.updateAllExtensiveQuantities();
-            localResidual_.eval(elemCtx);
+            evalPerturbedResidual_(perturbedResidual_, elemCtx, dofIdx);
 
-            derivResidual_ -= localResidual_.residual();
+            derivResidual_ -= perturbedResidual_;
         }
         else {
             // we are using forward differences, i.e. we don't need to
             // calculate f(x - \epsilon) and we can recycle the
             // (already calculated) residual f(x)
-            derivResidual_ -= residual_;
+            derivResidual_ -= localPerturbations_() ? unperturbedResidual_ : residual_;
         }
 
         assert(delta > 0);
@@ -510,6 +583,8 @@ protected:
 
     LocalEvalBlockVector residual_;
     LocalEvalBlockVector derivResidual_;
+    LocalEvalBlockVector perturbedResidual_;
+    LocalEvalBlockVector unperturbedResidual_;
     ScalarLocalBlockMatrix jacobian_;
 
     LocalResidual localResidual_;
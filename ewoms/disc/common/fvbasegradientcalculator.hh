@@ -72,6 +72,13 @@ public:
     static void registerParameters()
     { }
 
+    /*!
+     * \brief Returns true if the values and gradients at an interior face only depend
+     *        on the two degrees of freedom which are adjacent to it.
+     */
+    static constexpr bool isTwoPoint()
+    { return true; }
+
     /*!
      * \brief Precomputes the common values to calculate gradients and values of
      *        quantities at every interior flux approximation point.
@@ -255,6 +262,60 @@ public:
         }
     }
 
+    /*!
+     * \brief Calculates the scalar product of the gradient of an arbitrary quantity
+     *        and the normal of a flux approximation point.
+     *
+     * This is equivalent to calling calculateGradient() and multiplying the result
+     * with the face normal, but the geometric part is reduced to a single scalar
+     * factor before it is applied to the difference of the quantity.
+     *
+     * \param elemCtx The current execution context
+     * \param fapIdx The local index of the flux approximation point
+     *               in the current element's stencil.
+     * \param quantityCallback A callable object returning the value
+     *               of the quantity given the index of a degree of
+     *               freedom
+     */
+    template <class QuantityCallback>
+    void calculateNormalGradient(Evaluation& quantityGradNormal,
+                                 const ElementContext& elemCtx,
+                                 unsigned fapIdx,
+                                 const QuantityCallback& quantityCallback) const
+    {
+        const auto& stencil = elemCtx.stencil(/*timeIdx=*/0);
+        const auto& face = stencil.interiorFace(fapIdx);
+
+        auto i = face.interiorIndex();
+        auto j = face.exteriorIndex();
+        auto focusIdx = elemCtx.focusDofIndex();
+
+        const auto& interiorPos = stencil.subControlVolume(i).globalPos();
+        const auto& exteriorPos = stencil.subControlVolume(j).globalPos();
+        const auto& normal = face.normal();
+
+        // the two-point gradient is d*delta y / abs(d)^2 (see calculateGradient()), so
+        // its projection onto the normal is delta y * (d*n) / abs(d)^2.
+        Scalar distSquared = 0.0;
+        Scalar distNormal = 0.0;
+        for (unsigned dimIdx = 0; dimIdx < dimWorld; ++dimIdx) {
+            Scalar tmp = exteriorPos[dimIdx] - interiorPos[dimIdx];
+            distSquared += tmp*tmp;
+            distNormal += tmp*normal[dimIdx];
+        }
+        Scalar weight = distNormal/distSquared;
+
+        if (i == focusIdx)
+            quantityGradNormal =
+                (Toolbox::value(quantityCallback(j)) - quantityCallback(i))*weight;
+        else if (j == focusIdx)
+            quantityGradNormal =
+                (quantityCallback(j) - Toolbox::value(quantityCallback(i)))*weight;
+        else
+            quantityGradNormal =
+                (Toolbox::value(quantityCallback(j)) - Toolbox::value(quantityCallback(i)))*weight;
+    }
+
     /*!
      * \brief Calculates the value of an arbitrary quantity at any
      *        flux approximation point on the grid boundary.
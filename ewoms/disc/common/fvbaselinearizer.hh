@@ -34,6 +34,7 @@
 #include <ewoms/parallel/threadmanager.hh>
 #include <ewoms/parallel/threadedentityiterator.hh>
 #include <ewoms/disc/common/baseauxiliarymodule.hh>
+#include <ewoms/common/tracer.hh>
 
 #include <opm/material/common/Exceptions.hpp>
 
@@ -41,6 +42,9 @@
 #include <dune/common/fvector.hh>
 #include <dune/common/fmatrix.hh>
 
+#include <algorithm>
+#include <atomic>
+#include <cassert>
 #include <type_traits>
 #include <iostream>
 #include <vector>
@@ -114,6 +118,9 @@ public:
         : jacobian_()
     {
         simulatorPtr_ = 0;
+        selectiveLinearizationTolerance_ = 0.0;
+        storedLinearizationIsValid_ = false;
+        numLinearizedElements_ = 0;
     }
 
     ~FvBaseLinearizer()
@@ -128,7 +135,13 @@ public:
      * \brief Register all run-time parameters for the Jacobian linearizer.
      */
     static void registerParameters()
-    { }
+    {
+        EWOMS_REGISTER_PARAM(TypeTag, Scalar, SelectiveLinearizationTolerance,
+                             "Only relinearize the elements for which the relative change of "
+                             "the primary variables of a degree of freedom since the last "
+                             "linearization exceeds this value. 0 means that all elements "
+                             "are always linearized.");
+    }
 
     /*!
      * \brief Initialize the linearizer.
@@ -142,6 +155,8 @@ public:
     void init(Simulator& simulator)
     {
         simulatorPtr_ = &simulator;
+        selectiveLinearizationTolerance_ =
+            EWOMS_GET_PARAM(TypeTag, Scalar, SelectiveLinearizationTolerance);
         eraseMatrix();
     }
 
@@ -155,6 +170,7 @@ public:
     void eraseMatrix()
     {
         jacobian_.reset();
+        storedLinearizationIsValid_ = false;
     }
 
     /*!
@@ -186,6 +202,8 @@ public:
         if (!jacobian_)
             initFirstIteration_();
 
+        Ewoms::TraceScope traceScope("linearizeDomain", "linearizer");
+
         int succeeded;
         try {
             linearize_();
@@ -220,6 +238,55 @@ public:
             throw Opm::NumericalIssue("A process did not succeed in linearizing the system");
     }
 
+    /*!
+     * \brief Evaluate the residual of the spatial domain for the current solution, but
+     *        keep the Jacobian matrix of the last linearization.
+     *
+     * This is used by Newton methods which reuse the Jacobian of a previous
+     * iteration. Since no local Jacobians are computed and nothing needs to be added to
+     * the global matrix, this is considerably cheaper than linearizeDomain(). It
+     * requires linearizeDomain() to have been called before.
+     */
+    void linearizeDomainResidual()
+    {
+        assert(jacobian_);
+
+        Ewoms::TraceScope traceScope("linearizeDomainResidual", "linearizer");
+
+        int succeeded;
+        try {
+            linearizeResidual_();
+            succeeded = 1;
+        }
+#if ! DUNE_VERSION_NEWER(DUNE_COMMON, 2,5)
+        catch (const Dune::Exception& e)
+        {
+            std::cout << "rank " << simulator_().gridView().comm().rank()
+                      << " caught an exception while evaluating the residual:" << e.what()
+                      << "\n"  << std::flush;
+            succeeded = 0;
+        }
+#endif
+        catch (const std::exception& e)
+        {
+            std::cout << "rank " << simulator_().gridView().comm().rank()
+                      << " caught an exception while evaluating the residual:" << e.what()
+                      << "\n"  << std::flush;
+            succeeded = 0;
+        }
+        catch (...)
+        {
+            std::cout << "rank " << simulator_().gridView().comm().rank()
+                      << " caught an exception while evaluating the residual"
+                      << "\n"  << std::flush;
+            succeeded = 0;
+        }
+        succeeded = gridView_().comm().min(succeeded);
+
+        if (!succeeded)
+            throw Opm::NumericalIssue("A process did not succeed in evaluating the residual");
+    }
+
     void finalize()
     {
         jacobian_->finalize();
@@ -284,6 +351,16 @@ public:
     GlobalEqVector& residual()
     { return residual_; }
 
+    /*!
+     * \brief Returns the number of elements which were linearized by the last call to
+     *        linearizeDomain().
+     *
+     * If selective linearization is disabled, this is the number of elements of the
+     * local grid partition which needed to be considered.
+     */
+    size_t numLinearizedElements() const
+    { return numLinearizedElements_; }
+
     /*!
      * \brief Returns the map of constraint degrees of freedom.
      *
@@ -326,10 +403,74 @@ private:
         residual_.resize(model_().numTotalDof());
         resetSystem_();
 
+        // place the rows of the linear system into the memory of the NUMA nodes of
+        // the threads which handle them
+        ThreadManager::distributeContainer(residual_);
+        const auto& istlMatrix = jacobian_->istlMatrix();
+        if (istlMatrix.nonzeroes() > 0)
+            ThreadManager::distributeMemory(&(*istlMatrix.begin()->begin()),
+                                            istlMatrix.nonzeroes()*sizeof(MatrixBlock));
+
         // create the per-thread context objects
         elementCtx_.resize(ThreadManager::maxThreads());
         for (unsigned threadId = 0; threadId != ThreadManager::maxThreads(); ++ threadId)
             elementCtx_[threadId] = new ElementContext(simulator_());
+
+        if (selectiveLinearizationTolerance_ > 0.0)
+            initStoredLinearization_();
+    }
+
+    // allocate the memory for the contributions of the elements to the global linear
+    // system which are kept for selective linearization
+    void initStoredLinearization_()
+    {
+        const auto& model = model_();
+        Stencil stencil(gridView_(), model.dofMapper());
+
+        size_t numElements = gridView_().size(/*codim=*/0);
+        elemDofOffset_.assign(numElements + 1, 0);
+        elemJacobianOffset_.assign(numElements + 1, 0);
+        elemNumPrimaryDof_.assign(numElements, 0);
+
+        // first pass: count the number of degrees of freedom of each element's stencil
+        ElementIterator elemIt = gridView_().template begin<0>();
+        const ElementIterator elemEndIt = gridView_().template end<0>();
+        for (; elemIt != elemEndIt; ++elemIt) {
+            const Element& elem = *elemIt;
+            stencil.update(elem);
+
+            unsigned elemIdx = elementMapper_().index(elem);
+            elemNumPrimaryDof_[elemIdx] = stencil.numPrimaryDof();
+            elemDofOffset_[elemIdx + 1] = stencil.numDof();
+            elemJacobianOffset_[elemIdx + 1] = stencil.numDof()*stencil.numPrimaryDof();
+        }
+        for (size_t elemIdx = 0; elemIdx < numElements; ++ elemIdx) {
+            elemDofOffset_[elemIdx + 1] += elemDofOffset_[elemIdx];
+            elemJacobianOffset_[elemIdx + 1] += elemJacobianOffset_[elemIdx];
+        }
+
+        // second pass: record the global indices of the stencil's degrees of freedom
+        elemDofIndices_.resize(elemDofOffset_[numElements]);
+        for (elemIt = gridView_().template begin<0>(); elemIt != elemEndIt; ++elemIt) {
+            const Element& elem = *elemIt;
+            stencil.update(elem);
+
+            unsigned elemIdx = elementMapper_().index(elem);
+            for (unsigned dofIdx = 0; dofIdx < stencil.numDof(); ++dofIdx)
+                elemDofIndices_[elemDofOffset_[elemIdx] + dofIdx] = stencil.globalSpaceIndex(dofIdx);
+        }
+
+        // the residual of an element only exhibits entries for its primary degrees of
+        // freedom, which come first in the stencil. we thus can use the offsets of the
+        // stencil's degrees of freedom for the stored residuals as well.
+        storedJacobian_.resize(elemJacobianOffset_[numElements]);
+        storedResidual_.resize(elemDofOffset_[numElements]);
+        elemIsStored_.assign(numElements, 0);
+        elemNeedsUpdate_.assign(numElements, 1);
+        dofChanged_.assign(model.numGridDof(), 1);
+        linearizedSolution_ = model.solution(/*timeIdx=*/0);
+
+        storedLinearizationIsValid_ = false;
     }
 
     // Construct the BCRS matrix for the Jacobian of the residual function
@@ -429,7 +570,20 @@ private:
     // linearize the whole system
     void linearize_()
     {
-        resetSystem_();
+        bool storeLinearization = selectiveLinearizationTolerance_ > 0.0;
+        bool selective = storeLinearization && canLinearizeSelectively_();
+
+        if (selective)
+            // keep the Jacobian matrix of the last linearization and only add the
+            // changes of the relinearized elements' contributions
+            markChangedElements_();
+        else {
+            resetSystem_();
+            if (storeLinearization) {
+                std::fill(elemIsStored_.begin(), elemIsStored_.end(), 0);
+                linearizedSolution_ = model_().solution(/*timeIdx=*/0);
+            }
+        }
 
         // before the first iteration of each time step, we need to update the
         // constraints. (i.e., we assume that constraints can be time dependent, but they
@@ -439,6 +593,12 @@ private:
 
         applyConstraintsToSolution_();
 
+        // if requested, update the intensive quantities of all degrees of freedom region
+        // by region before the elements are visited
+        model_().updateIntensiveQuantityCacheBatched(/*timeIdx=*/0);
+
+        std::atomic<size_t> numLinearizedElements(0);
+
         // to avoid a race condition if two threads handle an exception at the same time,
         // we use an explicit lock to control access to the exception storage object
         // amongst thread-local handlers
@@ -454,6 +614,10 @@ private:
 #pragma omp parallel
 #endif
         {
+            // the elements linearized by each thread. comparing these shows load
+            // imbalances between the threads
+            Ewoms::TraceScope threadTraceScope("linearizeElements", "linearizer");
+
             ElementIterator elemIt = threadedElemIt.beginParallel();
             ElementIterator nextElemIt = elemIt;
             try {
@@ -475,7 +639,11 @@ private:
                     if (!linearizeNonLocalElements && elem.partitionType() != Dune::InteriorEntity)
                         continue;
 
+                    if (selective && !elemNeedsUpdate_[elementMapper_().index(elem)])
+                        continue;
+
                     linearizeElement_(elem);
+                    ++ numLinearizedElements;
                 }
             }
             // If an exception occurs in the parallel block, it won't escape the
@@ -498,12 +666,168 @@ private:
         // a valid exception if one occurred in one of the threads; rethrow
         // it here to let the outer handler take care of it properly
         if(exceptionPtr) {
+            // the matrix might only be partially updated, so start from scratch the
+            // next time
+            storedLinearizationIsValid_ = false;
             std::rethrow_exception(exceptionPtr);
         }
 
+        numLinearizedElements_ = numLinearizedElements;
+
+        if (storeLinearization) {
+            assembleStoredResidual_();
+            storedLinearizationIsValid_ = true;
+        }
+
         applyConstraintsToLinearization_();
     }
 
+    // returns true if the linearization of the last iteration can be selectively
+    // updated
+    bool canLinearizeSelectively_()
+    {
+        const auto& model = model_();
+
+        // the stored contributions of the elements depend on the time step size and on
+        // the solution of the last time step, so they can only be reused within a time
+        // step. since the constraints and the auxiliary modules modify the matrix after
+        // it has been linearized, the linearization of the last iteration is not
+        // available anymore if they are used.
+        return storedLinearizationIsValid_
+            && model.newtonMethod().numIterations() > 0
+            && model.numAuxiliaryModules() == 0
+            && !enableConstraints_();
+    }
+
+    // find the degrees of freedom whose primary variables changed significantly since
+    // the last linearization and mark the elements which contain them in their stencil
+    void markChangedElements_()
+    {
+        const auto& model = model_();
+        const auto& solution = model.solution(/*timeIdx=*/0);
+
+        size_t numGridDof = model.numGridDof();
+        for (unsigned dofIdx = 0; dofIdx < numGridDof; ++ dofIdx) {
+            Scalar err = model.relativeDofError(dofIdx,
+                                                solution[dofIdx],
+                                                linearizedSolution_[dofIdx]);
+            dofChanged_[dofIdx] = (err > selectiveLinearizationTolerance_);
+
+            // the elements which contain this degree of freedom will be linearized
+            // using the current solution
+            if (dofChanged_[dofIdx])
+                linearizedSolution_[dofIdx] = solution[dofIdx];
+        }
+
+        size_t numElements = elemNeedsUpdate_.size();
+        for (size_t elemIdx = 0; elemIdx < numElements; ++ elemIdx) {
+            elemNeedsUpdate_[elemIdx] = 0;
+            for (unsigned i = elemDofOffset_[elemIdx]; i < elemDofOffset_[elemIdx + 1]; ++i) {
+                if (dofChanged_[elemDofIndices_[i]]) {
+                    elemNeedsUpdate_[elemIdx] = 1;
+                    break;
+                }
+            }
+        }
+    }
+
+    // calculate the global residual from the stored contributions of all elements.
+    //
+    // the residual is not updated incrementally because the linear solver is allowed
+    // to modify it.
+    void assembleStoredResidual_()
+    {
+        residual_ = 0.0;
+
+        size_t numElements = elemIsStored_.size();
+        for (size_t elemIdx = 0; elemIdx < numElements; ++ elemIdx) {
+            if (!elemIsStored_[elemIdx])
+                continue;
+
+            unsigned offset = elemDofOffset_[elemIdx];
+            for (unsigned primaryDofIdx = 0; primaryDofIdx < elemNumPrimaryDof_[elemIdx]; ++ primaryDofIdx) {
+                unsigned globI = elemDofIndices_[offset + primaryDofIdx];
+                residual_[globI] += storedResidual_[offset + primaryDofIdx];
+            }
+        }
+    }
+
+    // evaluate the residual of the whole system but leave the Jacobian matrix alone
+    void linearizeResidual_()
+    {
+        residual_ = 0.0;
+
+        applyConstraintsToSolution_();
+
+        model_().updateIntensiveQuantityCacheBatched(/*timeIdx=*/0);
+
+        std::mutex exceptionLock;
+        std::exception_ptr exceptionPtr = nullptr;
+
+        ThreadedEntityIterator<GridView, /*codim=*/0> threadedElemIt(gridView_());
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+        {
+            ElementIterator elemIt = threadedElemIt.beginParallel();
+            try {
+                for (; !threadedElemIt.isFinished(elemIt); elemIt = threadedElemIt.increment()) {
+                    const Element& elem = *elemIt;
+                    if (!linearizeNonLocalElements && elem.partitionType() != Dune::InteriorEntity)
+                        continue;
+
+                    linearizeElementResidual_(elem);
+                }
+            }
+            // see linearize_() for why exceptions need to be bridged out of the
+            // parallel block like this
+            catch(...) {
+                std::lock_guard<std::mutex> take(exceptionLock);
+                exceptionPtr = std::current_exception();
+                threadedElemIt.setFinished();
+            }
+        }  // parallel block
+
+        if(exceptionPtr) {
+            std::rethrow_exception(exceptionPtr);
+        }
+
+        // make the right-hand side of constraint DOFs zero
+        if (enableConstraints_()) {
+            auto it = constraintsMap_.begin();
+            const auto& endIt = constraintsMap_.end();
+            for (; it != endIt; ++it)
+                residual_[it->first] = 0.0;
+        }
+    }
+
+    // evaluate the residual of an element in the interior of the process' grid
+    // partition
+    void linearizeElementResidual_(const Element& elem)
+    {
+        unsigned threadId = ThreadManager::threadId();
+
+        ElementContext& elemCtx = *elementCtx_[threadId];
+        auto& localResidual = model_().localResidual(threadId);
+
+        elemCtx.updateAll(elem);
+        localResidual.eval(elemCtx);
+
+        if (GET_PROP_VALUE(TypeTag, UseLinearizationLock))
+            globalMatrixMutex_.lock();
+
+        size_t numPrimaryDof = elemCtx.numPrimaryDof(/*timeIdx=*/0);
+        for (unsigned primaryDofIdx = 0; primaryDofIdx < numPrimaryDof; ++ primaryDofIdx) {
+            unsigned globI = elemCtx.globalSpaceIndex(/*spaceIdx=*/primaryDofIdx, /*timeIdx=*/0);
+            const auto& dofResidual = localResidual.residual(primaryDofIdx);
+            for (unsigned eqIdx = 0; eqIdx < numEq; ++ eqIdx)
+                residual_[globI][eqIdx] += Toolbox::value(dofResidual[eqIdx]);
+        }
+
+        if (GET_PROP_VALUE(TypeTag, UseLinearizationLock))
+            globalMatrixMutex_.unlock();
+    }
+
     // linearize an element in the interior of the process' grid partition
     void linearizeElement_(const Element& elem)
     {
@@ -515,6 +839,11 @@ private:
         // the actual work of linearization is done by the local linearizer class
         localLinearizer.linearize(*elementCtx, elem);
 
+        if (selectiveLinearizationTolerance_ > 0.0) {
+            storeElementLinearization_(*elementCtx, elem);
+            return;
+        }
+
         // update the right hand side and the Jacobian matrix
         if (GET_PROP_VALUE(TypeTag, UseLinearizationLock))
             globalMatrixMutex_.lock();
@@ -538,6 +867,53 @@ private:
             globalMatrixMutex_.unlock();
     }
 
+    // add the difference between the new and the stored contributions of an element
+    // to the global Jacobian matrix and store the new ones. the residual is assembled
+    // from the stored contributions afterwards.
+    void storeElementLinearization_(const ElementContext& elemCtx, const Element& elem)
+    {
+        unsigned threadId = ThreadManager::threadId();
+        const auto& localLinearizer = model_().localLinearizer(threadId);
+
+        unsigned elemIdx = elementMapper_().index(elem);
+        unsigned numDof = elemCtx.numDof(/*timeIdx=*/0);
+        unsigned numPrimaryDof = elemCtx.numPrimaryDof(/*timeIdx=*/0);
+        unsigned dofOffset = elemDofOffset_[elemIdx];
+        unsigned jacobianOffset = elemJacobianOffset_[elemIdx];
+        bool wasStored = elemIsStored_[elemIdx];
+        assert(numDof == elemDofOffset_[elemIdx + 1] - dofOffset);
+
+        if (GET_PROP_VALUE(TypeTag, UseLinearizationLock))
+            globalMatrixMutex_.lock();
+
+        for (unsigned primaryDofIdx = 0; primaryDofIdx < numPrimaryDof; ++ primaryDofIdx) {
+            unsigned globI = elemCtx.globalSpaceIndex(/*spaceIdx=*/primaryDofIdx, /*timeIdx=*/0);
+
+            storedResidual_[dofOffset + primaryDofIdx] = localLinearizer.residual(primaryDofIdx);
+
+            for (unsigned dofIdx = 0; dofIdx < numDof; ++ dofIdx) {
+                unsigned globJ = elemCtx.globalSpaceIndex(/*spaceIdx=*/dofIdx, /*timeIdx=*/0);
+                const auto& block = localLinearizer.jacobian(dofIdx, primaryDofIdx);
+                MatrixBlock& storedBlock = storedJacobian_[jacobianOffset + primaryDofIdx*numDof + dofIdx];
+
+                if (wasStored) {
+                    MatrixBlock delta(block);
+                    delta -= storedBlock;
+                    jacobian_->addToBlock(globJ, globI, delta);
+                }
+                else
+                    jacobian_->addToBlock(globJ, globI, block);
+
+                storedBlock = block;
+            }
+        }
+
+        if (GET_PROP_VALUE(TypeTag, UseLinearizationLock))
+            globalMatrixMutex_.unlock();
+
+        elemIsStored_[elemIdx] = 1;
+    }
+
     // apply the constraints to the solution. (i.e., the solution of constraint degrees
     // of freedom is set to the value of the constraint.)
     void applyConstraintsToSolution_()
@@ -594,6 +970,22 @@ private:
     // the right-hand side
     GlobalEqVector residual_;
 
+    // the contributions of the individual elements to the global linear system which
+    // are kept for selective linearization. (these are only allocated if the
+    // SelectiveLinearizationTolerance parameter is positive.)
+    Scalar selectiveLinearizationTolerance_;
+    bool storedLinearizationIsValid_;
+    size_t numLinearizedElements_;
+    std::vector<unsigned> elemDofOffset_;
+    std::vector<unsigned> elemDofIndices_;
+    std::vector<unsigned> elemNumPrimaryDof_;
+    std::vector<unsigned> elemJacobianOffset_;
+    std::vector<MatrixBlock> storedJacobian_;
+    std::vector<VectorBlock> storedResidual_;
+    std::vector<char> elemIsStored_;
+    std::vector<char> elemNeedsUpdate_;
+    std::vector<char> dofChanged_;
+    SolutionVector linearizedSolution_;
 
     std::mutex globalMatrixMutex_;
 };
@@ -151,47 +151,77 @@ public:
     }
 
     /*!
-     * \brief Compute the local residual, i.e. the deviation of the
-     *        conservation equations from zero.
+     * \brief Compute the parts of the local residual which are required to linearize it
+     *        with regard to the primary variables of the focus DOF.
+     *
+     * With automatic differentiation, the storage and source terms of all other degrees
+     * of freedom do not depend on the primary variables of the focus DOF. Since the
+     * residual of a DOF is only needed while it is focused on, these terms are skipped.
+     * This means that after calling this method, only the residual of the focus DOF and
+     * the derivatives of all residuals with regard to the focused primary variables are
+     * valid.
+     *
+     * \copydetails Doxygen::ecfvElemCtxParam
+     */
+    void evalFocusDofResidual(ElementContext& elemCtx)
+    {
+        size_t numDof = elemCtx.numDof(/*timeIdx=*/0);
+        internalResidual_.resize(numDof);
+
+        bool onlyFocusVolumeTerms =
+            !extensiveStorageTerm &&
+            !std::is_same<Scalar, Evaluation>::value;
+        eval_(internalResidual_, elemCtx, onlyFocusVolumeTerms);
+    }
+
+    /*!
+     * \brief Compute the terms of the local residual which are associated with the
+     *        focus DOF.
+     *
+     * These are the fluxes over all sub-control volume faces adjacent to the focus DOF,
+     * its storage and source terms and the boundary conditions of the boundary faces
+     * which are attached to it. If the fluxes over a face only depend on the two adjacent
+     * degrees of freedom and the storage term does not depend on the extensive
+     * quantities, these are all terms which change if the primary variables of the
+     * focus DOF are modified.
      *
      * \copydetails Doxygen::residualParam
      * \copydetails Doxygen::ecfvElemCtxParam
      */
-    void eval(LocalEvalBlockVector& residual,
-              ElementContext& elemCtx) const
+    void evalFocusDofTerms(LocalEvalBlockVector& residual,
+                           ElementContext& elemCtx) const
     {
         assert(residual.size() == elemCtx.numDof(/*timeIdx=*/0));
 
         residual = 0.0;
 
-        // evaluate the flux terms
-        asImp_().evalFluxes(residual, elemCtx, /*timeIdx=*/0);
-
-        // evaluate the storage and the source terms
-        asImp_().evalVolumeTerms_(residual, elemCtx);
-
-        // evaluate the boundary conditions
-        asImp_().evalBoundary_(residual, elemCtx, /*timeIdx=*/0);
-
-        if (useVolumetricResidual) {
-            // make the residual volume specific (i.e., make it incorrect mass per cubic
-            // meter instead of total mass)
-            size_t numDof = elemCtx.numDof(/*timeIdx=*/0);
-            for (unsigned dofIdx=0; dofIdx < numDof; ++dofIdx) {
-                if (elemCtx.dofTotalVolume(dofIdx, /*timeIdx=*/0) > 0.0) {
-                    // interior DOF
-                    Scalar dofVolume = elemCtx.dofTotalVolume(dofIdx, /*timeIdx=*/0);
+        unsigned focusDofIdx = elemCtx.focusDofIndex();
+        const auto& stencil = elemCtx.stencil(/*timeIdx=*/0);
+        size_t numInteriorFaces = elemCtx.numInteriorFaces(/*timeIdx=*/0);
+        for (unsigned scvfIdx = 0; scvfIdx < numInteriorFaces; scvfIdx++) {
+            const auto& face = stencil.interiorFace(scvfIdx);
+            if (face.interiorIndex() == focusDofIdx || face.exteriorIndex() == focusDofIdx)
+                evalFaceFlux_(residual, elemCtx, scvfIdx, /*timeIdx=*/0);
+        }
 
-                    assert(std::isfinite(dofVolume));
-                    Opm::Valgrind::CheckDefined(dofVolume);
+        asImp_().evalVolumeTerms_(residual, elemCtx, /*onlyFocusDof=*/true);
+        asImp_().evalBoundary_(residual, elemCtx, /*timeIdx=*/0, /*onlyFocusDof=*/true);
 
-                    for (unsigned eqIdx = 0; eqIdx < numEq; ++ eqIdx)
-                        residual[dofIdx][eqIdx] /= dofVolume;
-                }
-            }
-        }
+        if (useVolumetricResidual)
+            makeVolumeSpecific_(residual, elemCtx);
     }
 
+    /*!
+     * \brief Compute the local residual, i.e. the deviation of the
+     *        conservation equations from zero.
+     *
+     * \copydetails Doxygen::residualParam
+     * \copydetails Doxygen::ecfvElemCtxParam
+     */
+    void eval(LocalEvalBlockVector& residual,
+              ElementContext& elemCtx) const
+    { eval_(residual, elemCtx, /*onlyFocusVolumeTerms=*/false); }
+
     /*!
      * \brief Calculate the amount of all conservation quantities stored in all element's
      *        sub-control volumes for a given history index.
@@ -302,52 +332,10 @@ public:
                     const ElementContext& elemCtx,
                     unsigned timeIdx) const
     {
-        RateVector flux;
-
-        const auto& stencil = elemCtx.stencil(timeIdx);
         // calculate the mass flux over the sub-control volume faces
         size_t numInteriorFaces = elemCtx.numInteriorFaces(timeIdx);
-        for (unsigned scvfIdx = 0; scvfIdx < numInteriorFaces; scvfIdx++) {
-            const auto& face = stencil.interiorFace(scvfIdx);
-            unsigned i = face.interiorIndex();
-            unsigned j = face.exteriorIndex();
-
-            Opm::Valgrind::SetUndefined(flux);
-            asImp_().computeFlux(flux, /*context=*/elemCtx, scvfIdx, timeIdx);
-            Opm::Valgrind::CheckDefined(flux);
-#ifndef NDEBUG
-            for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx)
-                assert(Opm::isfinite(flux[eqIdx]));
-#endif
-
-            Scalar alpha = elemCtx.extensiveQuantities(scvfIdx, timeIdx).extrusionFactor();
-            alpha *= face.area();
-            Opm::Valgrind::CheckDefined(alpha);
-            assert(alpha > 0.0);
-            assert(Opm::isfinite(alpha));
-
-            for (unsigned eqIdx = 0; eqIdx < numEq; ++ eqIdx)
-                flux[eqIdx] *= alpha;
-
-            // The balance equation for a finite volume is given by
-            //
-            // dStorage/dt + Flux = Source
-            //
-            // where the 'Flux' and the 'Source' terms represent the
-            // mass per second which leaves the finite
-            // volume. Re-arranging this, we get
-            //
-            // dStorage/dt + Flux - Source = 0
-            //
-            // Since the mass flux as calculated by computeFlux() goes out of sub-control
-            // volume i and into sub-control volume j, we need to add the flux to finite
-            // volume i and subtract it from finite volume j
-            for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx) {
-                assert(Opm::isfinite(flux[eqIdx]));
-                residual[i][eqIdx] += flux[eqIdx];
-                residual[j][eqIdx] -= flux[eqIdx];
-            }
-        }
+        for (unsigned scvfIdx = 0; scvfIdx < numInteriorFaces; scvfIdx++)
+            evalFaceFlux_(residual, elemCtx, scvfIdx, timeIdx);
 
 #if !defined NDEBUG
         // in debug mode, ensure that the residual is well-defined
@@ -415,12 +403,114 @@ public:
     }
 
 protected:
+    /*!
+     * \brief Compute the local residual, optionally skipping the volume terms of all
+     *        degrees of freedom except the focus DOF.
+     */
+    void eval_(LocalEvalBlockVector& residual,
+               ElementContext& elemCtx,
+               bool onlyFocusVolumeTerms) const
+    {
+        assert(residual.size() == elemCtx.numDof(/*timeIdx=*/0));
+
+        residual = 0.0;
+
+        // evaluate the flux terms
+        asImp_().evalFluxes(residual, elemCtx, /*timeIdx=*/0);
+
+        // evaluate the storage and the source terms
+        asImp_().evalVolumeTerms_(residual, elemCtx, onlyFocusVolumeTerms);
+
+        // evaluate the boundary conditions
+        asImp_().evalBoundary_(residual, elemCtx, /*timeIdx=*/0);
+
+        if (useVolumetricResidual)
+            makeVolumeSpecific_(residual, elemCtx);
+    }
+
+    /*!
+     * \brief Make the residual volume specific.
+     *
+     * i.e., make it incorrect mass per cubic meter instead of total mass.
+     */
+    void makeVolumeSpecific_(LocalEvalBlockVector& residual,
+                             const ElementContext& elemCtx) const
+    {
+        size_t numDof = elemCtx.numDof(/*timeIdx=*/0);
+        for (unsigned dofIdx=0; dofIdx < numDof; ++dofIdx) {
+            if (elemCtx.dofTotalVolume(dofIdx, /*timeIdx=*/0) > 0.0) {
+                // interior DOF
+                Scalar dofVolume = elemCtx.dofTotalVolume(dofIdx, /*timeIdx=*/0);
+
+                assert(std::isfinite(dofVolume));
+                Opm::Valgrind::CheckDefined(dofVolume);
+
+                for (unsigned eqIdx = 0; eqIdx < numEq; ++ eqIdx)
+                    residual[dofIdx][eqIdx] /= dofVolume;
+            }
+        }
+    }
+
+    /*!
+     * \brief Add the flux over a single interior sub-control volume face to the local
+     *        residual.
+     */
+    void evalFaceFlux_(LocalEvalBlockVector& residual,
+                       const ElementContext& elemCtx,
+                       unsigned scvfIdx,
+                       unsigned timeIdx) const
+    {
+        RateVector flux;
+
+        const auto& stencil = elemCtx.stencil(timeIdx);
+        const auto& face = stencil.interiorFace(scvfIdx);
+        unsigned i = face.interiorIndex();
+        unsigned j = face.exteriorIndex();
+
+        Opm::Valgrind::SetUndefined(flux);
+        asImp_().computeFlux(flux, /*context=*/elemCtx, scvfIdx, timeIdx);
+        Opm::Valgrind::CheckDefined(flux);
+#ifndef NDEBUG
+        for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx)
+            assert(Opm::isfinite(flux[eqIdx]));
+#endif
+
+        Scalar alpha = elemCtx.extensiveQuantities(scvfIdx, timeIdx).extrusionFactor();
+        alpha *= face.area();
+        Opm::Valgrind::CheckDefined(alpha);
+        assert(alpha > 0.0);
+        assert(Opm::isfinite(alpha));
+
+        for (unsigned eqIdx = 0; eqIdx < numEq; ++ eqIdx)
+            flux[eqIdx] *= alpha;
+
+        // The balance equation for a finite volume is given by
+        //
+        // dStorage/dt + Flux = Source
+        //
+        // where the 'Flux' and the 'Source' terms represent the
+        // mass per second which leaves the finite
+        // volume. Re-arranging this, we get
+        //
+        // dStorage/dt + Flux - Source = 0
+        //
+        // Since the mass flux as calculated by computeFlux() goes out of sub-control
+        // volume i and into sub-control volume j, we need to add the flux to finite
+        // volume i and subtract it from finite volume j
+        for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx) {
+            assert(Opm::isfinite(flux[eqIdx]));
+            residual[i][eqIdx] += flux[eqIdx];
+            residual[j][eqIdx] -= flux[eqIdx];
+        }
+    }
+
     /*!
      * \brief Evaluate the boundary conditions of an element.
      */
     void evalBoundary_(LocalEvalBlockVector& residual,
                        const ElementContext& elemCtx,
-                       unsigned timeIdx) const
+                       unsigned timeIdx,
+                       bool onlyFocusDof = false) const
     {
         if (!elemCtx.onBoundary())
             return;
@@ -428,8 +518,13 @@ protected:
         BoundaryContext boundaryCtx(elemCtx);
 
         // evaluate the boundary for all boundary faces of the current context
+        const auto& stencil = elemCtx.stencil(timeIdx);
         size_t numBoundaryFaces = boundaryCtx.numBoundaryFaces(/*timeIdx=*/0);
         for (unsigned faceIdx = 0; faceIdx < numBoundaryFaces; ++faceIdx) {
+            if (onlyFocusDof &&
+                stencil.boundaryFace(faceIdx).interiorIndex() != elemCtx.focusDofIndex())
+                continue;
+
             // add the residual of all vertices of the boundary
             // segment
             evalBoundarySegment_(residual,
@@ -488,7 +583,8 @@ protected:
      *        current element.
      */
     void evalVolumeTerms_(LocalEvalBlockVector& residual,
-                          ElementContext& elemCtx) const
+                          ElementContext& elemCtx,
+                          bool onlyFocusDof = false) const
     {
         EvalVector tmp;
         EqVector tmp2;
@@ -500,6 +596,9 @@ protected:
         // evaluate the volumetric terms (storage + source terms)
         size_t numPrimaryDof = elemCtx.numPrimaryDof(/*timeIdx=*/0);
         for (unsigned dofIdx=0; dofIdx < numPrimaryDof; dofIdx++) {
+            if (onlyFocusDof && dofIdx != elemCtx.focusDofIndex())
+                continue;
+
             Scalar extrusionFactor =
                 elemCtx.intensiveQuantities(dofIdx, /*timeIdx=*/0).extrusionFactor();
             Opm::Valgrind::CheckDefined(extrusionFactor);
@@ -154,8 +154,11 @@ public:
 
             std::string outputDir = asImp_().outputDir();
 
+            bool cacheGeometry = EWOMS_GET_PARAM(TypeTag, bool, EnableVtkGeometryCache);
+
             defaultVtkWriter_ =
-                new VtkMultiWriter(asyncVtkOutput, gridView_, outputDir, asImp_().name());
+                new VtkMultiWriter(asyncVtkOutput, gridView_, outputDir, asImp_().name(),
+                                   /*multiFileName=*/"", cacheGeometry);
         }
     }
 
@@ -178,6 +181,9 @@ public:
                              "before the simulation bails out");
         EWOMS_REGISTER_PARAM(TypeTag, bool, EnableAsyncVtkOutput,
                              "Dispatch a separate thread to write the VTK output");
+        EWOMS_REGISTER_PARAM(TypeTag, bool, EnableVtkGeometryCache,
+                             "Write the grid only once and store the fields of each time "
+                             "step as raw binary data described by an XDMF file");
     }
 
     /*!
@@ -161,6 +161,7 @@ NEW_PROP_TAG(GridCommHandleFactory);
  */
 NEW_PROP_TAG(ThreadManager);
 NEW_PROP_TAG(ThreadsPerProcess);
+NEW_PROP_TAG(ThreadPinning);
 
 //! use locking to prevent race conditions when linearizing the global system of
 //! equations in multi-threaded mode. (setting this property to true is always save, but
@@ -168,6 +169,16 @@ NEW_PROP_TAG(ThreadsPerProcess);
 //! discretizations do not need this.)
 NEW_PROP_TAG(UseLinearizationLock);
 
+/*!
+ * \brief Only relinearize the elements for which the primary variables of at least one
+ *        degree of freedom of the stencil changed by more than this value since they
+ *        were linearized the last time.
+ *
+ * The change is measured using the model's relativeDofError() method. A value of zero
+ * disables selective linearization, i.e., all elements are always linearized.
+ */
+NEW_PROP_TAG(SelectiveLinearizationTolerance);
+
 // high-level simulation control
 
 //! Manages the simulation time
@@ -205,6 +216,16 @@ NEW_PROP_TAG(EnableVtkOutput);
  */
 NEW_PROP_TAG(EnableAsyncVtkOutput);
 
+/*!
+ * \brief Determines if the grid geometry of the VTK output is only written once
+ *
+ * If this is enabled, the points and the connectivity of the grid are written to a raw
+ * binary mesh file once (and again after the grid has changed) and each time step only
+ * writes the raw field data plus an XDMF description which refers to the shared
+ * mesh. The VtkOutputFormat property is ignored in this case.
+ */
+NEW_PROP_TAG(EnableVtkGeometryCache);
+
 /*!
  * \brief Specify the format the VTK output is written to disk
  *
@@ -250,6 +271,18 @@ NEW_PROP_TAG(MaxTimeStepDivisions);
  */
 NEW_PROP_TAG(EnableIntensiveQuantityCache);
 
+/*!
+ * \brief The number of degrees of freedom whose intensive quantities are updated as a
+ *        batch before the system is linearized.
+ *
+ * If this is larger than zero and the intensive quantity cache is enabled, the degrees of
+ * freedom are grouped by the regions which determine their parameters (e.g., the PVT and
+ * saturation function regions of the black-oil model). Their intensive quantities are
+ * then updated one region after the other instead of in the order of the elements. A
+ * value of 0 disables this.
+ */
+NEW_PROP_TAG(IntensiveQuantityBatchSize);
+
 /*!
  * \brief Specify whether the storage terms for previous solutions should be cached.
  *
@@ -258,6 +291,27 @@ NEW_PROP_TAG(EnableIntensiveQuantityCache);
  */
 NEW_PROP_TAG(EnableStorageCache);
 
+/*!
+ * \brief Specify whether the geometric part of the stencils should be precomputed for
+ *        all elements.
+ *
+ * This avoids re-computing the stencil geometries each time an element context is
+ * updated, but it comes at the cost of higher memory consumption. The option only has
+ * an effect for discretizations which support it.
+ */
+NEW_PROP_TAG(EnableStencilCache);
+
+/*!
+ * \brief Specify whether the large per-DOF arrays should be backed by huge pages.
+ *
+ * Possible values are 'none', 'transparent' and 'explicit'. Huge pages reduce the
+ * number of TLB misses for large simulations. This affects the caches of the
+ * discretization and all vectors and matrices which use Ewoms::HugePageAllocator. The
+ * default GlobalEqVector, SolutionVector and SparseMatrixAdapter types use the standard
+ * allocators.
+ */
+NEW_PROP_TAG(HugePages);
+
 /*!
  * \brief Specify whether to use the already calculated solutions as
  *        starting values of the intensive quantities.
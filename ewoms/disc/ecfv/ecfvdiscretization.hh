@@ -133,9 +133,45 @@ class EcfvDiscretization : public FvBaseDiscretization<TypeTag>
     typedef typename GET_PROP_TYPE(TypeTag, Simulator) Simulator;
 
 public:
+    typedef typename GET_PROP_TYPE(TypeTag, Stencil) Stencil;
+
     EcfvDiscretization(Simulator& simulator)
         : ParentType(simulator)
-    { }
+    {
+        // the cached stencils would need to be re-computed each time the grid is
+        // adapted, which defeats their purpose
+        enableStencilCache_ =
+            EWOMS_GET_PARAM(TypeTag, bool, EnableStencilCache)
+            && !EWOMS_GET_PARAM(TypeTag, bool, EnableGridAdaptation);
+    }
+
+    /*!
+     * \brief Register all run-time parameters for the model.
+     */
+    static void registerParameters()
+    {
+        ParentType::registerParameters();
+
+        EWOMS_REGISTER_PARAM(TypeTag, bool, EnableStencilCache,
+                             "Precompute the faces and neighbors of all elements");
+    }
+
+    /*!
+     * \copydoc FvBaseDiscretization::finishInit()
+     */
+    void finishInit()
+    {
+        if (enableStencilCache_)
+            stencilCache_.update(this->gridView_, this->elementMapper());
+
+        ParentType::finishInit();
+    }
+
+    /*!
+     * \copydoc FvBaseDiscretization::attachStencilCache()
+     */
+    void attachStencilCache(Stencil& stencil) const
+    { stencil.setGeometryCache(enableStencilCache_ ? &stencilCache_ : nullptr); }
 
     /*!
      * \brief Returns a string of discretization's human-readable name
@@ -164,20 +200,14 @@ public:
      * For the Element Centered Finite Volume discretization, this
      * method retrieves the primary variables corresponding to
      * overlap/ghost elements from their respective master process.
+     * This is equivalent to a GridCommHandleGhostSync, but avoids the
+     * overhead of Dune's generic per-entity communication.
      */
     void syncOverlap()
     {
-        // syncronize the solution on the ghost and overlap elements
-        typedef GridCommHandleGhostSync<PrimaryVariables,
-                                        SolutionVector,
-                                        DofMapper,
-                                        /*commCodim=*/0> GhostSyncHandle;
-
-        auto ghostSync = GhostSyncHandle(this->solution(/*timeIdx=*/0),
-                                         asImp_().dofMapper());
-        this->gridView().communicate(ghostSync,
-                                     Dune::InteriorBorder_All_Interface,
-                                     Dune::ForwardCommunication);
+        // syncronize the solution on the ghost and overlap elements. the indices which
+        // need to be exchanged are only determined once for each version of the grid.
+        this->haloExchange_().sync(this->solution(/*timeIdx=*/0));
     }
 
     /*!
@@ -210,6 +240,9 @@ private:
     { return *static_cast<Implementation*>(this); }
     const Implementation& asImp_() const
     { return *static_cast<const Implementation*>(this); }
+
+    bool enableStencilCache_;
+    typename Stencil::GeometryCache stencilCache_;
 };
 } // namespace Ewoms
 
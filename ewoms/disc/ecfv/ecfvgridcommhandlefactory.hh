@@ -31,6 +31,7 @@
 #include "ecfvproperties.hh"
 
 #include <ewoms/parallel/gridcommhandles.hh>
+#include <ewoms/parallel/gridhaloexchange.hh>
 
 namespace Ewoms {
 /*!
@@ -45,8 +46,15 @@ template<class TypeTag>
 class EcfvGridCommHandleFactory
 {
     typedef typename GET_PROP_TYPE(TypeTag, DofMapper) DofMapper;
+    typedef typename GET_PROP_TYPE(TypeTag, GridView) GridView;
 
 public:
+    /*!
+     * \brief The type of the object which exchanges the values of the degrees of
+     *        freedom on the process boundaries using precomputed index lists.
+     */
+    typedef GridHaloExchange<GridView, DofMapper, /*commCodim=*/0> HaloExchange;
+
     /*!
      * \brief Return a handle which computes the minimum of a value
      *        for each overlapping degree of freedom across all processes.
@@ -99,6 +99,14 @@ public:
             : element_(element)
         { update(); }
 
+        SubControlVolume(const Element& element,
+                         const GlobalPosition& centerPos,
+                         Scalar volume)
+            : centerPos_(centerPos)
+            , volume_(volume)
+            , element_(element)
+        { }
+
         void update(const Element& element)
         { element_ = element; }
 
@@ -220,16 +228,191 @@ public:
     typedef EcfvSubControlVolumeFace<needFaceIntegrationPos, needFaceNormal> SubControlVolumeFace;
     typedef EcfvSubControlVolumeFace</*needFaceIntegrationPos=*/true, needFaceNormal> BoundaryFace;
 
+    /*!
+     * \brief Stores the faces and the neighbors of all elements of a grid view.
+     *
+     * The data is kept in compressed row storage format, i.e., the interior faces, the
+     * indices of the neighboring elements and the boundary faces of all elements are
+     * stored contiguously and the faces of a given element are located using offsets
+     * which are addressed by the element index. Updating a stencil from the cache
+     * thus avoids iterating over the intersections of the element and re-computing
+     * the geometry of its faces and of its neighbors.
+     *
+     * The cache must be updated each time the grid is changed.
+     */
+    class GeometryCache
+    {
+        friend class EcfvStencil;
+
+        typedef typename Element::EntitySeed ElementSeed;
+
+    public:
+        /*!
+         * \brief Compute the faces and neighbors of all elements of a grid view.
+         *
+         * \param gridView The grid view for which the stencils are computed
+         * \param elementMapper The mapper for the elements of the grid view
+         */
+        void update(const GridView& gridView, const Mapper& elementMapper)
+        {
+            clear();
+
+            size_t numElements = static_cast<size_t>(gridView.size(/*codim=*/0));
+            elementSeeds_.resize(numElements);
+            centers_.resize(numElements);
+            volumes_.resize(numElements);
+            interiorFaceOffsets_.resize(numElements + 1, 0);
+            boundaryFaceOffsets_.resize(numElements + 1, 0);
+
+            // count the faces of each element and compute the geometry of the
+            // elements. this requires the stencils to be computed twice, but the
+            // resulting data is ordered by element index regardless of the order in
+            // which the grid's elements are traversed.
+            EcfvStencil stencil(gridView, elementMapper);
+            auto elemIt = gridView.template begin</*codim=*/0>();
+            const auto& elemEndIt = gridView.template end</*codim=*/0>();
+            for (; elemIt != elemEndIt; ++elemIt) {
+                const auto& elem = *elemIt;
+                stencil.updateTopology(elem);
+
+                unsigned elemIdx = static_cast<unsigned>(elementMapper.index(elem));
+                elementSeeds_[elemIdx] = elem.seed();
+                centers_[elemIdx] = stencil.subControlVolume(/*dofIdx=*/0).center();
+                volumes_[elemIdx] = stencil.subControlVolume(/*dofIdx=*/0).volume();
+                interiorFaceOffsets_[elemIdx + 1] = static_cast<unsigned>(stencil.numInteriorFaces());
+                boundaryFaceOffsets_[elemIdx + 1] = static_cast<unsigned>(stencil.numBoundaryFaces());
+            }
+
+            for (size_t elemIdx = 0; elemIdx < numElements; ++elemIdx) {
+                interiorFaceOffsets_[elemIdx + 1] += interiorFaceOffsets_[elemIdx];
+                boundaryFaceOffsets_[elemIdx + 1] += boundaryFaceOffsets_[elemIdx];
+            }
+
+            neighborIndices_.resize(interiorFaceOffsets_.back());
+            interiorFaces_.resize(interiorFaceOffsets_.back());
+            boundaryFaces_.resize(boundaryFaceOffsets_.back());
+
+            // copy the faces and the indices of the neighbors
+            elemIt = gridView.template begin</*codim=*/0>();
+            for (; elemIt != elemEndIt; ++elemIt) {
+                const auto& elem = *elemIt;
+                stencil.updateTopology(elem);
+
+                unsigned elemIdx = static_cast<unsigned>(elementMapper.index(elem));
+                unsigned faceOffset = interiorFaceOffsets_[elemIdx];
+                for (unsigned faceIdx = 0; faceIdx < stencil.numInteriorFaces(); ++faceIdx) {
+                    const auto& face = stencil.interiorFace(faceIdx);
+                    interiorFaces_[faceOffset + faceIdx] = face;
+                    neighborIndices_[faceOffset + faceIdx] =
+                        stencil.globalSpaceIndex(face.exteriorIndex());
+                }
+
+                unsigned bfOffset = boundaryFaceOffsets_[elemIdx];
+                for (unsigned bfIdx = 0; bfIdx < stencil.numBoundaryFaces(); ++bfIdx)
+                    boundaryFaces_[bfOffset + bfIdx] = stencil.boundaryFace(bfIdx);
+            }
+        }
+
+        /*!
+         * \brief Release all stored data.
+         *
+         * Afterwards, the stencils compute their geometries on the fly.
+         */
+        void clear()
+        {
+            elementSeeds_.clear();
+            centers_.clear();
+            volumes_.clear();
+            interiorFaceOffsets_.clear();
+            neighborIndices_.clear();
+            interiorFaces_.clear();
+            boundaryFaceOffsets_.clear();
+            boundaryFaces_.clear();
+        }
+
+        /*!
+         * \brief Returns true if no data is stored.
+         */
+        bool empty() const
+        { return elementSeeds_.empty(); }
+
+    private:
+        // returns false if the element is not known
+        bool contains_(unsigned elemIdx) const
+        { return elemIdx < elementSeeds_.size(); }
+
+        // set the central element of a stencil object
+        void loadPrimary_(EcfvStencil& stencil, const Element& elem, unsigned elemIdx) const
+        {
+            stencil.elements_.clear();
+            stencil.elements_.emplace_back(elem);
+            stencil.subControlVolumes_.clear();
+            stencil.subControlVolumes_.emplace_back(elem, centers_[elemIdx], volumes_[elemIdx]);
+        }
+
+        // copy the faces and the neighbors of an element to a stencil object
+        void load_(EcfvStencil& stencil, const Element& elem, unsigned elemIdx) const
+        {
+            loadPrimary_(stencil, elem, elemIdx);
+
+            const auto& grid = stencil.gridView_.grid();
+            unsigned faceBegin = interiorFaceOffsets_[elemIdx];
+            unsigned faceEnd = interiorFaceOffsets_[elemIdx + 1];
+            for (unsigned i = faceBegin; i < faceEnd; ++i) {
+                unsigned neighborIdx = neighborIndices_[i];
+                stencil.elements_.emplace_back(grid.entity(elementSeeds_[neighborIdx]));
+                stencil.subControlVolumes_.emplace_back(stencil.elements_.back(),
+                                                        centers_[neighborIdx],
+                                                        volumes_[neighborIdx]);
+            }
+
+            stencil.interiorFaces_.assign(interiorFaces_.begin() + faceBegin,
+                                          interiorFaces_.begin() + faceEnd);
+            stencil.boundaryFaces_.assign(boundaryFaces_.begin() + boundaryFaceOffsets_[elemIdx],
+                                          boundaryFaces_.begin() + boundaryFaceOffsets_[elemIdx + 1]);
+        }
+
+        std::vector<ElementSeed> elementSeeds_;
+        std::vector<GlobalPosition> centers_;
+        std::vector<Scalar> volumes_;
+
+        std::vector<unsigned> interiorFaceOffsets_;
+        std::vector<unsigned> neighborIndices_;
+        std::vector<SubControlVolumeFace> interiorFaces_;
+
+        std::vector<unsigned> boundaryFaceOffsets_;
+        std::vector<BoundaryFace> boundaryFaces_;
+    };
+
     EcfvStencil(const GridView& gridView, const Mapper& mapper)
         : gridView_(gridView)
         , elementMapper_(mapper)
+        , geometryCache_(nullptr)
     {
         // try to ensure that the mapper passed indeed maps elements
         assert(int(gridView.size(/*codim=*/0)) == int(elementMapper_.size()));
     }
 
+    /*!
+     * \brief Specify the object from which the faces and neighbors of the stencil are
+     *        copied.
+     *
+     * If the cache is a null pointer or if it does not contain the element, the
+     * stencil is computed on the fly.
+     */
+    void setGeometryCache(const GeometryCache* geometryCache)
+    { geometryCache_ = geometryCache; }
+
     void updateTopology(const Element& element)
     {
+        if (geometryCache_) {
+            unsigned elemIdx = static_cast<unsigned>(elementMapper_.index(element));
+            if (geometryCache_->contains_(elemIdx)) {
+                geometryCache_->load_(*this, element, elemIdx);
+                return;
+            }
+        }
+
         auto isIt = gridView_.ibegin(element);
         const auto& endIsIt = gridView_.iend(element);
 
@@ -260,6 +443,14 @@ public:
 
     void updatePrimaryTopology(const Element& element)
     {
+        if (geometryCache_) {
+            unsigned elemIdx = static_cast<unsigned>(elementMapper_.index(element));
+            if (geometryCache_->contains_(elemIdx)) {
+                geometryCache_->loadPrimary_(*this, element, elemIdx);
+                return;
+            }
+        }
+
         // add the "center" element of the stencil
         subControlVolumes_.clear();
         subControlVolumes_.emplace_back(/*SubControlVolume(*/element/*)*/);
@@ -390,6 +581,8 @@ protected:
     std::vector<SubControlVolume>      subControlVolumes_;
     std::vector<SubControlVolumeFace>  interiorFaces_;
     std::vector<BoundaryFace>  boundaryFaces_;
+
+    const GeometryCache* geometryCache_;
 };
 
 } // namespace Ewoms
@@ -89,6 +89,15 @@ class P1FeGradientCalculator : public FvBaseGradientCalculator<TypeTag>
 #endif // HAVE_DUNE_LOCALFUNCTIONS
 
 public:
+    /*!
+     * \brief Returns true if the values and gradients at an interior face only depend
+     *        on the two degrees of freedom which are adjacent to it.
+     *
+     * This is not the case if P1 finite element gradients are used.
+     */
+    static constexpr bool isTwoPoint()
+    { return !GET_PROP_VALUE(TypeTag, UseP1FiniteElementGradients); }
+
     /*!
      * \brief Precomputes the common values to calculate gradients and
      *        values of quantities at any flux approximation point.
@@ -110,6 +119,10 @@ public:
             const LocalFiniteElement& localFE = feCache_.get(elemCtx.element().type());
             localFiniteElement_ = &localFE;
 
+            // the gradients of the shape functions in local coordinates. this is
+            // declared outside of the loop so that its memory is only allocated once
+            std::vector<ShapeJacobian> localGradient;
+
             // loop over all face centeres
             for (unsigned faceIdx = 0; faceIdx < stencil.numInteriorFaces(); ++faceIdx) {
                 const auto& localFacePos = stencil.interiorFace(faceIdx).localPos();
@@ -121,7 +134,6 @@ public:
 
                 if (prepareGradients) {
                     // first, get the shape function's gradient in local coordinates
-                    std::vector<ShapeJacobian> localGradient;
                     localFE.localBasis().evaluateJacobian(localFacePos, localGradient);
 
                     // convert to a gradient in global space by
@@ -296,6 +308,36 @@ public:
             ParentType::calculateGradient(quantityGrad, elemCtx, fapIdx, quantityCallback);
     }
 
+    /*!
+     * \brief Calculates the scalar product of the gradient of an arbitrary quantity
+     *        and the normal of a flux approximation point.
+     *
+     * \param elemCtx The current execution context
+     * \param fapIdx The local index of the flux approximation point
+     *               in the current element's stencil.
+     * \param quantityCallback A callable object returning the value
+     *               of the quantity at an index of a degree of
+     *               freedom
+     */
+    template <class QuantityCallback>
+    void calculateNormalGradient(Evaluation& quantityGradNormal,
+                                 const ElementContext& elemCtx,
+                                 unsigned fapIdx,
+                                 const QuantityCallback& quantityCallback) const
+    {
+        if (GET_PROP_VALUE(TypeTag, UseP1FiniteElementGradients)) {
+            Dune::FieldVector<Evaluation, dim> quantityGrad;
+            calculateGradient(quantityGrad, elemCtx, fapIdx, quantityCallback);
+
+            const auto& normal = elemCtx.stencil(/*timeIdx=*/0).interiorFace(fapIdx).normal();
+            quantityGradNormal = 0.0;
+            for (int dimIdx = 0; dimIdx < dim; ++ dimIdx)
+                quantityGradNormal += normal[dimIdx]*quantityGrad[dimIdx];
+        }
+        else
+            ParentType::calculateNormalGradient(quantityGradNormal, elemCtx, fapIdx, quantityCallback);
+    }
+
     /*!
      * \brief Calculates the value of an arbitrary quantity at any
      *        flux approximation point on the grid boundary.
@@ -139,9 +139,47 @@ class VcfvDiscretization : public FvBaseDiscretization<TypeTag>
     enum { dim = GridView::dimension };
 
 public:
+    typedef typename GET_PROP_TYPE(TypeTag, Stencil) Stencil;
+
     VcfvDiscretization(Simulator& simulator)
         : ParentType(simulator)
-    { }
+    {
+        // the cached stencil geometries would need to be re-computed each time the
+        // grid is adapted, which defeats their purpose
+        enableStencilCache_ =
+            EWOMS_GET_PARAM(TypeTag, bool, EnableStencilCache)
+            && !EWOMS_GET_PARAM(TypeTag, bool, EnableGridAdaptation);
+    }
+
+    /*!
+     * \brief Register all run-time parameters for the model.
+     */
+    static void registerParameters()
+    {
+        ParentType::registerParameters();
+
+        EWOMS_REGISTER_PARAM(TypeTag, bool, EnableStencilCache,
+                             "Precompute the geometry of the stencils of all elements");
+    }
+
+    /*!
+     * \copydoc FvBaseDiscretization::finishInit()
+     */
+    void finishInit()
+    {
+        // the stencil geometries are needed to compute the volumes of the degrees of
+        // freedom, so they are computed first
+        if (enableStencilCache_)
+            stencilCache_.update(this->gridView_, this->vertexMapper());
+
+        ParentType::finishInit();
+    }
+
+    /*!
+     * \copydoc FvBaseDiscretization::attachStencilCache()
+     */
+    void attachStencilCache(Stencil& stencil) const
+    { stencil.setGeometryCache(enableStencilCache_ ? &stencilCache_ : nullptr); }
 
     /*!
      * \brief Returns a string of discretization's human-readable name
@@ -192,6 +230,9 @@ private:
     { return *static_cast<Implementation*>(this); }
     const Implementation& asImp_() const
     { return *static_cast<const Implementation*>(this); }
+
+    bool enableStencilCache_;
+    typename Stencil::GeometryCache stencilCache_;
 };
 } // namespace Ewoms
 
@@ -31,6 +31,7 @@
 #include "vcfvproperties.hh"
 
 #include <ewoms/parallel/gridcommhandles.hh>
+#include <ewoms/parallel/gridhaloexchange.hh>
 
 namespace Ewoms {
 /*!
@@ -50,6 +51,12 @@ class VcfvGridCommHandleFactory
     static const int dim = GridView::dimension;
 
 public:
+    /*!
+     * \brief The type of the object which exchanges the values of the degrees of
+     *        freedom on the process boundaries using precomputed index lists.
+     */
+    typedef GridHaloExchange<GridView, DofMapper, /*commCodim=*/dim> HaloExchange;
+
     /*!
      * \brief Return a handle which computes the minimum of a value
      *        for each overlapping degree of freedom across all processes.
@@ -43,6 +43,8 @@
 
 #include <dune/common/version.hh>
 
+#include <algorithm>
+#include <memory>
 #include <vector>
 
 namespace Ewoms {
@@ -814,10 +816,166 @@ public:
     //! compatibility typedef
     typedef SubControlVolumeFace BoundaryFace;
 
+    /*!
+     * \brief Stores the geometric part of the stencils of all elements of a grid view.
+     *
+     * Since the geometry of the stencils only changes if the grid is modified, it can
+     * be computed once for all elements and subsequently be copied to the stencil
+     * objects instead of re-computing it each time a stencil is updated. The data of
+     * all elements is stored contiguously and is addressed using the index of the
+     * element.
+     *
+     * The cache must be updated each time the grid is changed.
+     */
+    class GeometryCache
+    {
+        friend class VcfvStencil;
+
+#if DUNE_VERSION_NEWER(DUNE_GRID, 2,6)
+        typedef Dune::MultipleCodimMultipleGeomTypeMapper<GridView> ElementMapper;
+#else
+        typedef Dune::MultipleCodimMultipleGeomTypeMapper<GridView, Dune::MCMGElementLayout> ElementMapper;
+#endif
+
+        struct ElementEntry
+        {
+            unsigned scvOffset;
+            unsigned scvfOffset;
+            unsigned boundaryFaceOffset;
+            unsigned numVertices;
+            unsigned numEdges;
+            unsigned numFaces;
+            unsigned numBoundarySegments;
+            Scalar elementVolume;
+            LocalPosition elementLocal;
+            GlobalPosition elementGlobal;
+            Dune::GeometryType geometryType;
+        };
+
+    public:
+        /*!
+         * \brief Compute the stencil geometries of all elements of a grid view.
+         *
+         * \param gridView The grid view for which the stencils are computed
+         * \param vertexMapper The mapper for the vertices of the grid view
+         */
+        void update(const GridView& gridView, const Mapper& vertexMapper)
+        {
+            clear();
+
+#if DUNE_VERSION_NEWER(DUNE_GRID, 2,6)
+            elementMapper_.reset(new ElementMapper(gridView, Dune::mcmgElementLayout()));
+#else
+            elementMapper_.reset(new ElementMapper(gridView));
+#endif
+            elements_.resize(static_cast<size_t>(gridView.size(/*codim=*/0)));
+
+            VcfvStencil stencil(gridView, vertexMapper);
+            auto elemIt = gridView.template begin</*codim=*/0>();
+            const auto& elemEndIt = gridView.template end</*codim=*/0>();
+            for (; elemIt != elemEndIt; ++elemIt) {
+                const auto& elem = *elemIt;
+                stencil.update(elem);
+#if HAVE_DUNE_LOCALFUNCTIONS
+                stencil.updateCenterGradients();
+#endif
+
+                ElementEntry& entry = elements_[elementMapper_->index(elem)];
+                entry.scvOffset = static_cast<unsigned>(subContVol_.size());
+                entry.scvfOffset = static_cast<unsigned>(subContVolFace_.size());
+                entry.boundaryFaceOffset = static_cast<unsigned>(boundaryFace_.size());
+                entry.numVertices = stencil.numVertices;
+                entry.numEdges = stencil.numEdges;
+                entry.numFaces = stencil.numFaces;
+                entry.numBoundarySegments = stencil.numBoundarySegments_;
+                entry.elementVolume = stencil.elementVolume;
+                entry.elementLocal = stencil.elementLocal;
+                entry.elementGlobal = stencil.elementGlobal;
+                entry.geometryType = stencil.geometryType_;
+
+                subContVol_.insert(subContVol_.end(),
+                                   stencil.subContVol,
+                                   stencil.subContVol + stencil.numVertices);
+                subContVolFace_.insert(subContVolFace_.end(),
+                                       stencil.subContVolFace,
+                                       stencil.subContVolFace + stencil.numEdges);
+                boundaryFace_.insert(boundaryFace_.end(),
+                                     stencil.boundaryFace_,
+                                     stencil.boundaryFace_ + stencil.numBoundarySegments_);
+            }
+        }
+
+        /*!
+         * \brief Release all stored data.
+         *
+         * Afterwards, the stencils compute their geometries on the fly.
+         */
+        void clear()
+        {
+            elementMapper_.reset();
+            elements_.clear();
+            subContVol_.clear();
+            subContVolFace_.clear();
+            boundaryFace_.clear();
+        }
+
+        /*!
+         * \brief Returns true if no data is stored.
+         */
+        bool empty() const
+        { return elements_.empty(); }
+
+    private:
+        // copy the geometry of an element to a stencil object. returns false if the
+        // element is not known.
+        bool load_(VcfvStencil& stencil, const Element& elem) const
+        {
+            if (!elementMapper_)
+                return false;
+
+            unsigned elemIdx = static_cast<unsigned>(elementMapper_->index(elem));
+            if (elemIdx >= elements_.size())
+                return false;
+
+            const ElementEntry& entry = elements_[elemIdx];
+            stencil.element_ = elem;
+            stencil.numVertices = entry.numVertices;
+            stencil.numEdges = entry.numEdges;
+            stencil.numFaces = entry.numFaces;
+            stencil.numBoundarySegments_ = entry.numBoundarySegments;
+            stencil.elementVolume = entry.elementVolume;
+            stencil.elementLocal = entry.elementLocal;
+            stencil.elementGlobal = entry.elementGlobal;
+            stencil.geometryType_ = entry.geometryType;
+
+            std::copy_n(subContVol_.begin() + entry.scvOffset,
+                        entry.numVertices,
+                        stencil.subContVol);
+            std::copy_n(subContVolFace_.begin() + entry.scvfOffset,
+                        entry.numEdges,
+                        stencil.subContVolFace);
+            std::copy_n(boundaryFace_.begin() + entry.boundaryFaceOffset,
+                        entry.numBoundarySegments,
+                        stencil.boundaryFace_);
+
+            // the geometries of the sub-control volumes refer to the element object
+            stencil.setScvGeometries_(elem, entry.geometryType);
+
+            return true;
+        }
+
+        std::unique_ptr<ElementMapper> elementMapper_;
+        std::vector<ElementEntry> elements_;
+        std::vector<SubControlVolume> subContVol_;
+        std::vector<SubControlVolumeFace> subContVolFace_;
+        std::vector<BoundaryFace> boundaryFace_;
+    };
+
     VcfvStencil(const GridView& gridView, const Mapper& mapper)
         : gridView_(gridView)
         , vertexMapper_(mapper )
         , element_(*gridView.template begin</*codim=*/0>())
+        , geometryCache_(nullptr)
     {
         // try to check if the mapper really maps the vertices
         assert(static_cast<int>(gridView.size(/*codim=*/dimWorld)) == static_cast<int>(mapper.size()));
@@ -867,8 +1025,20 @@ public:
         updateTopology(element);
     }
 
+    /*!
+     * \brief Specify the object from which the geometry of the stencil is copied.
+     *
+     * If the cache is a null pointer or if it does not contain the element, the
+     * geometry is computed on the fly.
+     */
+    void setGeometryCache(const GeometryCache* geometryCache)
+    { geometryCache_ = geometryCache; }
+
     void update(const Element& e)
     {
+        if (geometryCache_ && geometryCache_->load_(*this, e))
+            return;
+
         updateTopology(e);
 
         const Geometry& geometry = e.geometry();
@@ -1020,27 +1190,7 @@ public:
     }
 
     void updateScvGeometry(const Element& element)
-    {
-        auto geomType = element.geometry().type();
-
-        // get the local geometries of the sub control volumes
-        if (geomType.isTriangle() || geomType.isTetrahedron()) {
-            for (unsigned vertIdx = 0; vertIdx < numVertices; ++vertIdx) {
-                subContVol[vertIdx].geometry_.element_ = &element;
-                subContVol[vertIdx].geometry_.localGeometry_ =
-                    &VcfvScvGeometries<Scalar, dim, ElementType::simplex>::get(vertIdx);
-            }
-        }
-        else if (geomType.isLine() || geomType.isQuadrilateral() || geomType.isHexahedron()) {
-            for (unsigned vertIdx = 0; vertIdx < numVertices; ++vertIdx) {
-                subContVol[vertIdx].geometry_.element_ = &element;
-                subContVol[vertIdx].geometry_.localGeometry_ =
-                    &VcfvScvGeometries<Scalar, dim, ElementType::cube>::get(vertIdx);
-            }
-        }
-        else
-            throw std::logic_error("Not implemented: SCV geometries for non hexahedron elements");
-    }
+    { setScvGeometries_(element, element.geometry().type()); }
 
 #if HAVE_DUNE_LOCALFUNCTIONS
     void updateCenterGradients()
@@ -1112,6 +1262,27 @@ public:
     }
 
 private:
+    void setScvGeometries_(const Element& element, const Dune::GeometryType& geomType)
+    {
+        // get the local geometries of the sub control volumes
+        if (geomType.isTriangle() || geomType.isTetrahedron()) {
+            for (unsigned vertIdx = 0; vertIdx < numVertices; ++vertIdx) {
+                subContVol[vertIdx].geometry_.element_ = &element;
+                subContVol[vertIdx].geometry_.localGeometry_ =
+                    &VcfvScvGeometries<Scalar, dim, ElementType::simplex>::get(vertIdx);
+            }
+        }
+        else if (geomType.isLine() || geomType.isQuadrilateral() || geomType.isHexahedron()) {
+            for (unsigned vertIdx = 0; vertIdx < numVertices; ++vertIdx) {
+                subContVol[vertIdx].geometry_.element_ = &element;
+                subContVol[vertIdx].geometry_.localGeometry_ =
+                    &VcfvScvGeometries<Scalar, dim, ElementType::cube>::get(vertIdx);
+            }
+        }
+        else
+            throw std::logic_error("Not implemented: SCV geometries for non hexahedron elements");
+    }
+
 #if __GNUC__ || __clang__
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wpragmas"
@@ -1382,6 +1553,8 @@ private:
     //! number of faces (0 in < 3D)
     unsigned numFaces;
     Dune::GeometryType geometryType_;
+
+    const GeometryCache* geometryCache_;
 };
 
 #if HAVE_DUNE_LOCALFUNCTIONS
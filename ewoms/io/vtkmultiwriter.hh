@@ -31,9 +31,11 @@
 #include "vtkscalarfunction.hh"
 #include "vtkvectorfunction.hh"
 #include "vtktensorfunction.hh"
+#include "xdmfwriter.hh"
 
 #include <ewoms/io/baseoutputwriter.hh>
 #include <ewoms/parallel/tasklets.hh>
+#include <ewoms/common/tracer.hh>
 
 #include <opm/material/common/Valgrind.hpp>
 #include <opm/material/common/Unused.hpp>
@@ -46,7 +48,10 @@
 #include <mpi.h>
 #endif
 
+#include <algorithm>
 #include <list>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <limits>
 #include <sstream>
@@ -63,37 +68,6 @@ namespace Ewoms {
 template <class GridView, int vtkFormat>
 class VtkMultiWriter : public BaseOutputWriter
 {
-    class WriteDataTasklet : public TaskletInterface
-    {
-    public:
-        WriteDataTasklet(VtkMultiWriter& multiWriter)
-            : multiWriter_(multiWriter)
-        { }
-
-        void run() final
-        {
-            std::string fileName;
-            // write the actual data as vtu or vtp (plus the pieces file in the parallel case)
-            if (multiWriter_.commSize_ > 1)
-                fileName = multiWriter_.curWriter_->pwrite(/*name=*/multiWriter_.curOutFileName_,
-                                                           /*path=*/multiWriter_.outputDir_,
-                                                           /*extendPath=*/"",
-                                                           static_cast<Dune::VTK::OutputType>(vtkFormat));
-            else
-                fileName = multiWriter_.curWriter_->write(/*name=*/multiWriter_.outputDir_ + "/" + multiWriter_.curOutFileName_,
-                                                          static_cast<Dune::VTK::OutputType>(vtkFormat));
-
-            // determine name to write into the multi-file for the
-            // current time step
-            multiWriter_.multiFile_.precision(16);
-            multiWriter_.multiFile_ << "   <DataSet timestep=\"" << multiWriter_.curTime_ << "\" file=\""
-                                    << fileName << "\"/>\n";
-        }
-
-    private:
-        VtkMultiWriter& multiWriter_;
-    };
-
     enum { dim = GridView::dimension };
 
 #if DUNE_VERSION_NEWER(DUNE_GRID, 2,6)
@@ -119,11 +93,167 @@ public:
     typedef typename VtkWriter::VTKFunctionPtr FunctionPtr;
 #endif
 
+    typedef Ewoms::XdmfWriter<GridView, VertexMapper, ElementMapper> XdmfWriter;
+
+private:
+    // a stash of buffers whose memory can be reused. buffers are returned to the pool
+    // by the thread which writes the data to disk.
+    template <class Buffer>
+    class BufferPool_
+    {
+    public:
+        ~BufferPool_()
+        {
+            for (Buffer *buf : buffers_)
+                delete buf;
+        }
+
+        Buffer *get()
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (buffers_.empty())
+                return new Buffer;
+
+            Buffer *buf = buffers_.front();
+            buffers_.pop_front();
+            return buf;
+        }
+
+        void put(std::list<Buffer *>& buffers)
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            buffers_.splice(buffers_.end(), buffers);
+        }
+
+    private:
+        std::list<Buffer *> buffers_;
+        std::mutex mutex_;
+    };
+
+    // all data required to write a single time step. since this object owns copies of
+    // the attached fields in the asynchronous case, the next time step can be prepared
+    // while the current one is still being written.
+    class WriteDataTasklet : public TaskletInterface
+    {
+    public:
+        WriteDataTasklet(VtkMultiWriter& multiWriter,
+                         double time,
+                         const std::string& fileName)
+            : multiWriter_(multiWriter)
+            , time_(time)
+            , fileName_(fileName)
+        {
+            if (!multiWriter_.xdmfWriter_)
+                vtkWriter_.reset(new VtkWriter(multiWriter_.gridView_, Dune::VTK::conforming));
+        }
+
+        void run() final
+        {
+            // the buffers must be handed back even if writing fails, else each
+            // subsequent time step needs to allocate new ones
+            try {
+                write_();
+            }
+            catch (...) {
+                release();
+                throw;
+            }
+
+            release();
+        }
+
+        // hand all buffers owned by the time step back to the multi-writer
+        void release()
+        {
+            vtkWriter_.reset();
+            xdmfFields_.clear();
+            multiWriter_.scalarBufferPool_.put(scalarBuffers_);
+            multiWriter_.vectorBufferPool_.put(vectorBuffers_);
+            multiWriter_.tensorBufferPool_.put(tensorBuffers_);
+        }
+
+        VtkWriter& vtkWriter()
+        { return *vtkWriter_; }
+
+        typename XdmfWriter::FieldList& xdmfFields()
+        { return xdmfFields_; }
+
+        std::list<ScalarBuffer *>& scalarBuffers()
+        { return scalarBuffers_; }
+
+        std::list<VectorBuffer *>& vectorBuffers()
+        { return vectorBuffers_; }
+
+        std::list<TensorBuffer *>& tensorBuffers()
+        { return tensorBuffers_; }
+
+    private:
+        void write_()
+        {
+            Ewoms::TraceScope traceScope("writeVtk", "output");
+
+            multiWriter_.multiFile_.precision(16);
+            if (multiWriter_.xdmfWriter_) {
+                // only the field data is written, the grid is shared between all time
+                // steps. the meta data of the time step goes directly into the
+                // multi-file.
+                multiWriter_.xdmfWriter_->write(xdmfFields_,
+                                                fileName_,
+                                                time_,
+                                                multiWriter_.multiFile_);
+            }
+            else {
+                std::string fileName;
+                // write the actual data as vtu or vtp (plus the pieces file in the parallel case)
+                if (multiWriter_.commSize_ > 1)
+                    fileName = vtkWriter_->pwrite(/*name=*/fileName_,
+                                                  /*path=*/multiWriter_.outputDir_,
+                                                  /*extendPath=*/"",
+                                                  static_cast<Dune::VTK::OutputType>(vtkFormat));
+                else
+                    fileName = vtkWriter_->write(/*name=*/multiWriter_.outputDir_ + "/" + fileName_,
+                                                 static_cast<Dune::VTK::OutputType>(vtkFormat));
+
+                // determine name to write into the multi-file for the
+                // current time step
+                multiWriter_.multiFile_ << "   <DataSet timestep=\"" << time_ << "\" file=\""
+                                        << fileName << "\"/>\n";
+            }
+
+            // temporarily write the closing XML mumbo-jumbo to the mashup
+            // file so that the data set can be loaded even if the
+            // simulation is aborted (or not yet finished)
+            multiWriter_.finishMultiFile_();
+        }
+
+        VtkMultiWriter& multiWriter_;
+        double time_;
+        std::string fileName_;
+
+        std::unique_ptr<VtkWriter> vtkWriter_;
+        typename XdmfWriter::FieldList xdmfFields_;
+
+        std::list<ScalarBuffer *> scalarBuffers_;
+        std::list<VectorBuffer *> vectorBuffers_;
+        std::list<TensorBuffer *> tensorBuffers_;
+    };
+
+public:
+
+    /*!
+     * \brief Create a multi-file writer.
+     *
+     * If 'cacheGeometry' is true, the grid is written only once to a raw binary mesh
+     * file and each time step just appends the raw field data plus a reference to the
+     * mesh to an XDMF meta file instead of producing a self-contained VTK file. In this
+     * case, the 'vtkFormat' template parameter is ignored.
+     */
     VtkMultiWriter(bool asyncWriting,
                    const GridView& gridView,
                    const std::string& outputDir,
                    const std::string& simName = "",
-                   std::string multiFileName = "")
+                   std::string multiFileName = "",
+                   bool cacheGeometry = false)
         : gridView_(gridView)
 #if DUNE_VERSION_NEWER(DUNE_GRID, 2,6)
         , elementMapper_(gridView, Dune::mcmgElementLayout())
@@ -132,7 +262,6 @@ public:
         , elementMapper_(gridView)
         , vertexMapper_(gridView)
 #endif
-        , curWriter_(nullptr)
         , curWriterNum_(0)
         , taskletRunner_(/*numThreads=*/asyncWriting?1:0)
     {
@@ -143,16 +272,23 @@ public:
         simName_ = (simName.empty()) ? "sim" : simName;
         multiFileName_ = multiFileName;
         if (multiFileName_.empty())
-            multiFileName_ = outputDir_+"/"+simName_+".pvd";
+            multiFileName_ = outputDir_+"/"+simName_+(cacheGeometry?".xmf":".pvd");
 
         commRank_ = gridView.comm().rank();
         commSize_ = gridView.comm().size();
+
+        if (cacheGeometry)
+            xdmfWriter_.reset(new XdmfWriter(gridView_, vertexMapper_, elementMapper_,
+                                             outputDir_, simName_));
     }
 
     ~VtkMultiWriter()
     {
         taskletRunner_.barrier();
-        releaseBuffers_();
+        if (curStep_)
+            curStep_->release();
+        scalarBufferPool_.put(managedScalarBuffers_);
+        vectorBufferPool_.put(managedVectorBuffers_);
         finishMultiFile_();
 
         if (commRank_ == 0)
@@ -174,8 +310,14 @@ public:
      */
     void gridChanged()
     {
+        // the time steps which are still being written refer to the old grid
+        taskletRunner_.barrier();
+
         elementMapper_.update();
         vertexMapper_.update();
+
+        if (xdmfWriter_)
+            xdmfWriter_->gridChanged();
     }
 
     /*!
@@ -187,27 +329,34 @@ public:
             startMultiFile_(multiFileName_);
         }
 
-        // make sure that all previous output has been written and no other thread
-        // accesses the memory used as the target for the extracted quantities
-        taskletRunner_.barrier();
-        releaseBuffers_();
+        // the attached fields are copied if the output is written asynchronously, so
+        // the previous time step may still be in the process of being written while
+        // the current one is prepared (double buffering). to bound the required
+        // memory, we wait until the time steps before that have been completed.
+        taskletRunner_.waitUntilPendingAtMost(1);
 
-        curTime_ = t;
-        curOutFileName_ = fileName_();
+        if (curStep_)
+            // the last time step was neither written nor discarded
+            curStep_->release();
 
-        curWriter_ = new VtkWriter(gridView_, Dune::VTK::conforming);
+        if (xdmfWriter_)
+            xdmfWriter_->beginStep();
+        curStep_ = std::make_shared<WriteDataTasklet>(*this, t, fileName_());
         ++curWriterNum_;
     }
 
     /*!
      * \brief Allocate a managed buffer for a scalar field
      *
-     * The buffer will be deleted automatically after the data has
+     * The buffer will be recycled automatically after the data has
      * been written by to disk.
      */
     ScalarBuffer *allocateManagedScalarBuffer(size_t numEntities)
     {
-        ScalarBuffer *buf = new ScalarBuffer(numEntities);
+        // reuse the memory of a buffer from a previous time step if possible
+        ScalarBuffer *buf = scalarBufferPool_.get();
+        buf->assign(numEntities, 0.0);
+
         managedScalarBuffers_.push_back(buf);
         return buf;
     }
@@ -215,14 +364,17 @@ public:
     /*!
      * \brief Allocate a managed buffer for a vector field
      *
-     * The buffer will be deleted automatically after the data has
+     * The buffer will be recycled automatically after the data has
      * been written by to disk.
      */
     VectorBuffer *allocateManagedVectorBuffer(size_t numOuter, size_t numInner)
     {
-        VectorBuffer *buf = new VectorBuffer(numOuter);
-        for (size_t i = 0; i < numOuter; ++ i)
+        VectorBuffer *buf = vectorBufferPool_.get();
+        buf->resize(numOuter);
+        for (size_t i = 0; i < numOuter; ++ i) {
             (*buf)[i].resize(numInner);
+            (*buf)[i] = 0.0;
+        }
 
         managedVectorBuffers_.push_back(buf);
         return buf;
@@ -247,14 +399,20 @@ public:
     void attachScalarVertexData(ScalarBuffer& buf, std::string name)
     {
         sanitizeScalarBuffer_(buf);
+        const ScalarBuffer& data = snapshot_(buf, curStep_->scalarBuffers(), scalarBufferPool_);
+
+        if (xdmfWriter_) {
+            curStep_->xdmfFields().push_back(XdmfWriter::makeScalarField(data, name, /*isCellData=*/false));
+            return;
+        }
 
         typedef Ewoms::VtkScalarFunction<GridView, VertexMapper> VtkFn;
         FunctionPtr fnPtr(new VtkFn(name,
                                     gridView_,
                                     vertexMapper_,
-                                    buf,
+                                    data,
                                     /*codim=*/dim));
-        curWriter_->addVertexData(fnPtr);
+        curStep_->vtkWriter().addVertexData(fnPtr);
     }
 
     /*!
@@ -275,14 +433,20 @@ public:
     void attachScalarElementData(ScalarBuffer& buf, std::string name)
     {
         sanitizeScalarBuffer_(buf);
+        const ScalarBuffer& data = snapshot_(buf, curStep_->scalarBuffers(), scalarBufferPool_);
+
+        if (xdmfWriter_) {
+            curStep_->xdmfFields().push_back(XdmfWriter::makeScalarField(data, name, /*isCellData=*/true));
+            return;
+        }
 
         typedef Ewoms::VtkScalarFunction<GridView, ElementMapper> VtkFn;
         FunctionPtr fnPtr(new VtkFn(name,
                                     gridView_,
                                     elementMapper_,
-                                    buf,
+                                    data,
                                     /*codim=*/0));
-        curWriter_->addCellData(fnPtr);
+        curStep_->vtkWriter().addCellData(fnPtr);
     }
 
     /*!
@@ -304,14 +468,20 @@ public:
     void attachVectorVertexData(VectorBuffer& buf, std::string name)
     {
         sanitizeVectorBuffer_(buf);
+        const VectorBuffer& data = snapshot_(buf, curStep_->vectorBuffers(), vectorBufferPool_);
+
+        if (xdmfWriter_) {
+            curStep_->xdmfFields().push_back(XdmfWriter::makeVectorField(data, name, /*isCellData=*/false));
+            return;
+        }
 
         typedef Ewoms::VtkVectorFunction<GridView, VertexMapper> VtkFn;
         FunctionPtr fnPtr(new VtkFn(name,
                                     gridView_,
                                     vertexMapper_,
-                                    buf,
+                                    data,
                                     /*codim=*/dim));
-        curWriter_->addVertexData(fnPtr);
+        curStep_->vtkWriter().addVertexData(fnPtr);
     }
 
     /*!
@@ -321,17 +491,24 @@ public:
     {
         typedef Ewoms::VtkTensorFunction<GridView, VertexMapper> VtkFn;
 
-        for (unsigned colIdx = 0; colIdx < buf[0].N(); ++colIdx) {
+        const TensorBuffer& data = snapshot_(buf, curStep_->tensorBuffers(), tensorBufferPool_);
+        for (unsigned colIdx = 0; colIdx < data[0].N(); ++colIdx) {
             std::ostringstream oss;
             oss << name <<  "[" << colIdx << "]";
 
+            if (xdmfWriter_) {
+                curStep_->xdmfFields().push_back(
+                    XdmfWriter::makeTensorColumnField(data, colIdx, oss.str(), /*isCellData=*/false));
+                continue;
+            }
+
             FunctionPtr fnPtr(new VtkFn(oss.str(),
                                         gridView_,
                                         vertexMapper_,
-                                        buf,
+                                        data,
                                         /*codim=*/dim,
                                         colIdx));
-            curWriter_->addVertexData(fnPtr);
+            curStep_->vtkWriter().addVertexData(fnPtr);
         }
     }
 
@@ -353,14 +530,20 @@ public:
     void attachVectorElementData(VectorBuffer& buf, std::string name)
     {
         sanitizeVectorBuffer_(buf);
+        const VectorBuffer& data = snapshot_(buf, curStep_->vectorBuffers(), vectorBufferPool_);
+
+        if (xdmfWriter_) {
+            curStep_->xdmfFields().push_back(XdmfWriter::makeVectorField(data, name, /*isCellData=*/true));
+            return;
+        }
 
         typedef Ewoms::VtkVectorFunction<GridView, ElementMapper> VtkFn;
         FunctionPtr fnPtr(new VtkFn(name,
                                     gridView_,
                                     elementMapper_,
-                                    buf,
+                                    data,
                                     /*codim=*/0));
-        curWriter_->addCellData(fnPtr);
+        curStep_->vtkWriter().addCellData(fnPtr);
     }
 
     /*!
@@ -370,17 +553,24 @@ public:
     {
         typedef Ewoms::VtkTensorFunction<GridView, ElementMapper> VtkFn;
 
-        for (unsigned colIdx = 0; colIdx < buf[0].N(); ++colIdx) {
+        const TensorBuffer& data = snapshot_(buf, curStep_->tensorBuffers(), tensorBufferPool_);
+        for (unsigned colIdx = 0; colIdx < data[0].N(); ++colIdx) {
             std::ostringstream oss;
             oss << name <<  "[" << colIdx << "]";
 
+            if (xdmfWriter_) {
+                curStep_->xdmfFields().push_back(
+                    XdmfWriter::makeTensorColumnField(data, colIdx, oss.str(), /*isCellData=*/true));
+                continue;
+            }
+
             FunctionPtr fnPtr(new VtkFn(oss.str(),
                                         gridView_,
                                         elementMapper_,
-                                        buf,
+                                        data,
                                         /*codim=*/0,
                                         colIdx));
-            curWriter_->addCellData(fnPtr);
+            curStep_->vtkWriter().addCellData(fnPtr);
         }
     }
 
@@ -393,17 +583,18 @@ public:
      */
     void endWrite(bool onlyDiscard = false)
     {
-        if (!onlyDiscard) {
-            auto tasklet = std::make_shared<WriteDataTasklet>(*this);
-            taskletRunner_.dispatch(tasklet);
-        }
-        else
+        // the managed buffers are now owned by the time step
+        curStep_->scalarBuffers().splice(curStep_->scalarBuffers().end(), managedScalarBuffers_);
+        curStep_->vectorBuffers().splice(curStep_->vectorBuffers().end(), managedVectorBuffers_);
+
+        if (!onlyDiscard)
+            taskletRunner_.dispatch(curStep_);
+        else {
+            curStep_->release();
             --curWriterNum_;
+        }
 
-        // temporarily write the closing XML mumbo-jumbo to the mashup
-        // file so that the data set can be loaded even if the
-        // simulation is aborted (or not yet finished)
-        finishMultiFile_();
+        curStep_.reset();
     }
 
     /*!
@@ -412,6 +603,9 @@ public:
     template <class Restarter>
     void serialize(Restarter& res)
     {
+        // the meta file must not be modified while it is copied
+        taskletRunner_.barrier();
+
         res.serializeSectionBegin("VTKMultiWriter");
         res.serializeStream() << curWriterNum_ << "\n";
 
@@ -498,6 +692,15 @@ private:
         if (commRank_ == 0) {
             // generate one meta vtk-file holding the individual time steps
             multiFile_.open(multiFileName.c_str());
+            if (xdmfWriter_) {
+                multiFile_ << "<?xml version=\"1.0\"?>\n"
+                              "<Xdmf Version=\"2.0\">\n"
+                              " <Domain>\n"
+                              "  <Grid Name=\"" << simName_ << "\" GridType=\"Collection\" "
+                              "CollectionType=\"Temporal\">\n";
+                return;
+            }
+
             multiFile_ << "<?xml version=\"1.0\"?>\n"
                           "<VTKFile type=\"Collection\"\n"
                           "         version=\"0.1\"\n"
@@ -513,8 +716,13 @@ private:
         if (commRank_ == 0) {
             // make sure that we always have a working meta file
             std::ofstream::pos_type pos = multiFile_.tellp();
-            multiFile_ << " </Collection>\n"
-                          "</VTKFile>\n";
+            if (xdmfWriter_)
+                multiFile_ << "  </Grid>\n"
+                              " </Domain>\n"
+                              "</Xdmf>\n";
+            else
+                multiFile_ << " </Collection>\n"
+                              "</VTKFile>\n";
             multiFile_.seekp(pos);
             multiFile_.flush();
         }
@@ -532,22 +740,39 @@ private:
         // nothing to do: this is done by VtkVectorFunction
     }
 
-    // release the memory occupied by all buffer objects managed by the multi-writer
-    void releaseBuffers_()
+    // returns the buffer whose data ought to be written for the current time step. if
+    // the output is written asynchronously, this is a copy of the buffer which is
+    // owned by the time step, so the caller is free to modify the original buffer
+    // after endWrite() has been called.
+    template <class Buffer>
+    Buffer& snapshot_(Buffer& buf,
+                      std::list<Buffer *>& stepBuffers,
+                      BufferPool_<Buffer>& pool)
     {
-        // discard managed objects and the current VTK writer
-        delete curWriter_;
-        curWriter_ = nullptr;
-        while (managedScalarBuffers_.begin() != managedScalarBuffers_.end()) {
-            delete managedScalarBuffers_.front();
-            managedScalarBuffers_.pop_front();
-        }
-        while (managedVectorBuffers_.begin() != managedVectorBuffers_.end()) {
-            delete managedVectorBuffers_.front();
-            managedVectorBuffers_.pop_front();
-        }
+        if (taskletRunner_.numWorkerThreads() == 0 || isManaged_(buf))
+            return buf;
+
+        Buffer *copy = pool.get();
+        *copy = buf;
+        stepBuffers.push_back(copy);
+        return *copy;
+    }
+
+    bool isManaged_(const ScalarBuffer& buf) const
+    {
+        return std::find(managedScalarBuffers_.begin(), managedScalarBuffers_.end(), &buf)
+            != managedScalarBuffers_.end();
     }
 
+    bool isManaged_(const VectorBuffer& buf) const
+    {
+        return std::find(managedVectorBuffers_.begin(), managedVectorBuffers_.end(), &buf)
+            != managedVectorBuffers_.end();
+    }
+
+    bool isManaged_(const TensorBuffer& buf OPM_UNUSED) const
+    { return false; }
+
     const GridView gridView_;
     ElementMapper elementMapper_;
     VertexMapper vertexMapper_;
@@ -560,14 +785,21 @@ private:
     int commSize_; // number of processes in the communicator
     int commRank_; // rank of the current process in the communicator
 
-    VtkWriter *curWriter_;
-    double curTime_;
-    std::string curOutFileName_;
     int curWriterNum_;
 
+    // the time step which is currently being prepared
+    std::shared_ptr<WriteDataTasklet> curStep_;
+
     std::list<ScalarBuffer *> managedScalarBuffers_;
     std::list<VectorBuffer *> managedVectorBuffers_;
 
+    // buffers which are not used by any time step
+    BufferPool_<ScalarBuffer> scalarBufferPool_;
+    BufferPool_<VectorBuffer> vectorBufferPool_;
+    BufferPool_<TensorBuffer> tensorBufferPool_;
+
+    std::unique_ptr<XdmfWriter> xdmfWriter_;
+
     TaskletRunner taskletRunner_;
 };
 } // namespace Ewoms
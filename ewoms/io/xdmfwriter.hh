@@ -0,0 +1,461 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \copydoc Ewoms::XdmfWriter
+ */
+#ifndef EWOMS_XDMF_WRITER_HH
+#define EWOMS_XDMF_WRITER_HH
+
+#include <ewoms/io/baseoutputwriter.hh>
+
+#include <dune/common/version.hh>
+#include <dune/geometry/type.hh>
+#include <dune/grid/common/gridenums.hh>
+#include <dune/grid/io/file/vtk/common.hh>
+
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace Ewoms {
+/*!
+ * \brief Writes the grid geometry once and only the field data for each time step.
+ *
+ * The points and the cell connectivity of the local partition of the grid are written
+ * to a raw binary mesh file whenever the grid has changed. Each subsequent call to
+ * write() only dumps the given fields as consecutive raw arrays of single precision
+ * floating point values to a second binary file and produces the XDMF description of
+ * the time step which references both files. This avoids regenerating and re-encoding
+ * the grid for every time step.
+ *
+ * Each process writes its own binary files; the XDMF meta data is only generated by
+ * the first process.
+ */
+template <class GridView, class VertexMapper, class ElementMapper>
+class XdmfWriter
+{
+    enum { dim = GridView::dimension };
+    enum { dimWorld = GridView::dimensionworld };
+
+    typedef BaseOutputWriter::ScalarBuffer ScalarBuffer;
+    typedef BaseOutputWriter::VectorBuffer VectorBuffer;
+    typedef BaseOutputWriter::TensorBuffer TensorBuffer;
+
+    // the kind of buffer from which a field is extracted
+    enum FieldType_ { ScalarField_, VectorField_, TensorColumnField_ };
+
+public:
+    /*!
+     * \brief Describes a field which was attached to a time step.
+     */
+    struct Field
+    {
+        std::string name;
+        FieldType_ type;
+        bool isCellData;
+        unsigned numComponents;
+        const ScalarBuffer *scalarBuf;
+        const VectorBuffer *vectorBuf;
+        const TensorBuffer *tensorBuf;
+        unsigned tensorColumnIdx;
+    };
+
+    typedef std::vector<Field> FieldList;
+
+    XdmfWriter(const GridView& gridView,
+               const VertexMapper& vertexMapper,
+               const ElementMapper& elementMapper,
+               const std::string& outputDir,
+               const std::string& simName)
+        : gridView_(gridView)
+        , vertexMapper_(vertexMapper)
+        , elementMapper_(elementMapper)
+        , outputDir_(outputDir)
+        , simName_(simName)
+        , geometryValid_(false)
+        , geometryNum_(0)
+    {
+        commRank_ = gridView.comm().rank();
+        commSize_ = gridView.comm().size();
+    }
+
+    /*!
+     * \brief Causes the mesh file to be re-written for the next time step.
+     *
+     * The mappers passed to the constructor must be updated before the next call to
+     * beginStep().
+     */
+    void gridChanged()
+    { geometryValid_ = false; }
+
+    /*!
+     * \brief Prepare writing a new time step.
+     *
+     * If the grid has changed since the mesh file was written, it is written again.
+     */
+    void beginStep()
+    {
+        if (!geometryValid_)
+            writeGeometry_();
+    }
+
+    /*!
+     * \brief Describe a scalar field.
+     *
+     * The buffer must stay valid and unmodified until write() has finished.
+     */
+    static Field makeScalarField(const ScalarBuffer& buf, const std::string& name, bool isCellData)
+    {
+        Field field = makeField_(name, ScalarField_, isCellData, /*numComponents=*/1);
+        field.scalarBuf = &buf;
+        return field;
+    }
+
+    /*!
+     * \brief Describe a vector field.
+     *
+     * The buffer must stay valid and unmodified until write() has finished.
+     */
+    static Field makeVectorField(const VectorBuffer& buf, const std::string& name, bool isCellData)
+    {
+        unsigned numComponents = buf.empty() ? 1 : static_cast<unsigned>(buf[0].size());
+        Field field = makeField_(name, VectorField_, isCellData, numComponents);
+        field.vectorBuf = &buf;
+        return field;
+    }
+
+    /*!
+     * \brief Describe one column of a tensor field.
+     *
+     * The buffer must stay valid and unmodified until write() has finished.
+     */
+    static Field makeTensorColumnField(const TensorBuffer& buf,
+                                       unsigned colIdx,
+                                       const std::string& name,
+                                       bool isCellData)
+    {
+        unsigned numComponents = buf.empty() ? 1 : static_cast<unsigned>(buf[0].N());
+        Field field = makeField_(name, TensorColumnField_, isCellData, numComponents);
+        field.tensorBuf = &buf;
+        field.tensorColumnIdx = colIdx;
+        return field;
+    }
+
+    /*!
+     * \brief Write a list of fields to disk.
+     *
+     * On the first process, the XDMF description of the time step is written to the
+     * 'xdmfGrid' stream. It is a "Grid" element which is suitable to be part of a
+     * temporal collection.
+     *
+     * \param fields The fields which ought to be written
+     * \param stepName The base name of the files for the current time step
+     * \param time The time which corresponds to the time step
+     * \param xdmfGrid The stream to which the XDMF meta data is written
+     */
+    void write(const FieldList& fields,
+               const std::string& stepName,
+               double time,
+               std::ostream& xdmfGrid)
+    {
+        std::ofstream dataFile(outputDir_ + "/" + binaryFileName_(stepName, commRank_),
+                               std::ios::out | std::ios::binary);
+        for (const auto& field : fields) {
+            stageField_(field);
+            dataFile.write(reinterpret_cast<const char*>(stagingBuffer_.data()),
+                           static_cast<std::streamsize>(stagingBuffer_.size()*sizeof(float)));
+        }
+        dataFile.close();
+        if (!dataFile)
+            throw std::runtime_error("Could not write the XDMF data file for "+stepName);
+
+        if (commRank_ == 0)
+            writeXdmfGrid_(fields, stepName, time, xdmfGrid);
+    }
+
+private:
+    static Field makeField_(const std::string& name,
+                             FieldType_ type,
+                             bool isCellData,
+                             unsigned numComponents)
+    {
+        Field field;
+        field.name = name;
+        field.type = type;
+        field.isCellData = isCellData;
+        field.numComponents = numComponents;
+        field.scalarBuf = nullptr;
+        field.vectorBuf = nullptr;
+        field.tensorBuf = nullptr;
+        field.tensorColumnIdx = 0;
+        return field;
+    }
+
+    std::string binaryFileName_(const std::string& baseName, int rank) const
+    {
+        std::ostringstream oss;
+        oss << baseName;
+        if (commSize_ > 1)
+            oss << "-p" << std::setw(4) << std::setfill('0') << rank;
+        oss << ".bin";
+        return oss.str();
+    }
+
+    std::string meshBaseName_() const
+    {
+        std::ostringstream oss;
+        oss << simName_ << "-mesh-" << std::setw(5) << std::setfill('0') << geometryNum_;
+        return oss.str();
+    }
+
+    // the XDMF cell type and the number of corners which must be explicitly specified
+    // in the connectivity array (or 0 if the cell type implies it)
+    static int xdmfCellType_(const Dune::GeometryType& type, int& explicitNumCorners)
+    {
+        explicitNumCorners = 0;
+        if (type.isVertex()) {
+            explicitNumCorners = 1;
+            return 1; // polyvertex
+        }
+        else if (type.isLine()) {
+            explicitNumCorners = 2;
+            return 2; // polyline
+        }
+        else if (type.isTriangle())
+            return 4;
+        else if (type.isQuadrilateral())
+            return 5;
+        else if (type.isTetrahedron())
+            return 6;
+        else if (type.isPyramid())
+            return 7;
+        else if (type.isPrism())
+            return 8;
+        else if (type.isHexahedron())
+            return 9;
+
+        throw std::logic_error("Unsupported geometry type for XDMF output");
+    }
+
+    void writeGeometry_()
+    {
+        ++geometryNum_;
+
+        // the points. these are ordered by the vertex mapper so that vertex data can be
+        // written without any reordering.
+        unsigned numPoints = static_cast<unsigned>(vertexMapper_.size());
+        std::vector<double> points(3*numPoints, 0.0);
+        const auto& vEndIt = gridView_.template end<dim>();
+        for (auto vIt = gridView_.template begin<dim>(); vIt != vEndIt; ++vIt) {
+            unsigned vIdx = static_cast<unsigned>(vertexMapper_.index(*vIt));
+            const auto& pos = vIt->geometry().corner(0);
+            for (unsigned i = 0; i < dimWorld; ++i)
+                points[3*vIdx + i] = pos[i];
+        }
+
+        // the connectivity of the interior cells using XDMF's "mixed" topology
+        std::vector<int32_t> topology;
+        cellIndices_.clear();
+        const auto& elemEndIt = gridView_.template end</*codim=*/0, Dune::Interior_Partition>();
+        for (auto elemIt = gridView_.template begin</*codim=*/0, Dune::Interior_Partition>();
+             elemIt != elemEndIt;
+             ++elemIt)
+        {
+            const auto& elem = *elemIt;
+            cellIndices_.push_back(static_cast<unsigned>(elementMapper_.index(elem)));
+
+            int explicitNumCorners;
+            topology.push_back(xdmfCellType_(elem.type(), explicitNumCorners));
+            if (explicitNumCorners > 0)
+                topology.push_back(explicitNumCorners);
+
+            int numCorners = static_cast<int>(elem.subEntities(dim));
+            for (int i = 0; i < numCorners; ++i) {
+                int duneIdx = Dune::VTK::renumber(elem.type(), i);
+                topology.push_back(static_cast<int32_t>(vertexMapper_.subIndex(elem, duneIdx, dim)));
+            }
+        }
+
+        std::ofstream meshFile(outputDir_ + "/" + binaryFileName_(meshBaseName_(), commRank_),
+                               std::ios::out | std::ios::binary);
+        meshFile.write(reinterpret_cast<const char*>(points.data()),
+                       static_cast<std::streamsize>(points.size()*sizeof(double)));
+        meshFile.write(reinterpret_cast<const char*>(topology.data()),
+                       static_cast<std::streamsize>(topology.size()*sizeof(int32_t)));
+        meshFile.close();
+        if (!meshFile)
+            throw std::runtime_error("Could not write the XDMF mesh file");
+
+        // the first process needs to know the sizes of all partitions to be able to
+        // generate the meta data
+        int localSizes[3] = {
+            static_cast<int>(numPoints),
+            static_cast<int>(cellIndices_.size()),
+            static_cast<int>(topology.size())
+        };
+        std::vector<int> allSizes(3*static_cast<size_t>(commSize_));
+        gridView_.comm().gather(localSizes, allSizes.data(), 3, /*root=*/0);
+
+        numPoints_.resize(static_cast<size_t>(commSize_));
+        numCells_.resize(static_cast<size_t>(commSize_));
+        topologySize_.resize(static_cast<size_t>(commSize_));
+        for (unsigned rank = 0; rank < static_cast<unsigned>(commSize_); ++rank) {
+            numPoints_[rank] = static_cast<size_t>(allSizes[3*rank + 0]);
+            numCells_[rank] = static_cast<size_t>(allSizes[3*rank + 1]);
+            topologySize_[rank] = static_cast<size_t>(allSizes[3*rank + 2]);
+        }
+
+        geometryValid_ = true;
+    }
+
+    // copy the values of a field into the staging buffer. cell data is restricted to
+    // the interior cells in the order in which they appear in the mesh file.
+    void stageField_(const Field& field)
+    {
+        size_t numEntities =
+            field.isCellData
+            ? cellIndices_.size()
+            : static_cast<size_t>(vertexMapper_.size());
+
+        // resizing only allocates memory if the buffer has never been this large
+        stagingBuffer_.resize(numEntities*field.numComponents);
+
+        for (size_t i = 0; i < numEntities; ++i) {
+            size_t srcIdx = field.isCellData ? cellIndices_[i] : i;
+            for (unsigned compIdx = 0; compIdx < field.numComponents; ++compIdx) {
+                double value;
+                if (field.type == ScalarField_)
+                    value = (*field.scalarBuf)[srcIdx];
+                else if (field.type == VectorField_)
+                    value = (*field.vectorBuf)[srcIdx][compIdx];
+                else
+                    value = (*field.tensorBuf)[srcIdx][compIdx][field.tensorColumnIdx];
+
+                stagingBuffer_[i*field.numComponents + compIdx] = static_cast<float>(value);
+            }
+        }
+    }
+
+    void writeXdmfGrid_(const FieldList& fields,
+                        const std::string& stepName,
+                        double time,
+                        std::ostream& os) const
+    {
+        std::string indent = "   ";
+        if (commSize_ > 1) {
+            os << indent << "<Grid Name=\"" << stepName << "\" GridType=\"Collection\" "
+               << "CollectionType=\"Spatial\">\n";
+            os << indent << " <Time Value=\"" << std::setprecision(16) << time << "\"/>\n";
+            for (int rank = 0; rank < commSize_; ++rank)
+                writeXdmfPartition_(fields, stepName, rank, /*time=*/nullptr, indent + " ", os);
+            os << indent << "</Grid>\n";
+        }
+        else
+            writeXdmfPartition_(fields, stepName, /*rank=*/0, &time, indent, os);
+    }
+
+    void writeXdmfPartition_(const FieldList& fields,
+                             const std::string& stepName,
+                             int rank,
+                             const double *time,
+                             const std::string& indent,
+                             std::ostream& os) const
+    {
+        size_t r = static_cast<size_t>(rank);
+        std::string meshFileName = binaryFileName_(meshBaseName_(), rank);
+        std::string dataFileName = binaryFileName_(stepName, rank);
+
+        os << indent << "<Grid Name=\"" << stepName << "-" << rank << "\" GridType=\"Uniform\">\n";
+        if (time)
+            os << indent << " <Time Value=\"" << std::setprecision(16) << *time << "\"/>\n";
+
+        os << indent << " <Topology TopologyType=\"Mixed\" NumberOfElements=\""
+           << numCells_[r] << "\">\n"
+           << indent << "  <DataItem Dimensions=\"" << topologySize_[r] << "\" "
+           << "NumberType=\"Int\" Precision=\"4\" Format=\"Binary\" Endian=\"Native\" "
+           << "Seek=\"" << 3*numPoints_[r]*sizeof(double) << "\">"
+           << meshFileName << "</DataItem>\n"
+           << indent << " </Topology>\n";
+
+        os << indent << " <Geometry GeometryType=\"XYZ\">\n"
+           << indent << "  <DataItem Dimensions=\"" << numPoints_[r] << " 3\" "
+           << "NumberType=\"Float\" Precision=\"8\" Format=\"Binary\" Endian=\"Native\" "
+           << "Seek=\"0\">"
+           << meshFileName << "</DataItem>\n"
+           << indent << " </Geometry>\n";
+
+        // the fields are stored consecutively in the data file
+        size_t offset = 0;
+        for (const auto& field : fields) {
+            size_t numEntities = field.isCellData ? numCells_[r] : numPoints_[r];
+
+            os << indent << " <Attribute Name=\"" << field.name << "\" "
+               << "AttributeType=\"" << ((field.numComponents == 1) ? "Scalar" : "Vector") << "\" "
+               << "Center=\"" << (field.isCellData ? "Cell" : "Node") << "\">\n"
+               << indent << "  <DataItem Dimensions=\"" << numEntities;
+            if (field.numComponents > 1)
+                os << " " << field.numComponents;
+            os << "\" NumberType=\"Float\" Precision=\"4\" Format=\"Binary\" Endian=\"Native\" "
+               << "Seek=\"" << offset << "\">"
+               << dataFileName << "</DataItem>\n"
+               << indent << " </Attribute>\n";
+
+            offset += numEntities*field.numComponents*sizeof(float);
+        }
+
+        os << indent << "</Grid>\n";
+    }
+
+    const GridView gridView_;
+    const VertexMapper& vertexMapper_;
+    const ElementMapper& elementMapper_;
+
+    std::string outputDir_;
+    std::string simName_;
+
+    int commRank_;
+    int commSize_;
+
+    bool geometryValid_;
+    unsigned geometryNum_;
+
+    // the element indices of the cells in the mesh file of the local process
+    std::vector<unsigned> cellIndices_;
+
+    // the sizes of the mesh of each process
+    std::vector<size_t> numPoints_;
+    std::vector<size_t> numCells_;
+    std::vector<size_t> topologySize_;
+
+    std::vector<float> stagingBuffer_;
+};
+} // namespace Ewoms
+
+#endif
@@ -33,6 +33,7 @@
 
 #include <ewoms/common/timer.hh>
 #include <ewoms/common/timerguard.hh>
+#include <ewoms/common/tracer.hh>
 
 #include <opm/material/common/Exceptions.hpp>
 
@@ -193,6 +194,8 @@ public:
         unsigned n = x.size();
 
         for (; report_.iterations() < maxIterations_; report_.increment()) {
+            Ewoms::TraceScope iterationTraceScope("bicgstabIteration", "linear");
+
             // rho_i = (r0hat,r_(i-1))
             Scalar rho_i = scalarProduct_.dot(r0hat, r);
 
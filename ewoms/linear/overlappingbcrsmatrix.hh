@@ -31,6 +31,7 @@
 #include <ewoms/linear/globalindices.hh>
 #include <ewoms/linear/blacklist.hh>
 #include <ewoms/parallel/mpibuffer.hh>
+#include <ewoms/common/tracer.hh>
 
 #include <opm/material/common/Valgrind.hpp>
 
@@ -264,6 +265,8 @@ public:
     // communicates and adds up the contents of overlapping rows
     void syncAdd()
     {
+        Ewoms::TraceScope traceScope("overlapMatrixSyncAdd", "communication");
+
         // first, send all entries to the peers
         const PeerSet& peerSet = overlap_->peerSet();
         typename PeerSet::const_iterator peerIt = peerSet.begin();
@@ -30,6 +30,7 @@
 #include "overlaptypes.hh"
 
 #include <ewoms/parallel/mpibuffer.hh>
+#include <ewoms/common/tracer.hh>
 #include <opm/material/common/Valgrind.hpp>
 
 #include <dune/istl/bvector.hh>
@@ -174,6 +175,8 @@ public:
      */
     void sync()
     {
+        Ewoms::TraceScope traceScope("overlapSync", "communication");
+
         // send all entries to all peers
         for (const auto peerRank: overlap_->peerSet())
             sendEntries_(peerRank);
@@ -192,6 +195,8 @@ public:
      */
     void syncAdd()
     {
+        Ewoms::TraceScope traceScope("overlapSyncAdd", "communication");
+
         // send all entries to all peers
         for (const auto peerRank: overlap_->peerSet())
             sendEntries_(peerRank);
@@ -161,6 +161,11 @@ protected:
 
     std::shared_ptr<AMG> preparePreconditioner_()
     {
+        // the AMG hierarchy of the current matrix can be reused for additional right
+        // hand sides
+        if (amg_)
+            return amg_;
+
 #if HAVE_MPI
         // create and initialize DUNE's OwnerOverlapCopyCommunication
         // using the domestic overlap
@@ -182,7 +187,7 @@ protected:
     }
 
     void cleanupPreconditioner_()
-    { /* nothing to do */ }
+    { amg_.reset(); }
 
     std::shared_ptr<RawLinearSolver> prepareSolver_(ParallelOperator& parOperator,
                                                     ParallelScalarProduct& parScalarProduct,
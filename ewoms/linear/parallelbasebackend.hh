@@ -36,6 +36,7 @@
 #include <ewoms/linear/istlpreconditionerwrappers.hh>
 
 #include <ewoms/common/genericguard.hh>
+#include <ewoms/common/tracer.hh>
 #include <ewoms/common/propertysystem.hh>
 #include <ewoms/common/parametersystem.hh>
 #include <ewoms/linear/matrixblock.hh>
@@ -45,6 +46,7 @@
 #include <dune/common/fvector.hh>
 #include <dune/common/version.hh>
 
+#include <cassert>
 #include <sstream>
 #include <memory>
 #include <iostream>
@@ -178,6 +180,7 @@ public:
         : simulator_(simulator)
         , gridSequenceNumber_( -1 )
         , lastIterations_( -1 )
+        , preconditionerIsPrepared_(false)
     {
         overlappingMatrix_ = nullptr;
         overlappingb_ = nullptr;
@@ -219,6 +222,9 @@ public:
         // have been created
         prepare_(M);
 
+        // the preconditioner of the previous matrix is obsolete
+        asImp_().cleanupPreconditioner_();
+
         // copy the interior values of the non-overlapping linear system of
         // equations to the overlapping one.
         overlappingMatrix_->assignFromNative(M.istlMatrix());
@@ -236,9 +242,27 @@ public:
         overlappingb_->assignTo(b);
     }
 
+    /*!
+     * \brief Replace the right hand side of the linear system of equations, but keep
+     *        its matrix.
+     *
+     * This requires prepare() to have been called before. The next call to solve()
+     * reuses the preconditioner of the previous one.
+     */
+    void setResidual(Vector& b)
+    {
+        assert(overlappingb_);
+
+        overlappingb_->assignAddBorder(b);
+        overlappingb_->assignTo(b);
+    }
+
     /*!
      * \brief Actually solve the linear system of equations.
      *
+     * The preconditioner is kept until the matrix is changed by prepare(), i.e.,
+     * subsequent calls of solve() for different right hand sides reuse it.
+     *
      * \return true if the residual reduction could be achieved, else false.
      */
     bool solve(Vector& x)
@@ -251,9 +275,7 @@ public:
         (*overlappingx_) = 0.0;
 
         auto parPreCond = asImp_().preparePreconditioner_();
-        auto precondCleanupFn = [this]() -> void
-                                { this->asImp_().cleanupPreconditioner_(); };
-        auto precondCleanupGuard = Ewoms::make_guard(precondCleanupFn);
+
         // create the parallel scalar product and the parallel operator
         ParallelScalarProduct parScalarProduct(overlappingMatrix_->overlap());
         ParallelOperator parOperator(*overlappingMatrix_);
@@ -326,6 +348,12 @@ protected:
 
     void cleanup_()
     {
+        // the preconditioner references the overlapping matrix
+        if (preconditionerIsPrepared_) {
+            precWrapper_.cleanup();
+            preconditionerIsPrepared_ = false;
+        }
+
         // create the overlapping Jacobian matrix and vectors
         delete overlappingMatrix_;
         delete overlappingb_;
@@ -340,8 +368,12 @@ protected:
     {
         int preconditionerIsReady = 1;
         try {
-            // update sequential preconditioner
-            precWrapper_.prepare(*overlappingMatrix_);
+            // update sequential preconditioner unless it can be reused
+            if (!preconditionerIsPrepared_) {
+                Ewoms::TraceScope traceScope("preconditionerSetup", "linear");
+                precWrapper_.prepare(*overlappingMatrix_);
+                preconditionerIsPrepared_ = true;
+            }
         }
         catch (const Dune::Exception& e) {
             std::cout << "Preconditioner threw exception \"" << e.what()
@@ -362,7 +394,10 @@ protected:
 
     void cleanupPreconditioner_()
     {
-        precWrapper_.cleanup();
+        if (preconditionerIsPrepared_) {
+            precWrapper_.cleanup();
+            preconditionerIsPrepared_ = false;
+        }
     }
 
     void writeOverlapToVTK_()
@@ -405,6 +440,7 @@ protected:
     const Simulator& simulator_;
     int gridSequenceNumber_;
     size_t lastIterations_;
+    bool preconditionerIsPrepared_;
 
     OverlappingMatrix *overlappingMatrix_;
     OverlappingVector *overlappingb_;
@@ -437,7 +473,11 @@ private:
     static constexpr int numEq = GET_PROP_VALUE(TypeTag, NumEq);
     typedef typename GET_PROP_TYPE(TypeTag, LinearSolverScalar) LinearSolverScalar;
     typedef Ewoms::MatrixBlock<LinearSolverScalar, numEq, numEq> MatrixBlock;
-    typedef Dune::BCRSMatrix<MatrixBlock> NonOverlappingMatrix;
+    // use the same allocator as the matrix of the linearizer, so that the wrappers of the
+    // ISTL preconditioners can be used for both
+    typedef typename GET_PROP_TYPE(TypeTag, SparseMatrixAdapter)::IstlMatrix::allocator_type LinearizerAllocator;
+    typedef typename std::allocator_traits<LinearizerAllocator>::template rebind_alloc<MatrixBlock> Allocator;
+    typedef Dune::BCRSMatrix<MatrixBlock, Allocator> NonOverlappingMatrix;
 
 public:
     typedef Ewoms::Linear::OverlappingBCRSMatrix<NonOverlappingMatrix> type;
@@ -97,6 +97,16 @@ public:
         b_ = &b;
     }
 
+    /*!
+     * \brief Replace the right hand side of the linear system of equations, but keep
+     *        its matrix.
+     *
+     * Since SuperLU factorizes the matrix in each call to solve(), this does not save
+     * any work.
+     */
+    void setResidual(Vector& b)
+    { b_ = &b; }
+
     bool solve(Vector& x)
     { return SuperLUSolve_<Scalar, TypeTag, Matrix, Vector>::solve_(*M_, x, *b_); }
 
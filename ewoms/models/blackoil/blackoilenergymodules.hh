@@ -181,42 +181,41 @@ public:
         if (!enableEnergy)
             return;
 
-        flux[contiEnergyEqIdx] = 0.0;
-
+        // the advective and the conductive parts of the energy flux are accumulated in
+        // a single pass, i.e., the extensive quantities are only looked up once and the
+        // upstream quantities once per phase
         const auto& extQuants = elemCtx.extensiveQuantities(scvfIdx, timeIdx);
         unsigned focusIdx = elemCtx.focusDofIndex();
+
+        // conductive energy flux
+        Evaluation energyFlux = extQuants.energyFlux();
+
+        // advective energy flux
         for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
             if (!FluidSystem::phaseIsActive(phaseIdx))
                 continue;
 
             unsigned upIdx = extQuants.upstreamIndex(phaseIdx);
+            const auto& upFs = elemCtx.intensiveQuantities(upIdx, timeIdx).fluidState();
             if (upIdx == focusIdx)
-                addPhaseEnthalpyFlux_<Evaluation>(flux, phaseIdx, elemCtx, scvfIdx, timeIdx);
+                addPhaseEnthalpyFlux_<Evaluation>(energyFlux, upFs, extQuants.volumeFlux(phaseIdx), phaseIdx);
             else
-                addPhaseEnthalpyFlux_<Scalar>(flux, phaseIdx, elemCtx, scvfIdx, timeIdx);
+                addPhaseEnthalpyFlux_<Scalar>(energyFlux, upFs, extQuants.volumeFlux(phaseIdx), phaseIdx);
         }
 
-        // diffusive energy flux
-        flux[contiEnergyEqIdx] += extQuants.energyFlux();
+        flux[contiEnergyEqIdx] = energyFlux;
         flux[contiEnergyEqIdx] *= GET_PROP_VALUE(TypeTag, BlackOilEnergyScalingFactor);
     }
 
-    template <class UpstreamEval>
-    static void addPhaseEnthalpyFlux_(RateVector& flux,
-                                      unsigned phaseIdx,
-                                      const ElementContext& elemCtx,
-                                      unsigned scvfIdx,
-                                      unsigned timeIdx)
+    template <class UpstreamEval, class FluidState>
+    static void addPhaseEnthalpyFlux_(Evaluation& energyFlux,
+                                      const FluidState& upFs,
+                                      const Evaluation& volFlux,
+                                      unsigned phaseIdx)
     {
-        const auto& extQuants = elemCtx.extensiveQuantities(scvfIdx, timeIdx);
-        unsigned upIdx = extQuants.upstreamIndex(phaseIdx);
-        const auto& up = elemCtx.intensiveQuantities(upIdx, timeIdx);
-        const auto& fs = up.fluidState();
-
-        const auto& volFlux = extQuants.volumeFlux(phaseIdx);
-        flux[contiEnergyEqIdx] +=
-            Opm::decay<UpstreamEval>(fs.enthalpy(phaseIdx))
-            * Opm::decay<UpstreamEval>(fs.density(phaseIdx))
+        energyFlux +=
+            Opm::decay<UpstreamEval>(upFs.enthalpy(phaseIdx))
+            * Opm::decay<UpstreamEval>(upFs.density(phaseIdx))
             * volFlux;
     }
 
@@ -521,24 +520,23 @@ public:
         else
             exLambda = Opm::decay<Scalar>(exIq.totalThermalConductivity());
 
-        auto distVec = elemCtx.pos(exIdx, timeIdx);
-        distVec -= elemCtx.pos(inIdx, timeIdx);
-
-        Evaluation H;
         if (inLambda > 0.0 && exLambda > 0.0) {
             // compute the "thermal transmissibility". In contrast to the normal
             // transmissibility this cannot be done as a preprocessing step because the
             // average thermal thermal conductivity is analogous to the permeability but
-            // depends on the solution.
+            // depends on the solution. The purely geometric part of it is precomputed
+            // by the problem for each face, though. Strictly speaking, the geometric
+            // half transmissibilities of the two sides of the face differ. This code
+            // only keeps the original behaviour of using a single alpha for both sides,
+            // for which the harmonic mean simplifies to
+            //
+            // 1/(1/(alpha*inLambda) + 1/(alpha*exLambda)) = alpha*inLambda*exLambda/(inLambda + exLambda)
             Scalar alpha = elemCtx.problem().thermalHalfTransmissibility(elemCtx, scvfIdx, timeIdx);
-            const Evaluation& inH = inLambda*alpha;
-            const Evaluation& exH = exLambda*alpha;
-            H = 1.0/(1.0/inH + 1.0/exH);
+            Scalar conductionCoeff = -alpha/faceArea;
+            energyFlux_ = deltaT * (inLambda*exLambda/(inLambda + exLambda)) * conductionCoeff;
         }
         else
-            H = 0.0;
-
-        energyFlux_ = deltaT * (-H/faceArea);
+            energyFlux_ = 0.0;
     }
 
     template <class Context, class BoundaryFluidState>
@@ -570,9 +568,6 @@ public:
         else
             lambda = Opm::decay<Scalar>(inIq.totalThermalConductivity());
 
-        auto distVec = scvf.integrationPos();
-        distVec -= ctx.pos(inIdx, timeIdx);
-
         if (lambda > 0.0) {
             // compute the "thermal transmissibility". In contrast to the normal
             // transmissibility this cannot be done as a preprocessing step because the
@@ -46,6 +46,7 @@
 #include "blackoildarcyfluxmodule.hh"
 
 #include <ewoms/models/common/multiphasebasemodel.hh>
+#include <ewoms/models/common/tablelookuphints.hh>
 #include <ewoms/io/vtkcompositionmodule.hh>
 #include <ewoms/io/vtkblackoilmodule.hh>
 
@@ -55,6 +56,7 @@
 
 #include <sstream>
 #include <string>
+#include <utility>
 
 namespace Ewoms {
 template <class TypeTag>
@@ -157,6 +159,9 @@ PROP_STATIC_CONST_MEMBER_DEFINITION_PREFIX_(BlackOilModel, BlackOilEnergyScaling
 // volumes
 SET_BOOL_PROP(BlackOilModel, BlackoilConserveSurfaceVolume, false);
 
+// by default, the interval searches of the tabulated functions are done from scratch
+SET_BOOL_PROP(BlackOilModel, EnableTableLookupHints, false);
+
 END_PROPERTIES
 
 namespace Ewoms {
@@ -248,10 +253,17 @@ class BlackOilModel
     typedef BlackOilSolventModule<TypeTag> SolventModule;
     typedef BlackOilPolymerModule<TypeTag> PolymerModule;
     typedef BlackOilEnergyModule<TypeTag> EnergyModule;
+
+    static const bool enableSolvent = GET_PROP_VALUE(TypeTag, EnableSolvent);
+    static const bool enablePolymer = GET_PROP_VALUE(TypeTag, EnablePolymer);
 public:
+    typedef Ewoms::TableLookupHints<Scalar> TableLookupHints;
+
     BlackOilModel(Simulator& simulator)
         : ParentType(simulator)
-    {}
+    {
+        tableLookupHintsSeqNum_ = -1;
+    }
 
     /*!
      * \brief Register all run-time parameters for the immiscible model.
@@ -267,8 +279,48 @@ public:
         // register runtime parameters of the VTK output modules
         Ewoms::VtkBlackOilModule<TypeTag>::registerParameters();
         Ewoms::VtkCompositionModule<TypeTag>::registerParameters();
+
+        EWOMS_REGISTER_PARAM(TypeTag, bool, EnableTableLookupHints,
+                             "Start the interval searches of the tabulated functions "
+                             "of the solvent and polymer extensions at the interval "
+                             "which was used last for the respective degree of freedom");
+    }
+
+    /*!
+     * \copydoc FvBaseDiscretization::finishInit()
+     */
+    void finishInit()
+    {
+        ParentType::finishInit();
+
+        resizeTableLookupHints_();
     }
 
+    /*!
+     * \copydoc FvBaseDiscretization::adaptGrid()
+     */
+    void adaptGrid()
+    {
+        ParentType::adaptGrid();
+
+        if (this->simulator_.vanguard().gridSequenceNumber() != tableLookupHintsSeqNum_)
+            resizeTableLookupHints_();
+    }
+
+    /*!
+     * \brief Returns the interval hints for the tabulated functions of the solvent
+     *        extension.
+     */
+    const TableLookupHints& solventTableLookupHints() const
+    { return solventTableLookupHints_; }
+
+    /*!
+     * \brief Returns the interval hints for the tabulated functions of the polymer
+     *        extension.
+     */
+    const TableLookupHints& polymerTableLookupHints() const
+    { return polymerTableLookupHints_; }
+
     /*!
      * \copydoc FvBaseDiscretization::name
      */
@@ -529,6 +581,15 @@ protected:
                                     unsigned timeIdx)
     { updatePvtRegionIndex_(priVars, context, dofIdx, timeIdx); }
 
+    std::pair<unsigned, unsigned> dofParameterRegions_(const ElementContext& elemCtx,
+                                                       unsigned dofIdx) const
+    {
+        // the PVT relations and the saturation functions are given per region
+        const auto& problem = elemCtx.problem();
+        return std::make_pair(problem.pvtRegionIndex(elemCtx, dofIdx, /*timeIdx=*/0),
+                              problem.satnumRegionIndex(elemCtx, dofIdx, /*timeIdx=*/0));
+    }
+
     void registerOutputModules_()
     {
         ParentType::registerOutputModules_();
@@ -557,6 +618,23 @@ private:
         unsigned regionIdx = context.problem().pvtRegionIndex(context, dofIdx, timeIdx);
         priVars.setPvtRegionIndex(regionIdx);
     }
+
+    void resizeTableLookupHints_()
+    {
+        size_t numDof = 0;
+        if (EWOMS_GET_PARAM(TypeTag, bool, EnableTableLookupHints))
+            numDof = this->numGridDof();
+
+        solventTableLookupHints_.resize(numDof,
+                                        enableSolvent ? SolventModule::numTableLookupHints : 0);
+        polymerTableLookupHints_.resize(numDof,
+                                        enablePolymer ? PolymerModule::numTableLookupHints : 0);
+        tableLookupHintsSeqNum_ = this->simulator_.vanguard().gridSequenceNumber();
+    }
+
+    TableLookupHints solventTableLookupHints_;
+    TableLookupHints polymerTableLookupHints_;
+    int tableLookupHintsSeqNum_;
 };
 } // namespace Ewoms
 
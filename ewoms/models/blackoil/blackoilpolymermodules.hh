@@ -101,6 +101,15 @@ class BlackOilPolymerModule
 public:
     enum AdsorptionBehaviour { Desorption = 1, NoDesorption = 2 };
 
+    //! The indices of the interval hints which are stored for each degree of freedom
+    //! if table lookup hints are enabled
+    enum TableLookupHintIdx {
+        plyadsHintIdx,
+        plyviscHintIdx,
+        plyviscMaxHintIdx,
+        numTableLookupHints
+    };
+
     // a struct containing the constants to calculate polymer viscosity
     // based on Mark-Houwink equation and Huggins equation, the constants are provided
     // by the keyword PLYVMH
@@ -848,47 +857,48 @@ public:
         size_t numTableEntries = shearEffectRefLogVelocity.size();
         assert(shearEffectRefMultiplier.size() == numTableEntries);
 
-        std::vector<Scalar> shearEffectMultiplier(numTableEntries, 1.0);
-        for (size_t i = 0; i < numTableEntries; ++i) {
-            shearEffectMultiplier[i] = (1.0 + (viscosityMultiplier - 1.0)*shearEffectRefMultiplier[i]) / viscosityMultiplier;
-            shearEffectMultiplier[i] = Opm::log(shearEffectMultiplier[i]);
-        }
-        // store the logarithmic velocity and logarithmic multipliers in a table for easy look up and
-        // linear interpolation in the logarithmic space.
-        TabulatedFunction logShearEffectMultiplier = TabulatedFunction(numTableEntries, shearEffectRefLogVelocity, shearEffectMultiplier, /*bool sortInputs =*/ false );
+        auto logShearEffectMultiplier = [&shearEffectRefMultiplier, viscosityMultiplier](size_t i) {
+            return std::log((1.0 + (viscosityMultiplier - 1.0)*shearEffectRefMultiplier[i]) / viscosityMultiplier);
+        };
 
         // Find sheared velocity (v) that satisfies
         // F = log(v) + log (Z) - log(v0) = 0;
-
-        // Set up the function
-        // u = log(v)
-        auto F = [&logShearEffectMultiplier, &v0AbsLog](const Evaluation& u) {
-            return u + logShearEffectMultiplier.eval(u, true) - v0AbsLog;
-        };
-        // and its derivative
-        auto dF = [&logShearEffectMultiplier](const Evaluation& u) {
-            return 1 + logShearEffectMultiplier.evalDerivative(u, true);
-        };
-
-        // Solve F = 0 using Newton
-        // Use log(v0) as initial value for u
-        auto u = v0AbsLog;
-        bool converged = false;
-        for (int i = 0; i < 20; ++i ) {
-            auto f = F(u);
-            auto df = dF(u);
-            u -= f/df;
-            if (std::abs(Opm::scalarValue(f)) < 1e-12) {
-                converged = true;
-                break;
+        //
+        // log(Z) is interpolated linearly in the logarithmic velocity space, so F is a
+        // piecewise linear function of u = log(v). Instead of tabulating log(Z) and
+        // running a Newton solver on it, we thus look for the segment in which F
+        // changes its sign and calculate the root within it directly. (Outside of the
+        // table, the first and the last segments are extrapolated.)
+        Scalar u0 = Opm::scalarValue(v0AbsLog);
+        size_t segIdx = 0;
+        Scalar logZLeft = logShearEffectMultiplier(0);
+        Scalar logZRight = logZLeft;
+        if (numTableEntries > 1) {
+            logZRight = logShearEffectMultiplier(1);
+            for (; segIdx + 2 < numTableEntries; ++segIdx) {
+                if (shearEffectRefLogVelocity[segIdx + 1] + logZRight - u0 >= 0.0)
+                    break;
+
+                logZLeft = logZRight;
+                logZRight = logShearEffectMultiplier(segIdx + 2);
             }
         }
-        if (!converged) {
+
+        Scalar uLeft = shearEffectRefLogVelocity[segIdx];
+        Scalar slope = 0.0;
+        if (numTableEntries > 1)
+            slope = (logZRight - logZLeft)/(shearEffectRefLogVelocity[segIdx + 1] - uLeft);
+
+        // F must be strictly increasing, else there is no unique solution
+        if (1.0 + slope <= 0.0) {
             throw std::runtime_error("Not able to compute shear velocity. \n");
         }
 
+        // solve u + logZLeft + slope*(u - uLeft) - log(v0) = 0
+        Evaluation u = (v0AbsLog - logZLeft + slope*uLeft)/(1.0 + slope);
+
         // return the shear factor
-        return Opm::exp( logShearEffectMultiplier.eval(u, /*extrapolate=*/true) );
+        return Opm::exp((u - uLeft)*slope + logZLeft);
 
     }
 
@@ -1038,11 +1048,14 @@ public:
             polymerMoleWeight_ = priVars.makeEvaluation(polymerMoleWeightIdx, timeIdx);
         }
         const Scalar cmax = PolymerModule::plymaxMaxConcentration(elemCtx, dofIdx, timeIdx);
+        const auto& hints = elemCtx.model().polymerTableLookupHints();
+        unsigned globalDofIdx = elemCtx.globalSpaceIndex(dofIdx, timeIdx);
 
         // permeability reduction due to polymer
         const Scalar& maxAdsorbtion = PolymerModule::plyrockMaxAdsorbtion(elemCtx, dofIdx, timeIdx);
         const auto& plyadsAdsorbedPolymer = PolymerModule::plyadsAdsorbedPolymer(elemCtx, dofIdx, timeIdx);
-        polymerAdsorption_ = plyadsAdsorbedPolymer.eval(polymerConcentration_, /*extrapolate=*/true);
+        polymerAdsorption_ = hints.eval(plyadsAdsorbedPolymer, polymerConcentration_,
+                                        globalDofIdx, PolymerModule::plyadsHintIdx);
         if (PolymerModule::plyrockAdsorbtionIndex(elemCtx, dofIdx, timeIdx) == PolymerModule::NoDesorption ) {
             const Scalar& maxPolymerAdsorption = elemCtx.problem().maxPolymerAdsorption(elemCtx, dofIdx, timeIdx);
             polymerAdsorption_ = std::max(Evaluation(maxPolymerAdsorption) , polymerAdsorption_);
@@ -1057,11 +1070,15 @@ public:
             const auto& fs = asImp_().fluidState_;
             const Evaluation& muWater = fs.viscosity(waterPhaseIdx);
             const auto& viscosityMultiplier = PolymerModule::plyviscViscosityMultiplierTable(elemCtx, dofIdx, timeIdx);
-            const Evaluation viscosityMixture = viscosityMultiplier.eval(polymerConcentration_, /*extrapolate=*/true) * muWater;
+            const Evaluation viscosityMixture =
+                hints.eval(viscosityMultiplier, polymerConcentration_,
+                           globalDofIdx, PolymerModule::plyviscHintIdx) * muWater;
 
             // Do the Todd-Longstaff mixing
             const Scalar plymixparToddLongstaff = PolymerModule::plymixparToddLongstaff(elemCtx, dofIdx, timeIdx);
-            const Evaluation viscosityPolymer = viscosityMultiplier.eval(cmax, /*extrapolate=*/true) * muWater;
+            const Evaluation viscosityPolymer =
+                hints.eval(viscosityMultiplier, cmax,
+                           globalDofIdx, PolymerModule::plyviscMaxHintIdx) * muWater;
             const Evaluation viscosityPolymerEffective = pow(viscosityMixture, plymixparToddLongstaff) * pow(viscosityPolymer, 1.0 - plymixparToddLongstaff);
             const Evaluation viscosityWaterEffective = pow(viscosityMixture, plymixparToddLongstaff) * pow(muWater, 1.0 - plymixparToddLongstaff);
 
@@ -71,6 +71,10 @@ NEW_PROP_TAG(EnableEnergy);
 //! magnitude larger than that of the mass balance equations
 NEW_PROP_TAG(BlackOilEnergyScalingFactor);
 
+//! Specifies whether the index of the last used interval of the tabulated functions of
+//! the solvent and polymer extensions ought to be stored for each degree of freedom
+NEW_PROP_TAG(EnableTableLookupHints);
+
 
 END_PROPERTIES
 
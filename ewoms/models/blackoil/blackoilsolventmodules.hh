@@ -92,6 +92,22 @@ class BlackOilSolventModule
 
 
 public:
+    //! The indices of the interval hints which are stored for each degree of freedom
+    //! if table lookup hints are enabled
+    enum TableLookupHintIdx {
+        pmiscHintIdx,
+        miscHintIdx,
+        sorwmisHintIdx,
+        sgcwmisHintIdx,
+        msfnKrsgHintIdx,
+        msfnKroHintIdx,
+        sof2KrnHintIdx,
+        ssfnKrsHintIdx,
+        ssfnKrgHintIdx,
+        tlPMixHintIdx,
+        numTableLookupHints
+    };
+
 #if HAVE_ECL_INPUT
     /*!
      * \brief Initialize all internal data structures needed by the solvent module
@@ -937,10 +953,14 @@ public:
         if (solventSaturation().value() < cutOff)
             return;
 
+        const auto& hints = elemCtx.model().solventTableLookupHints();
+        unsigned globalDofIdx = elemCtx.globalSpaceIndex(dofIdx, timeIdx);
+
         // Pressure effects on capillary pressure miscibility
         if (SolventModule::isMiscible()) {
             const Evaluation& p = fs.pressure(oilPhaseIdx); // or gas pressure?
-            const Evaluation pmisc = SolventModule::pmisc(elemCtx, dofIdx, timeIdx).eval(p, /*extrapolate=*/true);
+            const auto& pmiscTable = SolventModule::pmisc(elemCtx, dofIdx, timeIdx);
+            const Evaluation pmisc = hints.eval(pmiscTable, p, globalDofIdx, SolventModule::pmiscHintIdx);
             const Evaluation& pgImisc = fs.pressure(gasPhaseIdx);
 
             // compute capillary pressure for miscible fluid
@@ -976,7 +996,9 @@ public:
             const auto& misc = SolventModule::misc(elemCtx, dofIdx, timeIdx);
             const auto& pmisc = SolventModule::pmisc(elemCtx, dofIdx, timeIdx);
             const Evaluation& p = fs.pressure(oilPhaseIdx); // or gas pressure?
-            const Evaluation miscibility = misc.eval(Fsolgas, /*extrapolate=*/true) * pmisc.eval(p, /*extrapolate=*/true);
+            const Evaluation miscibility =
+                hints.eval(misc, Fsolgas, globalDofIdx, SolventModule::miscHintIdx)
+                * hints.eval(pmisc, p, globalDofIdx, SolventModule::pmiscHintIdx);
 
             // TODO adjust endpoints of sn and ssg
             unsigned cellIdx = elemCtx.globalSpaceIndex(dofIdx, timeIdx);
@@ -990,8 +1012,8 @@ public:
             const auto& sorwmis = SolventModule::sorwmis(elemCtx, dofIdx, timeIdx);
             const auto& sgcwmis = SolventModule::sgcwmis(elemCtx, dofIdx, timeIdx);
 
-            Evaluation sor = miscibility * sorwmis.eval(sw,  /*extrapolate=*/true) + ( 1.0 - miscibility) * sogcr;
-            Evaluation sgc = miscibility * sgcwmis.eval(sw,  /*extrapolate=*/true) + ( 1.0 - miscibility) * sgcr;
+            Evaluation sor = miscibility * hints.eval(sorwmis, sw, globalDofIdx, SolventModule::sorwmisHintIdx) + ( 1.0 - miscibility) * sogcr;
+            Evaluation sgc = miscibility * hints.eval(sgcwmis, sw, globalDofIdx, SolventModule::sgcwmisHintIdx) + ( 1.0 - miscibility) * sgcr;
 
             const Evaluation oilGasSolventSat = gasSolventSat + fs.saturation(oilPhaseIdx);
             const Evaluation zero = 0.0;
@@ -1006,8 +1028,9 @@ public:
             const auto& msfnKrsg = SolventModule::msfnKrsg(elemCtx, dofIdx, timeIdx);
             const auto& sof2Krn = SolventModule::sof2Krn(elemCtx, dofIdx, timeIdx);
 
-            const Evaluation mkrgt = msfnKrsg.eval( F_totalGas, /*extrapolate=*/true ) * sof2Krn.eval( oilGasSolventSat, /*extrapolate=*/true);
-            const Evaluation mkro = msfnKro.eval( F_totalGas, /*extrapolate=*/true ) * sof2Krn.eval( oilGasSolventSat, /*extrapolate=*/true );
+            const Evaluation krn = hints.eval(sof2Krn, oilGasSolventSat, globalDofIdx, SolventModule::sof2KrnHintIdx);
+            const Evaluation mkrgt = hints.eval(msfnKrsg, F_totalGas, globalDofIdx, SolventModule::msfnKrsgHintIdx) * krn;
+            const Evaluation mkro = hints.eval(msfnKro, F_totalGas, globalDofIdx, SolventModule::msfnKroHintIdx) * krn;
 
             Evaluation& kro = asImp_().mobility_[oilPhaseIdx];
             Evaluation& krg = asImp_().mobility_[gasPhaseIdx];
@@ -1026,8 +1049,8 @@ public:
         const auto& ssfnKrs = SolventModule::ssfnKrs(elemCtx, dofIdx, timeIdx);
 
         Evaluation& krg = asImp_().mobility_[gasPhaseIdx];
-        solventMobility_ = krg * ssfnKrs.eval(Fsolgas, /*extrapolate=*/true);
-        krg *= ssfnKrg.eval(Fhydgas, /*extrapolate=*/true);
+        solventMobility_ = krg * hints.eval(ssfnKrs, Fsolgas, globalDofIdx, SolventModule::ssfnKrsHintIdx);
+        krg *= hints.eval(ssfnKrg, Fhydgas, globalDofIdx, SolventModule::ssfnKrgHintIdx);
 
     }
 
@@ -1096,16 +1119,20 @@ private:
             return;
 
         auto& fs = asImp_().fluidState_;
+        const auto& hints = elemCtx.model().solventTableLookupHints();
+        unsigned globalDofIdx = elemCtx.globalSpaceIndex(scvIdx, timeIdx);
 
         // Compute effective saturations
         const auto& sorwmis = SolventModule::sorwmis(elemCtx, scvIdx, timeIdx);
         const auto& sgcwmis = SolventModule::sgcwmis(elemCtx, scvIdx, timeIdx);
         const Evaluation& sw = fs.saturation(waterPhaseIdx);
+        const Evaluation sorw = hints.eval(sorwmis, sw, globalDofIdx, SolventModule::sorwmisHintIdx);
+        const Evaluation sgcw = hints.eval(sgcwmis, sw, globalDofIdx, SolventModule::sgcwmisHintIdx);
 
         const Evaluation zero = 0.0;
-        const Evaluation oilEffSat = std::max(fs.saturation(oilPhaseIdx) - sorwmis.eval(sw,  /*extrapolate=*/true),zero);
-        const Evaluation gasEffSat = std::max(fs.saturation(gasPhaseIdx) - sgcwmis.eval(sw,  /*extrapolate=*/true),zero);
-        const Evaluation solventEffSat = std::max(solventSaturation() - sgcwmis.eval(sw,  /*extrapolate=*/true),zero);
+        const Evaluation oilEffSat = std::max(fs.saturation(oilPhaseIdx) - sorw,zero);
+        const Evaluation gasEffSat = std::max(fs.saturation(gasPhaseIdx) - sgcw,zero);
+        const Evaluation solventEffSat = std::max(solventSaturation() - sgcw,zero);
 
         const Evaluation oilGasSolventEffSat =  oilEffSat + gasEffSat + solventEffSat;
         const Evaluation oilSolventEffSat = oilEffSat + solventEffSat;
@@ -1141,7 +1168,8 @@ private:
         // The pressureMixingParameter is not implemented in ecl100.
         const Evaluation& po = fs.pressure(oilPhaseIdx);
         const auto& tlPMixTable = SolventModule::tlPMixTable(elemCtx, scvIdx, timeIdx);
-        const Evaluation tlMixParamMu = SolventModule::tlMixParamViscosity(elemCtx, scvIdx, timeIdx) * tlPMixTable.eval(po,  /*extrapolate=*/true);
+        const Evaluation tlPMix = hints.eval(tlPMixTable, po, globalDofIdx, SolventModule::tlPMixHintIdx);
+        const Evaluation tlMixParamMu = SolventModule::tlMixParamViscosity(elemCtx, scvIdx, timeIdx) * tlPMix;
 
         Evaluation muOilEff = pow(muOil,1.0 - tlMixParamMu) * pow(muMixOilSolvent, tlMixParamMu);
         Evaluation muGasEff = pow(muGas,1.0 - tlMixParamMu) * pow(muMixSolventGas, tlMixParamMu);
@@ -1155,7 +1183,7 @@ private:
         // Mixing parameter for density
         // The pressureMixingParameter represent the miscibility of the solvent while the mixingParameterDenisty the effect of the porous media.
         // The pressureMixingParameter is not implemented in ecl100.
-        const Evaluation tlMixParamRho = SolventModule::tlMixParamDensity(elemCtx, scvIdx, timeIdx) * tlPMixTable.eval(po,  /*extrapolate=*/true);
+        const Evaluation tlMixParamRho = SolventModule::tlMixParamDensity(elemCtx, scvIdx, timeIdx) * tlPMix;
 
         // compute effective viscosities for density calculations. These have to
         // be recomputed as a different mixing parameter may be used.
@@ -1210,7 +1238,7 @@ private:
 
         // account for pressure effects
         const auto& pmiscTable = SolventModule::pmisc(elemCtx, scvIdx, timeIdx);
-        const Evaluation pmisc = pmiscTable.eval(po, /*extrapolate=*/true);
+        const Evaluation pmisc = hints.eval(pmiscTable, po, globalDofIdx, SolventModule::pmiscHintIdx);
 
         // copy the unmodified invB factors
         const Evaluation bo = fs.invB(oilPhaseIdx);
@@ -234,9 +234,12 @@ public:
     /*!
      * \brief Returns the effective molecular diffusion coefficient of
      *        the porous medium for a component in a phase.
+     *
+     * The effective coefficients are computed when the intensive quantities are
+     * updated, i.e., they are not recomputed for each face which uses them.
      */
-    Evaluation effectiveDiffusionCoefficient(unsigned phaseIdx, unsigned compIdx) const
-    { return tortuosity_[phaseIdx] * diffusionCoefficient_[phaseIdx][compIdx]; }
+    const Evaluation& effectiveDiffusionCoefficient(unsigned phaseIdx, unsigned compIdx) const
+    { return effectiveDiffusionCoefficient_[phaseIdx][compIdx]; }
 
 protected:
     /*!
@@ -274,6 +277,8 @@ protected:
                                                       paramCache,
                                                       phaseIdx,
                                                       compIdx);
+                effectiveDiffusionCoefficient_[phaseIdx][compIdx] =
+                    tortuosity_[phaseIdx] * diffusionCoefficient_[phaseIdx][compIdx];
             }
         }
     }
@@ -281,6 +286,7 @@ protected:
 private:
     Evaluation tortuosity_[numPhases];
     Evaluation diffusionCoefficient_[numPhases][numComponents];
+    Evaluation effectiveDiffusionCoefficient_[numPhases][numComponents];
 };
 
 /*!
@@ -364,7 +370,6 @@ class DiffusionExtensiveQuantities<TypeTag, /*enableDiffusion=*/true>
     enum { numComponents = GET_PROP_VALUE(TypeTag, NumComponents) };
 
     typedef Dune::FieldVector<Scalar, dimWorld> DimVector;
-    typedef Dune::FieldVector<Evaluation, dimWorld> DimEvalVector;
 
 protected:
     /*!
@@ -376,8 +381,6 @@ protected:
         const auto& gradCalc = elemCtx.gradientCalculator();
         Ewoms::MoleFractionCallback<TypeTag> moleFractionCallback(elemCtx);
 
-        const auto& face = elemCtx.stencil(timeIdx).interiorFace(faceIdx);
-        const auto& normal = face.normal();
         const auto& extQuants = elemCtx.extensiveQuantities(faceIdx, timeIdx);
 
         const auto& intQuantsInside = elemCtx.intensiveQuantities(extQuants.interiorIndex(), timeIdx);
@@ -391,16 +394,10 @@ protected:
             for (unsigned compIdx = 0; compIdx < numComponents; ++compIdx) {
                 moleFractionCallback.setComponentIndex(compIdx);
 
-                DimEvalVector moleFractionGradient(0.0);
-                gradCalc.calculateGradient(moleFractionGradient,
-                                           elemCtx,
-                                           faceIdx,
-                                           moleFractionCallback);
-
-                moleFractionGradientNormal_[phaseIdx][compIdx] = 0.0;
-                for (unsigned i = 0; i < normal.size(); ++i)
-                    moleFractionGradientNormal_[phaseIdx][compIdx] +=
-                        normal[i]*moleFractionGradient[i];
+                gradCalc.calculateNormalGradient(moleFractionGradientNormal_[phaseIdx][compIdx],
+                                                 elemCtx,
+                                                 faceIdx,
+                                                 moleFractionCallback);
                 Opm::Valgrind::CheckDefined(moleFractionGradientNormal_[phaseIdx][compIdx]);
 
                 // use the arithmetic average for the effective
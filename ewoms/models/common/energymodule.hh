@@ -760,7 +760,6 @@ class EnergyExtensiveQuantities<TypeTag, /*enableEnergy=*/true>
     typedef typename GET_PROP_TYPE(TypeTag, GridView) GridView;
 
     enum { dimWorld = GridView::dimensionworld };
-    typedef Dune::FieldVector<Evaluation, dimWorld> EvalDimVector;
     typedef Dune::FieldVector<Scalar, dimWorld> DimVector;
 
 protected:
@@ -773,18 +772,11 @@ protected:
         const auto& gradCalc = elemCtx.gradientCalculator();
         Ewoms::TemperatureCallback<TypeTag> temperatureCallback(elemCtx);
 
-        EvalDimVector temperatureGrad;
-        gradCalc.calculateGradient(temperatureGrad,
-                                   elemCtx,
-                                   faceIdx,
-                                   temperatureCallback);
-
         // scalar product of temperature gradient and scvf normal
-        const auto& face = elemCtx.stencil(/*timeIdx=*/0).interiorFace(faceIdx);
-
-        temperatureGradNormal_ = 0;
-        for (unsigned dimIdx = 0; dimIdx < dimWorld; ++dimIdx)
-            temperatureGradNormal_ += (face.normal()[dimIdx]*temperatureGrad[dimIdx]);
+        gradCalc.calculateNormalGradient(temperatureGradNormal_,
+                                         elemCtx,
+                                         faceIdx,
+                                         temperatureCallback);
 
         const auto& extQuants = elemCtx.extensiveQuantities(faceIdx, timeIdx);
         const auto& intQuantsInside = elemCtx.intensiveQuantities(extQuants.interiorIndex(), timeIdx);
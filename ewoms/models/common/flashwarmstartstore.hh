@@ -0,0 +1,216 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \copydoc Ewoms::FlashWarmStartStore
+ */
+#ifndef EWOMS_FLASH_WARM_START_STORE_HH
+#define EWOMS_FLASH_WARM_START_STORE_HH
+
+#include <opm/material/common/MathToolbox.hpp>
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+namespace Ewoms {
+
+/*!
+ * \ingroup Models
+ *
+ * \brief Stores the last converged phase saturations and compositions of each degree
+ *        of freedom to be used as the initial guess of the next flash calculation.
+ *
+ * In contrast to the thermodynamic hints, this does not depend on the intensive
+ * quantity cache being enabled and it only requires a few scalars per degree of
+ * freedom. Two versions of the data are kept: the most recent one, which is updated
+ * with the fluid states of the latest iterate of the Newton method, and the one of the
+ * last accepted time step, which is used for the solution of the previous time step and
+ * to which the most recent data is reset if a time step fails.
+ *
+ * Storing and retrieving the data is thread-safe.
+ */
+template <class Scalar, unsigned numPhases, unsigned numComponents>
+class FlashWarmStartStore
+{
+    struct Entry
+    {
+        Scalar saturation[numPhases];
+        Scalar moleFraction[numPhases][numComponents];
+        bool valid;
+    };
+
+    // the number of mutexes which protect the entries. an entry is protected by the
+    // mutex given by its index modulo this value.
+    enum { numLocks = 64 };
+
+public:
+    FlashWarmStartStore()
+        : numSolves_(0)
+        , numWarmStarts_(0)
+    { }
+
+    /*!
+     * \brief Set the number of degrees of freedom and invalidate all stored data.
+     */
+    void resize(size_t numDof)
+    {
+        Entry invalidEntry;
+        invalidEntry.valid = false;
+
+        current_.assign(numDof, invalidEntry);
+        accepted_.assign(numDof, invalidEntry);
+    }
+
+    /*!
+     * \brief Set the saturations and the phase compositions of a fluid state to the
+     *        stored ones.
+     *
+     * Returns false and leaves the fluid state alone if no data is available for the
+     * degree of freedom.
+     *
+     * \param fluidState The fluid state which ought to be modified
+     * \param dofIdx The global index of the degree of freedom
+     * \param timeIdx The time index of the solution for which the fluid state is needed
+     * \param loadSaturations If false, only the phase compositions are set
+     */
+    template <class FluidState>
+    bool load(FluidState& fluidState,
+              unsigned dofIdx,
+              unsigned timeIdx,
+              bool loadSaturations = true) const
+    {
+        if (dofIdx >= current_.size())
+            return false;
+
+        Entry entry;
+        {
+            std::lock_guard<std::mutex> lock(locks_[dofIdx % numLocks]);
+            entry = (timeIdx == 0) ? current_[dofIdx] : accepted_[dofIdx];
+        }
+
+        if (!entry.valid)
+            return false;
+
+        for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
+            if (loadSaturations)
+                fluidState.setSaturation(phaseIdx, entry.saturation[phaseIdx]);
+            for (unsigned compIdx = 0; compIdx < numComponents; ++compIdx)
+                fluidState.setMoleFraction(phaseIdx, compIdx, entry.moleFraction[phaseIdx][compIdx]);
+        }
+
+        return true;
+    }
+
+    /*!
+     * \brief Store the saturations and the phase compositions of a converged fluid
+     *        state for the current solution.
+     *
+     * The fluid state must not stem from perturbed primary variables like the ones
+     * used by the finite difference linearizer.
+     */
+    template <class FluidState>
+    void store(unsigned dofIdx, const FluidState& fluidState)
+    {
+        if (dofIdx >= current_.size())
+            return;
+
+        Entry entry;
+        for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
+            entry.saturation[phaseIdx] = Opm::scalarValue(fluidState.saturation(phaseIdx));
+            for (unsigned compIdx = 0; compIdx < numComponents; ++compIdx)
+                entry.moleFraction[phaseIdx][compIdx] =
+                    Opm::scalarValue(fluidState.moleFraction(phaseIdx, compIdx));
+        }
+        entry.valid = true;
+
+        std::lock_guard<std::mutex> lock(locks_[dofIdx % numLocks]);
+        current_[dofIdx] = entry;
+    }
+
+    /*!
+     * \brief Make the most recent data the one of the last accepted time step.
+     *
+     * This is supposed to be called after a time step was successful.
+     */
+    void accept()
+    { accepted_ = current_; }
+
+    /*!
+     * \brief Reset the most recent data to the one of the last accepted time step.
+     *
+     * This is supposed to be called after a time step failed.
+     */
+    void rollback()
+    { current_ = accepted_; }
+
+    /*!
+     * \brief Record that a flash calculation was done.
+     *
+     * \param warmStarted Specifies whether stored data was used as the initial guess
+     */
+    void countSolve(bool warmStarted)
+    {
+        ++ numSolves_;
+        if (warmStarted)
+            ++ numWarmStarts_;
+    }
+
+    /*!
+     * \brief Returns the total number of flash calculations.
+     */
+    unsigned long numSolves() const
+    { return numSolves_; }
+
+    /*!
+     * \brief Returns the number of flash calculations for which stored data was used
+     *        as the initial guess.
+     */
+    unsigned long numWarmStarts() const
+    { return numWarmStarts_; }
+
+    /*!
+     * \brief Set the number of flash calculations and of warm starts to zero.
+     */
+    void resetStatistics()
+    {
+        numSolves_ = 0;
+        numWarmStarts_ = 0;
+    }
+
+private:
+    std::vector<Entry> current_;
+    std::vector<Entry> accepted_;
+
+    mutable std::array<std::mutex, numLocks> locks_;
+
+    std::atomic<unsigned long> numSolves_;
+    std::atomic<unsigned long> numWarmStarts_;
+};
+
+} // namespace Ewoms
+
+#endif
@@ -0,0 +1,184 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \copydoc Ewoms::TableLookupHints
+ */
+#ifndef EWOMS_TABLE_LOOKUP_HINTS_HH
+#define EWOMS_TABLE_LOOKUP_HINTS_HH
+
+#include <opm/material/common/MathToolbox.hpp>
+#include <opm/material/common/Tabulated1DFunction.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+namespace Ewoms {
+
+/*!
+ * \ingroup Models
+ *
+ * \brief Stores the index of the sampling interval which was used by the most recent
+ *        evaluation of a tabulated function for each degree of freedom.
+ *
+ * Since the solution normally changes only a little between two evaluations for the
+ * same degree of freedom, the argument of a table evaluation usually lies in the same
+ * interval as the one of the last evaluation or in one of its direct neighbors. Checking
+ * these first reduces the cost of the interval search to a few comparisons. If the hint
+ * does not apply, a bisection is done, so the result of an evaluation is always the
+ * same as the one of Opm::Tabulated1DFunction::eval() with extrapolation enabled.
+ *
+ * Each degree of freedom stores a fixed number of hints which are addressed by an index
+ * that is chosen by the caller, i.e., each index should correspond to a table which is
+ * evaluated at most once per update of the intensive quantities. If the store is empty,
+ * all evaluations are passed through to the table. Using the hints is thread-safe.
+ */
+template <class Scalar>
+class TableLookupHints
+{
+    typedef Opm::Tabulated1DFunction<Scalar> TabulatedFunction;
+
+public:
+    TableLookupHints()
+        : numDof_(0)
+        , numHintsPerDof_(0)
+    { }
+
+    /*!
+     * \brief Set the number of degrees of freedom and the number of hints per degree of
+     *        freedom and reset all hints.
+     *
+     * If either argument is zero, no hints are stored.
+     */
+    void resize(size_t numDof, unsigned numHintsPerDof)
+    {
+        size_t numHints = numDof*numHintsPerDof;
+        numDof_ = (numHints > 0) ? numDof : 0;
+        numHintsPerDof_ = (numHints > 0) ? numHintsPerDof : 0;
+
+        hints_.reset(numHints > 0 ? new std::atomic<unsigned>[numHints] : nullptr);
+        for (size_t i = 0; i < numHints; ++i)
+            hints_[i].store(0, std::memory_order_relaxed);
+    }
+
+    /*!
+     * \brief Returns true if any hints are stored.
+     */
+    bool enabled() const
+    { return numDof_ > 0; }
+
+    /*!
+     * \brief Evaluate a tabulated function using the hint of a given degree of freedom
+     *        and update the hint afterwards.
+     *
+     * This is equivalent to <tt>table.eval(x, true)</tt>.
+     *
+     * \param table The tabulated function which ought to be evaluated
+     * \param x The position at which the function ought to be evaluated
+     * \param globalDofIdx The global index of the degree of freedom
+     * \param hintIdx The index of the hint which is used for the table
+     */
+    template <class Evaluation>
+    Evaluation eval(const TabulatedFunction& table,
+                    const Evaluation& x,
+                    unsigned globalDofIdx,
+                    unsigned hintIdx) const
+    {
+        if (globalDofIdx >= numDof_ || hintIdx >= numHintsPerDof_)
+            return table.eval(x, /*extrapolate=*/true);
+
+        std::atomic<unsigned>& hint = hints_[globalDofIdx*numHintsPerDof_ + hintIdx];
+        unsigned segIdx = findSegmentIndex_(table,
+                                            Opm::scalarValue(x),
+                                            hint.load(std::memory_order_relaxed));
+        hint.store(segIdx, std::memory_order_relaxed);
+
+        Scalar x0 = table.xAt(segIdx);
+        Scalar x1 = table.xAt(segIdx + 1);
+
+        Scalar y0 = table.valueAt(segIdx);
+        Scalar y1 = table.valueAt(segIdx + 1);
+
+        return y0 + (y1 - y0)*(x - x0)/(x1 - x0);
+    }
+
+private:
+    // returns true if the interval search of Opm::Tabulated1DFunction would yield the
+    // segment 'segIdx' for the position 'x'
+    static bool segmentApplies_(const TabulatedFunction& table, Scalar x, unsigned segIdx)
+    {
+        unsigned lastSegIdx = static_cast<unsigned>(table.numSamples()) - 2;
+        if (segIdx > lastSegIdx)
+            return false;
+
+        // the first segment also covers everything left of the second sampling point
+        // and the last one everything right of the second-to-last point
+        if (segIdx == 0)
+            return x <= table.xAt(1) || lastSegIdx == 0;
+        if (x <= table.xAt(1))
+            return false;
+        if (segIdx == lastSegIdx)
+            return x >= table.xAt(lastSegIdx);
+        return table.xAt(segIdx) <= x && x < table.xAt(segIdx + 1);
+    }
+
+    static unsigned findSegmentIndex_(const TabulatedFunction& table, Scalar x, unsigned hint)
+    {
+        if (segmentApplies_(table, x, hint))
+            return hint;
+        if (hint > 0 && segmentApplies_(table, x, hint - 1))
+            return hint - 1;
+        if (segmentApplies_(table, x, hint + 1))
+            return hint + 1;
+
+        // the hint was off by more than one interval. do the same as
+        // Opm::Tabulated1DFunction.
+        size_t numSamples = table.numSamples();
+        if (x <= table.xAt(1))
+            return 0;
+        else if (x >= table.xAt(numSamples - 2))
+            return static_cast<unsigned>(numSamples - 2);
+
+        size_t lowerIdx = 1;
+        size_t upperIdx = numSamples - 2;
+        while (lowerIdx + 1 < upperIdx) {
+            size_t pivotIdx = (lowerIdx + upperIdx) / 2;
+            if (x < table.xAt(pivotIdx))
+                upperIdx = pivotIdx;
+            else
+                lowerIdx = pivotIdx;
+        }
+
+        return static_cast<unsigned>(lowerIdx);
+    }
+
+    size_t numDof_;
+    unsigned numHintsPerDof_;
+    std::unique_ptr<std::atomic<unsigned>[]> hints_;
+};
+
+} // namespace Ewoms
+
+#endif
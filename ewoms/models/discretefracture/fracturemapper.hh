@@ -30,7 +30,9 @@
 #include <ewoms/common/propertysystem.hh>
 
 #include <algorithm>
-#include <set>
+#include <atomic>
+#include <mutex>
+#include <vector>
 
 namespace Ewoms {
 
@@ -63,28 +65,48 @@ public:
      * \brief Constructor
      */
     FractureMapper()
+        : isFinalized_(true)
     {}
 
     /*!
      * \brief Marks an edge as having a fracture.
      *
+     * After all fracture edges have been added, finalize() should be called. If this
+     * is not done, the lookup structures are created by the first call to
+     * isFractureEdge().
+     *
      * \param vertexIdx1 The index of the edge's first vertex.
      * \param vertexIdx2 The index of the edge's second vertex.
      */
     void addFractureEdge(unsigned vertexIdx1, unsigned vertexIdx2)
     {
-        fractureEdges_.insert(FractureEdge(vertexIdx1, vertexIdx2));
-        fractureVertices_.insert(vertexIdx1);
-        fractureVertices_.insert(vertexIdx2);
+        unsigned maxVertexIdx = std::max(vertexIdx1, vertexIdx2);
+        if (fractureVertexFlags_.size() <= maxVertexIdx)
+            fractureVertexFlags_.resize(maxVertexIdx + 1, 0);
+        fractureVertexFlags_[vertexIdx1] = 1;
+        fractureVertexFlags_[vertexIdx2] = 1;
+
+        fractureEdges_.push_back(FractureEdge(vertexIdx1, vertexIdx2));
+        isFinalized_.store(false, std::memory_order_release);
     }
 
+    /*!
+     * \brief Creates the data structures which are used to look up fracture edges.
+     *
+     * The fracture edges adjacent to each vertex are stored in a compressed row
+     * format, so looking up an edge only requires to scan the fracture edges of one of
+     * its vertices.
+     */
+    void finalize()
+    { finalize_(); }
+
     /*!
      * \brief Returns true iff a fracture cuts through a given vertex.
      *
      * \param vertexIdx The index of the vertex.
      */
     bool isFractureVertex(unsigned vertexIdx) const
-    { return fractureVertices_.count(vertexIdx) > 0; }
+    { return vertexIdx < fractureVertexFlags_.size() && fractureVertexFlags_[vertexIdx]; }
 
     /*!
      * \brief Returns true iff a fracture is associated with a given edge.
@@ -94,13 +116,60 @@ public:
      */
     bool isFractureEdge(unsigned vertex1Idx, unsigned vertex2Idx) const
     {
-        FractureEdge tmp(vertex1Idx, vertex2Idx);
-        return fractureEdges_.count(tmp) > 0;
+        if (!isFinalized_.load(std::memory_order_acquire))
+            finalize_();
+
+        if (!isFractureVertex(vertex1Idx) || !isFractureVertex(vertex2Idx))
+            return false;
+
+        for (unsigned i = neighborOffsets_[vertex1Idx]; i < neighborOffsets_[vertex1Idx + 1]; ++i)
+            if (neighbors_[i] == vertex2Idx)
+                return true;
+
+        return false;
     }
 
 private:
-    std::set<FractureEdge> fractureEdges_;
-    std::set<unsigned> fractureVertices_;
+    // this may be called concurrently by multiple threads via isFractureEdge(), so
+    // only the first one creates the lookup structures.
+    void finalize_() const
+    {
+        std::lock_guard<std::mutex> lock(finalizeMutex_);
+        if (isFinalized_.load(std::memory_order_relaxed))
+            return;
+
+        std::sort(fractureEdges_.begin(), fractureEdges_.end());
+        fractureEdges_.erase(std::unique(fractureEdges_.begin(), fractureEdges_.end()),
+                             fractureEdges_.end());
+
+        size_t numVertices = fractureVertexFlags_.size();
+        neighborOffsets_.assign(numVertices + 1, 0);
+        for (const auto& edge : fractureEdges_) {
+            ++ neighborOffsets_[edge.i_ + 1];
+            ++ neighborOffsets_[edge.j_ + 1];
+        }
+        for (size_t vertexIdx = 0; vertexIdx < numVertices; ++ vertexIdx)
+            neighborOffsets_[vertexIdx + 1] += neighborOffsets_[vertexIdx];
+
+        neighbors_.resize(neighborOffsets_[numVertices]);
+        std::vector<unsigned> nextPos(neighborOffsets_.begin(), neighborOffsets_.end() - 1);
+        for (const auto& edge : fractureEdges_) {
+            neighbors_[nextPos[edge.i_]++] = edge.j_;
+            neighbors_[nextPos[edge.j_]++] = edge.i_;
+        }
+
+        isFinalized_.store(true, std::memory_order_release);
+    }
+
+    mutable std::vector<FractureEdge> fractureEdges_;
+    std::vector<char> fractureVertexFlags_;
+
+    // the fracture edges adjacent to each vertex in compressed row format
+    mutable std::vector<unsigned> neighborOffsets_;
+    mutable std::vector<unsigned> neighbors_;
+
+    mutable std::atomic<bool> isFinalized_;
+    mutable std::mutex finalizeMutex_;
 };
 
 } // namespace Ewoms
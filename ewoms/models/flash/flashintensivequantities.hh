@@ -35,11 +35,14 @@
 #include <ewoms/models/common/diffusionmodule.hh>
 
 #include <opm/material/fluidstates/CompositionalFluidState.hpp>
+#include <opm/material/densead/Math.hpp>
 #include <opm/material/common/Valgrind.hpp>
 
 #include <dune/common/fvector.hh>
 #include <dune/common/fmatrix.hh>
 
+#include <type_traits>
+
 namespace Ewoms {
 
 /*!
@@ -73,12 +76,25 @@ class FlashIntensiveQuantities
     enum { enableEnergy = GET_PROP_VALUE(TypeTag, EnableEnergy) };
     enum { dimWorld = GridView::dimensionworld };
 
+    // the unknowns of the flash are the pressure of the first phase, the saturations
+    // of all phases except the last one and the mole fractions of all components in
+    // all phases
+    enum { numFlashEq = numPhases*(numComponents + 1) };
+    enum { numDerivatives = GET_PROP_VALUE(TypeTag, NumEq) };
+
     typedef typename GET_PROP_TYPE(TypeTag, Scalar) Scalar;
     typedef typename GET_PROP_TYPE(TypeTag, Evaluation) Evaluation;
     typedef typename GET_PROP_TYPE(TypeTag, FluidSystem) FluidSystem;
     typedef typename GET_PROP_TYPE(TypeTag, FlashSolver) FlashSolver;
 
+    typedef Opm::MathToolbox<Evaluation> Toolbox;
+
     typedef Dune::FieldVector<Evaluation, numComponents> ComponentVector;
+    typedef Dune::FieldVector<Scalar, numComponents> ScalarComponentVector;
+    typedef Dune::FieldVector<Scalar, numFlashEq> FlashVector;
+    typedef Dune::FieldMatrix<Scalar, numFlashEq, numFlashEq> FlashMatrix;
+    typedef Opm::CompositionalFluidState<Scalar, FluidSystem, /*storeEnthalpy=*/false> ScalarFluidState;
+    typedef typename FluidSystem::template ParameterCache<Evaluation> ParameterCache;
     typedef Dune::FieldMatrix<Scalar, dimWorld, dimWorld> DimMatrix;
 
     typedef typename FluxModule::FluxIntensiveQuantities FluxIntensiveQuantities;
@@ -107,12 +123,17 @@ public:
         const auto& priVars = elemCtx.primaryVars(dofIdx, timeIdx);
         const auto& problem = elemCtx.problem();
         Scalar flashTolerance = EWOMS_GET_PARAM(TypeTag, Scalar, FlashTolerance);
+        bool enableScalarFlash = EWOMS_GET_PARAM(TypeTag, bool, EnableScalarFlash);
 
         // extract the total molar densities of the components
         ComponentVector cTotal;
         for (unsigned compIdx = 0; compIdx < numComponents; ++compIdx)
             cTotal[compIdx] = priVars.makeEvaluation(cTot0Idx + compIdx, timeIdx);
 
+        // set the initial guess of the flash
+        auto& warmStartStore = elemCtx.model().warmStartStore();
+        unsigned globalDofIdx = elemCtx.globalSpaceIndex(dofIdx, timeIdx);
+        bool warmStarted = true;
         const auto *hint = elemCtx.thermodynamicHint(dofIdx, timeIdx);
         if (hint) {
             // use the same fluid state as the one of the hint, but
@@ -122,18 +143,28 @@ public:
             fluidState_.assign(hint->fluidState());
             fluidState_.setTemperature(T);
         }
-        else
+        else {
+            // use the saturations and compositions of the last converged flash for
+            // the degree of freedom if they are available
             FlashSolver::guessInitial(fluidState_, cTotal);
+            warmStarted = warmStartStore.load(fluidState_, globalDofIdx, timeIdx);
+        }
 
         // compute the phase compositions, densities and pressures
-        typename FluidSystem::template ParameterCache<Evaluation> paramCache;
+        ParameterCache paramCache;
         const MaterialLawParams& materialParams =
             problem.materialLawParams(elemCtx, dofIdx, timeIdx);
-        FlashSolver::template solve<MaterialLaw>(fluidState_,
-                                                 materialParams,
-                                                 paramCache,
-                                                 cTotal,
-                                                 flashTolerance);
+        if (enableScalarFlash)
+            scalarFlash_(paramCache, materialParams, cTotal, flashTolerance,
+                         std::is_same<Evaluation, Scalar>());
+        else
+            FlashSolver::template solve<MaterialLaw>(fluidState_,
+                                                     materialParams,
+                                                     paramCache,
+                                                     cTotal,
+                                                     flashTolerance);
+
+        warmStartStore.countSolve(warmStarted);
 
         // calculate relative permeabilities
         MaterialLaw::relativePermeabilities(relativePermeability_,
@@ -205,6 +236,180 @@ public:
     { return porosity_; }
 
 private:
+    // if the evaluations do not carry any derivatives, the regular flash is already
+    // scalar
+    void scalarFlash_(ParameterCache& paramCache,
+                      const MaterialLawParams& materialParams,
+                      const ComponentVector& cTotal,
+                      Scalar flashTolerance,
+                      std::true_type /*evaluationIsScalar*/)
+    {
+        FlashSolver::template solve<MaterialLaw>(fluidState_,
+                                                 materialParams,
+                                                 paramCache,
+                                                 cTotal,
+                                                 flashTolerance);
+    }
+
+    // solve the flash using scalars and recover the derivatives of its unknowns with
+    // regard to the primary variables using the implicit function theorem: if R(x, c)
+    // = 0 are the flash equations, then dx/dc = -(dR/dx)^-1 * dR/dc at the solution.
+    void scalarFlash_(ParameterCache& paramCache,
+                      const MaterialLawParams& materialParams,
+                      const ComponentVector& cTotal,
+                      Scalar flashTolerance,
+                      std::false_type /*evaluationIsScalar*/)
+    {
+        typedef Opm::DenseAd::Evaluation<Scalar, numFlashEq> FlashEval;
+        typedef Opm::MathToolbox<FlashEval> FlashToolbox;
+
+        const Evaluation& T = fluidState_.temperature(/*phaseIdx=*/0);
+
+        ScalarComponentVector cTotalScalar;
+        for (unsigned compIdx = 0; compIdx < numComponents; ++compIdx)
+            cTotalScalar[compIdx] = Opm::scalarValue(cTotal[compIdx]);
+
+        // the initial guess has already been set for the fluid state with evaluations
+        ScalarFluidState scalarFluidState;
+        scalarFluidState.assign(fluidState_);
+
+        typename FluidSystem::template ParameterCache<Scalar> scalarParamCache;
+        FlashSolver::template solve<MaterialLaw>(scalarFluidState,
+                                                 materialParams,
+                                                 scalarParamCache,
+                                                 cTotalScalar,
+                                                 flashTolerance);
+
+        // extract the unknowns of the flash from its solution
+        FlashVector x;
+        x[0] = scalarFluidState.pressure(/*phaseIdx=*/0);
+        for (unsigned phaseIdx = 0; phaseIdx < numPhases - 1; ++phaseIdx)
+            x[1 + phaseIdx] = scalarFluidState.saturation(phaseIdx);
+        for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx)
+            for (unsigned compIdx = 0; compIdx < numComponents; ++compIdx)
+                x[numPhases + phaseIdx*numComponents + compIdx] =
+                    scalarFluidState.moleFraction(phaseIdx, compIdx);
+
+        // the Jacobian of the flash equations with regard to the flash unknowns
+        Dune::FieldVector<FlashEval, numFlashEq> flashUnknowns;
+        Dune::FieldVector<FlashEval, numFlashEq> flashResid;
+        Dune::FieldVector<FlashEval, numComponents> flashCTotal;
+        for (unsigned i = 0; i < numFlashEq; ++i)
+            flashUnknowns[i] = FlashToolbox::createVariable(x[i], i);
+        for (unsigned compIdx = 0; compIdx < numComponents; ++compIdx)
+            flashCTotal[compIdx] = FlashToolbox::createConstant(cTotalScalar[compIdx]);
+        evalFlashResidual_(flashResid,
+                           flashUnknowns,
+                           FlashToolbox::createConstant(Opm::scalarValue(T)),
+                           flashCTotal,
+                           materialParams);
+
+        FlashMatrix J;
+        for (unsigned eqIdx = 0; eqIdx < numFlashEq; ++eqIdx)
+            for (unsigned i = 0; i < numFlashEq; ++i)
+                J[eqIdx][i] = flashResid[eqIdx].derivative(i);
+        J.invert();
+
+        // the derivatives of the flash equations with regard to the primary variables
+        // for fixed flash unknowns
+        Dune::FieldVector<Evaluation, numFlashEq> unknowns;
+        Dune::FieldVector<Evaluation, numFlashEq> resid;
+        for (unsigned i = 0; i < numFlashEq; ++i)
+            unknowns[i] = Toolbox::createConstant(x[i]);
+        evalFlashResidual_(resid, unknowns, T, cTotal, materialParams);
+
+        for (unsigned i = 0; i < numFlashEq; ++i) {
+            for (unsigned derivIdx = 0; derivIdx < numDerivatives; ++derivIdx) {
+                Scalar dx = 0.0;
+                for (unsigned eqIdx = 0; eqIdx < numFlashEq; ++eqIdx)
+                    dx -= J[i][eqIdx]*resid[eqIdx].derivative(derivIdx);
+                unknowns[i].setDerivative(derivIdx, dx);
+            }
+        }
+
+        assignFlashUnknowns_(fluidState_, paramCache, unknowns, materialParams);
+    }
+
+    // set the pressures, saturations and compositions of a fluid state from the
+    // unknowns of the flash and update the quantities which depend on them
+    template <class FluidStateT, class ParameterCacheT, class LhsEval>
+    static void assignFlashUnknowns_(FluidStateT& fluidState,
+                                     ParameterCacheT& paramCache,
+                                     const Dune::FieldVector<LhsEval, numFlashEq>& unknowns,
+                                     const MaterialLawParams& materialParams)
+    {
+        LhsEval lastSaturation = Opm::MathToolbox<LhsEval>::createConstant(1.0);
+        for (unsigned phaseIdx = 0; phaseIdx < numPhases - 1; ++phaseIdx) {
+            fluidState.setSaturation(phaseIdx, unknowns[1 + phaseIdx]);
+            lastSaturation -= unknowns[1 + phaseIdx];
+        }
+        fluidState.setSaturation(numPhases - 1, lastSaturation);
+
+        for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx)
+            for (unsigned compIdx = 0; compIdx < numComponents; ++compIdx)
+                fluidState.setMoleFraction(phaseIdx, compIdx,
+                                           unknowns[numPhases + phaseIdx*numComponents + compIdx]);
+
+        LhsEval pC[numPhases];
+        MaterialLaw::capillaryPressures(pC, materialParams, fluidState);
+        for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx)
+            fluidState.setPressure(phaseIdx, unknowns[0] + (pC[phaseIdx] - pC[0]));
+
+        paramCache.updateAll(fluidState);
+        for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
+            const LhsEval& rho = FluidSystem::density(fluidState, paramCache, phaseIdx);
+            fluidState.setDensity(phaseIdx, rho);
+
+            for (unsigned compIdx = 0; compIdx < numComponents; ++compIdx) {
+                const LhsEval& phi = FluidSystem::fugacityCoefficient(fluidState, paramCache, phaseIdx, compIdx);
+                fluidState.setFugacityCoefficient(phaseIdx, compIdx, phi);
+            }
+        }
+    }
+
+    // evaluate the equations which must be fulfilled by the solution of the flash
+    template <class LhsEval>
+    static void evalFlashResidual_(Dune::FieldVector<LhsEval, numFlashEq>& resid,
+                                   const Dune::FieldVector<LhsEval, numFlashEq>& unknowns,
+                                   const LhsEval& temperature,
+                                   const Dune::FieldVector<LhsEval, numComponents>& cTotal,
+                                   const MaterialLawParams& materialParams)
+    {
+        Opm::CompositionalFluidState<LhsEval, FluidSystem, /*storeEnthalpy=*/false> fluidState;
+        typename FluidSystem::template ParameterCache<LhsEval> paramCache;
+        fluidState.setTemperature(temperature);
+        assignFlashUnknowns_(fluidState, paramCache, unknowns, materialParams);
+
+        unsigned eqIdx = 0;
+
+        // the fugacity of each component is the same in all phases
+        for (unsigned phaseIdx = 1; phaseIdx < numPhases; ++phaseIdx)
+            for (unsigned compIdx = 0; compIdx < numComponents; ++compIdx)
+                resid[eqIdx++] = fluidState.fugacity(/*phaseIdx=*/0, compIdx) - fluidState.fugacity(phaseIdx, compIdx);
+
+        // the total molar concentration of each component is given
+        for (unsigned compIdx = 0; compIdx < numComponents; ++compIdx) {
+            resid[eqIdx] = -cTotal[compIdx];
+            for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx)
+                resid[eqIdx] += fluidState.saturation(phaseIdx)*fluidState.molarity(phaseIdx, compIdx);
+            ++eqIdx;
+        }
+
+        // either a phase is absent or its mole fractions sum up to one. the branch of
+        // the complementarity condition is chosen by the values at the solution
+        for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
+            LhsEval oneMinusSumX = Opm::MathToolbox<LhsEval>::createConstant(1.0);
+            for (unsigned compIdx = 0; compIdx < numComponents; ++compIdx)
+                oneMinusSumX -= fluidState.moleFraction(phaseIdx, compIdx);
+
+            const LhsEval& S = fluidState.saturation(phaseIdx);
+            if (Opm::scalarValue(S) < Opm::scalarValue(oneMinusSumX))
+                resid[eqIdx++] = S;
+            else
+                resid[eqIdx++] = oneMinusSumX;
+        }
+    }
+
     DimMatrix intrinsicPerm_;
     FluidState fluidState_;
     Evaluation porosity_;
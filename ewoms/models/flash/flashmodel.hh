@@ -41,6 +41,7 @@
 
 #include <ewoms/models/common/multiphasebasemodel.hh>
 #include <ewoms/models/common/energymodule.hh>
+#include <ewoms/models/common/flashwarmstartstore.hh>
 #include <ewoms/io/vtkcompositionmodule.hh>
 #include <ewoms/io/vtkenergymodule.hh>
 #include <ewoms/io/vtkdiffusionmodule.hh>
@@ -48,6 +49,7 @@
 #include <opm/material/fluidmatrixinteractions/MaterialTraits.hpp>
 #include <opm/material/constraintsolvers/NcpFlash.hpp>
 
+#include <iostream>
 #include <sstream>
 #include <string>
 
@@ -76,6 +78,9 @@ SET_TYPE_PROP(FlashModel, FlashSolver,
 //! Let the flash solver choose its tolerance by default
 SET_SCALAR_PROP(FlashModel, FlashTolerance, -1.0);
 
+//! Run the flash solver on the evaluations of the primary variables by default
+SET_BOOL_PROP(FlashModel, EnableScalarFlash, false);
+
 //! the Model property
 SET_TYPE_PROP(FlashModel, Model, Ewoms::FlashModel<TypeTag>);
 
@@ -185,7 +190,9 @@ class FlashModel
     typedef typename GET_PROP_TYPE(TypeTag, Simulator) Simulator;
 
     typedef typename GET_PROP_TYPE(TypeTag, Indices) Indices;
+    typedef typename GET_PROP_TYPE(TypeTag, IntensiveQuantities) IntensiveQuantities;
 
+    enum { numPhases = GET_PROP_VALUE(TypeTag, NumPhases) };
     enum { numComponents = GET_PROP_VALUE(TypeTag, NumComponents) };
     enum { enableDiffusion = GET_PROP_VALUE(TypeTag, EnableDiffusion) };
     enum { enableEnergy = GET_PROP_VALUE(TypeTag, EnableEnergy) };
@@ -194,9 +201,13 @@ class FlashModel
     typedef Ewoms::EnergyModule<TypeTag, enableEnergy> EnergyModule;
 
 public:
+    typedef Ewoms::FlashWarmStartStore<Scalar, numPhases, numComponents> WarmStartStore;
+
     FlashModel(Simulator& simulator)
         : ParentType(simulator)
-    {}
+    {
+        warmStartStoreSeqNum_ = -1;
+    }
 
     /*!
      * \brief Register all run-time parameters for the immiscible model.
@@ -217,6 +228,76 @@ public:
         EWOMS_REGISTER_PARAM(TypeTag, Scalar, FlashTolerance,
                              "The maximum tolerance for the flash solver to "
                              "consider the solution converged");
+        EWOMS_REGISTER_PARAM(TypeTag, bool, EnableScalarFlash,
+                             "Solve the flash using scalars and recover the derivatives "
+                             "with regard to the primary variables afterwards");
+    }
+
+    /*!
+     * \copydoc FvBaseDiscretization::finishInit()
+     */
+    void finishInit()
+    {
+        ParentType::finishInit();
+
+        warmStartStore_.resize(this->numGridDof());
+        warmStartStoreSeqNum_ = this->simulator_.vanguard().gridSequenceNumber();
+    }
+
+    void adaptGrid()
+    {
+        ParentType::adaptGrid();
+
+        // the stored initial guesses are meaningless if the grid was changed
+        int curSeqNum = this->simulator_.vanguard().gridSequenceNumber();
+        if (curSeqNum != warmStartStoreSeqNum_) {
+            warmStartStore_.resize(this->numGridDof());
+            warmStartStoreSeqNum_ = curSeqNum;
+        }
+    }
+
+    /*!
+     * \brief Returns the object which stores the initial guesses for the flash
+     *        calculations of the degrees of freedom.
+     */
+    WarmStartStore& warmStartStore() const
+    { return warmStartStore_; }
+
+    /*!
+     * \copydoc FvBaseDiscretization::updateCachedIntensiveQuantities
+     *
+     * This method is only called for the intensive quantities of the iterates of the
+     * Newton method, i.e., never for perturbed primary variables. Their fluid states
+     * are thus used as the initial guesses of the next flash calculations.
+     */
+    void updateCachedIntensiveQuantities(const IntensiveQuantities& intQuants,
+                                         unsigned globalIdx,
+                                         unsigned timeIdx) const
+    {
+        ParentType::updateCachedIntensiveQuantities(intQuants, globalIdx, timeIdx);
+
+        if (timeIdx == 0)
+            warmStartStore_.store(globalIdx, intQuants.fluidState());
+    }
+
+    /*!
+     * \copydoc FvBaseDiscretization::updateSuccessful
+     */
+    void updateSuccessful()
+    {
+        ParentType::updateSuccessful();
+        warmStartStore_.accept();
+        printWarmStartStatistics_();
+    }
+
+    /*!
+     * \copydoc FvBaseDiscretization::updateFailed
+     */
+    void updateFailed()
+    {
+        ParentType::updateFailed();
+        warmStartStore_.rollback();
+        printWarmStartStatistics_();
     }
 
     /*!
@@ -311,6 +392,23 @@ public:
         if (enableEnergy)
             this->addOutputModule(new Ewoms::VtkEnergyModule<TypeTag>(this->simulator_));
     }
+
+private:
+    // print how many of the flash calculations of the time step were warm started
+    void printWarmStartStatistics_()
+    {
+        const auto& comm = this->gridView_.comm();
+        unsigned long numSolves = comm.sum(warmStartStore_.numSolves());
+        unsigned long numWarmStarts = comm.sum(warmStartStore_.numWarmStarts());
+        warmStartStore_.resetStatistics();
+
+        if (EWOMS_GET_PARAM(TypeTag, bool, NewtonVerbose) && comm.rank() == 0)
+            std::cout << "Flash calculations: " << numSolves << ", warm started: "
+                      << numWarmStarts << "\n" << std::flush;
+    }
+
+    mutable WarmStartStore warmStartStore_;
+    int warmStartStoreSeqNum_;
 };
 
 } // namespace Ewoms
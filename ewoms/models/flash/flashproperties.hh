@@ -43,6 +43,8 @@ NEW_PROP_TAG(FluidSystem);
 NEW_PROP_TAG(FlashSolver);
 //! The maximum accepted error of the flash solver
 NEW_PROP_TAG(FlashTolerance);
+//! Solve the flash in scalar arithmetic and recover the derivatives afterwards
+NEW_PROP_TAG(EnableScalarFlash);
 
 //! The thermal conduction law which ought to be used
 NEW_PROP_TAG(ThermalConductionLaw);
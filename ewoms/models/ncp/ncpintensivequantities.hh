@@ -139,8 +139,15 @@ public:
         for (unsigned compIdx = 0; compIdx < numComponents; ++compIdx)
             fug[compIdx] = priVars.makeEvaluation(fugacity0Idx + compIdx, timeIdx);
 
-        // calculate phase compositions
+        // calculate phase compositions. if there is no thermodynamic hint, the
+        // compositions of the last converged solution for the degree of freedom are
+        // used as the initial guess if they are available
+        auto& warmStartStore = elemCtx.model().warmStartStore();
+        unsigned globalDofIdx = elemCtx.globalSpaceIndex(dofIdx, timeIdx);
         const auto *hint = elemCtx.thermodynamicHint(dofIdx, timeIdx);
+        bool warmStarted =
+            hint
+            || warmStartStore.load(fluidState_, globalDofIdx, timeIdx, /*loadSaturations=*/false);
         for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
             // initial guess
             if (hint) {
@@ -150,7 +157,7 @@ public:
                     fluidState_.setMoleFraction(phaseIdx, compIdx, moleFracIJ);
                 }
             }
-            else // !hint
+            else if (!warmStarted)
                 CompositionFromFugacitiesSolver::guessInitial(fluidState_, phaseIdx, fug);
 
             // calculate the phase composition from the component
@@ -158,6 +165,8 @@ public:
             CompositionFromFugacitiesSolver::solve(fluidState_, paramCache, phaseIdx, fug);
         }
 
+        warmStartStore.countSolve(warmStarted);
+
         // porosity
         porosity_ = problem.porosity(elemCtx, dofIdx, timeIdx);
         Opm::Valgrind::CheckDefined(porosity_);
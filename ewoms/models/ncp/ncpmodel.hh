@@ -43,6 +43,7 @@
 #include <ewoms/models/common/multiphasebasemodel.hh>
 #include <ewoms/models/common/energymodule.hh>
 #include <ewoms/models/common/diffusionmodule.hh>
+#include <ewoms/models/common/flashwarmstartstore.hh>
 #include <ewoms/io/vtkcompositionmodule.hh>
 #include <ewoms/io/vtkenergymodule.hh>
 #include <ewoms/io/vtkdiffusionmodule.hh>
@@ -52,6 +53,7 @@
 
 #include <dune/common/fvector.hh>
 
+#include <iostream>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -206,6 +208,7 @@ class NcpModel
     typedef typename GET_PROP_TYPE(TypeTag, ElementContext) ElementContext;
     typedef typename GET_PROP_TYPE(TypeTag, FluidSystem) FluidSystem;
     typedef typename GET_PROP_TYPE(TypeTag, Indices) Indices;
+    typedef typename GET_PROP_TYPE(TypeTag, IntensiveQuantities) IntensiveQuantities;
 
     enum { numPhases = FluidSystem::numPhases };
     enum { numComponents = FluidSystem::numComponents };
@@ -225,9 +228,13 @@ class NcpModel
     typedef Ewoms::DiffusionModule<TypeTag, enableDiffusion> DiffusionModule;
 
 public:
+    typedef Ewoms::FlashWarmStartStore<Scalar, numPhases, numComponents> WarmStartStore;
+
     NcpModel(Simulator& simulator)
         : ParentType(simulator)
-    {}
+    {
+        warmStartStoreSeqNum_ = -1;
+    }
 
     /*!
      * \brief Register all run-time parameters for the immiscible model.
@@ -258,12 +265,66 @@ public:
 
         minActivityCoeff_.resize(this->numGridDof());
         std::fill(minActivityCoeff_.begin(), minActivityCoeff_.end(), 1.0);
+
+        warmStartStore_.resize(this->numGridDof());
+        warmStartStoreSeqNum_ = this->simulator_.vanguard().gridSequenceNumber();
     }
 
     void adaptGrid()
     {
         ParentType::adaptGrid();
         minActivityCoeff_.resize(this->numGridDof());
+
+        // the stored initial guesses are meaningless if the grid was changed
+        int curSeqNum = this->simulator_.vanguard().gridSequenceNumber();
+        if (curSeqNum != warmStartStoreSeqNum_) {
+            warmStartStore_.resize(this->numGridDof());
+            warmStartStoreSeqNum_ = curSeqNum;
+        }
+    }
+
+    /*!
+     * \brief Returns the object which stores the initial guesses for the flash
+     *        calculations of the degrees of freedom.
+     */
+    WarmStartStore& warmStartStore() const
+    { return warmStartStore_; }
+
+    /*!
+     * \copydoc FvBaseDiscretization::updateCachedIntensiveQuantities
+     *
+     * This method is only called for the intensive quantities of the iterates of the
+     * Newton method, i.e., never for perturbed primary variables. Their fluid states
+     * are thus used as the initial guesses of the next flash calculations.
+     */
+    void updateCachedIntensiveQuantities(const IntensiveQuantities& intQuants,
+                                         unsigned globalIdx,
+                                         unsigned timeIdx) const
+    {
+        ParentType::updateCachedIntensiveQuantities(intQuants, globalIdx, timeIdx);
+
+        if (timeIdx == 0)
+            warmStartStore_.store(globalIdx, intQuants.fluidState());
+    }
+
+    /*!
+     * \copydoc FvBaseDiscretization::updateSuccessful
+     */
+    void updateSuccessful()
+    {
+        ParentType::updateSuccessful();
+        warmStartStore_.accept();
+        printWarmStartStatistics_();
+    }
+
+    /*!
+     * \copydoc FvBaseDiscretization::updateFailed
+     */
+    void updateFailed()
+    {
+        ParentType::updateFailed();
+        warmStartStore_.rollback();
+        printWarmStartStatistics_();
     }
 
     /*!
@@ -446,8 +507,23 @@ public:
             this->addOutputModule(new Ewoms::VtkEnergyModule<TypeTag>(this->simulator_));
     }
 
+    // print how many of the composition calculations of the time step were warm started
+    void printWarmStartStatistics_()
+    {
+        const auto& comm = this->gridView_.comm();
+        unsigned long numSolves = comm.sum(warmStartStore_.numSolves());
+        unsigned long numWarmStarts = comm.sum(warmStartStore_.numWarmStarts());
+        warmStartStore_.resetStatistics();
+
+        if (EWOMS_GET_PARAM(TypeTag, bool, NewtonVerbose) && comm.rank() == 0)
+            std::cout << "Composition calculations: " << numSolves << ", warm started: "
+                      << numWarmStarts << "\n" << std::flush;
+    }
+
     mutable Scalar referencePressure_;
     mutable std::vector<ComponentVector> minActivityCoeff_;
+    mutable WarmStartStore warmStartStore_;
+    int warmStartStoreSeqNum_;
 };
 
 } // namespace Ewoms
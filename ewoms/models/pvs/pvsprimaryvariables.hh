@@ -100,12 +100,7 @@ public:
      * \copydoc ImmisciblePrimaryVariables::ImmisciblePrimaryVariables(const
      * ImmisciblePrimaryVariables& )
      */
-    PvsPrimaryVariables(const PvsPrimaryVariables& value) : ParentType(value)
-    {
-        Opm::Valgrind::SetDefined(*this);
-
-        phasePresence_ = value.phasePresence_;
-    }
+    PvsPrimaryVariables(const PvsPrimaryVariables& value) = default;
 
     /*!
      * \copydoc ImmisciblePrimaryVariables::assignMassConservative
@@ -227,13 +222,7 @@ public:
     /*!
      * \brief Assignment operator from an other primary variables object
      */
-    ThisType& operator=(const Implementation& value)
-    {
-        ParentType::operator=(value);
-        phasePresence_ = value.phasePresence_;
-
-        return *this;
-    }
+    PvsPrimaryVariables& operator=(const PvsPrimaryVariables& value) = default;
 
     /*!
      * \brief Assignment operator from a scalar value
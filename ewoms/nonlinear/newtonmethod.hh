@@ -33,6 +33,7 @@
 #include <ewoms/common/parametersystem.hh>
 #include <ewoms/common/timer.hh>
 #include <ewoms/common/timerguard.hh>
+#include <ewoms/common/tracer.hh>
 
 #include <opm/material/densead/Math.hpp>
 #include <opm/material/common/Unused.hpp>
@@ -46,6 +47,8 @@
 
 #include <iostream>
 #include <sstream>
+#include <type_traits>
+#include <utility>
 
 #include <unistd.h>
 
@@ -146,6 +149,23 @@ NEW_PROP_TAG(NewtonTargetIterations);
 //! Number of maximum iterations for the Newton method.
 NEW_PROP_TAG(NewtonMaxIterations);
 
+/*!
+ * \brief The maximum number of consecutive iterations for which the Jacobian matrix and
+ *        the preconditioner of a previous iteration are reused.
+ *
+ * For such iterations, only the residual is evaluated (i.e., a chord Newton method is
+ * used). 0 disables reusing the Jacobian.
+ */
+NEW_PROP_TAG(NewtonMaxJacobianReuse);
+
+/*!
+ * \brief The maximum ratio between the errors of two consecutive iterations for which a
+ *        reused Jacobian matrix is considered to be accurate enough.
+ *
+ * If the error decreases slower, the system is linearized anew.
+ */
+NEW_PROP_TAG(NewtonJacobianReuseMaxContraction);
+
 // set default values for the properties
 SET_TYPE_PROP(NewtonMethod, NewtonMethod, Ewoms::NewtonMethod<TypeTag>);
 SET_TYPE_PROP(NewtonMethod, NewtonConvergenceWriter, Ewoms::NullConvergenceWriter<TypeTag>);
@@ -157,10 +177,28 @@ SET_SCALAR_PROP(NewtonMethod, NewtonRawTolerance, 1e-8);
 SET_SCALAR_PROP(NewtonMethod, NewtonMaxError, 1e100);
 SET_INT_PROP(NewtonMethod, NewtonTargetIterations, 10);
 SET_INT_PROP(NewtonMethod, NewtonMaxIterations, 18);
+SET_INT_PROP(NewtonMethod, NewtonMaxJacobianReuse, 0);
+SET_SCALAR_PROP(NewtonMethod, NewtonJacobianReuseMaxContraction, 0.5);
 
 END_PROPERTIES
 
 namespace Ewoms {
+//! \cond SKIP_THIS
+// determines whether a linear solver backend can replace the right hand side of the
+// linear system while keeping its matrix and preconditioner. this is only required if
+// the Jacobian matrix is reused.
+template <class LinearSolverBackend, class Vector, class Dummy = void>
+struct LinearSolverCanSetResidual_
+{ static const bool value = false; };
+
+template <class LinearSolverBackend, class Vector>
+struct LinearSolverCanSetResidual_<LinearSolverBackend,
+                                   Vector,
+                                   decltype(std::declval<LinearSolverBackend&>().setResidual(std::declval<Vector&>()),
+                                            void())>
+{ static const bool value = true; };
+//! \endcond
+
 /*!
  * \ingroup Newton
  * \brief The multi-dimensional Newton method.
@@ -189,6 +227,9 @@ class NewtonMethod
     typedef typename Dune::MPIHelper::MPICommunicator Communicator;
     typedef Dune::CollectiveCommunication<Communicator> CollectiveCommunication;
 
+    static const bool linearSolverCanSetResidual =
+        LinearSolverCanSetResidual_<LinearSolverBackend, GlobalEqVector>::value;
+
 public:
     NewtonMethod(Simulator& simulator)
         : simulator_(simulator)
@@ -202,6 +243,10 @@ public:
         tolerance_ = EWOMS_GET_PARAM(TypeTag, Scalar, NewtonRawTolerance);
 
         numIterations_ = 0;
+        numJacobianReuses_ = 0;
+        numConsecutiveJacobianReuses_ = 0;
+        totalJacobianReuses_ = 0;
+        totalJacobianReuseFallbacks_ = 0;
     }
 
     /*!
@@ -230,6 +275,14 @@ public:
         EWOMS_REGISTER_PARAM(TypeTag, Scalar, NewtonMaxError,
                              "The maximum error tolerated by the Newton "
                              "method to which does not cause an abort");
+        EWOMS_REGISTER_PARAM(TypeTag, int, NewtonMaxJacobianReuse,
+                             "The maximum number of consecutive Newton iterations "
+                             "which reuse the Jacobian matrix and the preconditioner "
+                             "of a previous iteration (0 = always relinearize)");
+        EWOMS_REGISTER_PARAM(TypeTag, Scalar, NewtonJacobianReuseMaxContraction,
+                             "The maximum ratio of the errors of two consecutive "
+                             "Newton iterations for which a reused Jacobian matrix "
+                             "is considered to be accurate enough");
     }
 
     /*!
@@ -289,6 +342,28 @@ public:
     void setIterationIndex(int value)
     { numIterations_ = value; }
 
+    /*!
+     * \brief Returns the number of iterations of the current or last invocation of
+     *        the Newton method which reused the Jacobian matrix of a previous one.
+     */
+    int numJacobianReuses() const
+    { return numJacobianReuses_; }
+
+    /*!
+     * \brief Returns the number of iterations which reused the Jacobian matrix of a
+     *        previous one since the start of the simulation.
+     */
+    long totalJacobianReuses() const
+    { return totalJacobianReuses_; }
+
+    /*!
+     * \brief Returns how often the system needed to be linearized anew since the start
+     *        of the simulation because a reused Jacobian matrix did not reduce the error
+     *        sufficiently.
+     */
+    long totalJacobianReuseFallbacks() const
+    { return totalJacobianReuseFallbacks_; }
+
     /*!
      * \brief Return the current tolerance at which the Newton method considers itself to
      *        be converged.
@@ -348,6 +423,8 @@ public:
             // execute the method as long as the implementation thinks
             // that we should do another iteration
             while (asImp_().proceed_()) {
+                Ewoms::TraceScope iterationTraceScope("newtonIteration", "newton");
+
                 // linearize the problem at the current solution
 
                 // notify the implementation that we're about to start
@@ -365,9 +442,14 @@ public:
                               << std::flush;
                 }
 
-                // do the actual linearization
+                // do the actual linearization. if the Jacobian matrix of a previous
+                // iteration is reused, only the residual needs to be evaluated.
+                bool reuseJacobian = asImp_().reuseJacobian_();
                 linearizeTimer_.start();
-                asImp_().linearizeDomain_();
+                if (reuseJacobian)
+                    asImp_().linearizeDomainResidual_();
+                else
+                    asImp_().linearizeDomain_();
                 linearizeTimer_.stop();
 
                 // notify the implementation of the successful linearization on order to
@@ -376,10 +458,45 @@ public:
                 updateTimer_.start();
                 auto& residual = linearizer.residual();
                 auto& jacobian = linearizer.jacobian();
-                linearSolver_.prepare(jacobian, residual);
+                {
+                    Ewoms::TraceScope prepareTraceScope("prepareLinearSolver", "newton");
+                    if (reuseJacobian)
+                        setLinearSolverResidual_(jacobian,
+                                                 residual,
+                                                 std::integral_constant<bool, linearSolverCanSetResidual>());
+                    else
+                        linearSolver_.prepare(jacobian, residual);
+                }
                 asImp_().preSolve_(currentSolution, linearizer.residual());
                 updateTimer_.stop();
 
+                if (reuseJacobian && !asImp_().jacobianReuseSucceeded_()) {
+                    // the old Jacobian did not reduce the error sufficiently. linearize
+                    // the system at the current solution after all. (the residual stays
+                    // the same, so the error does not need to be updated.)
+                    ++ totalJacobianReuseFallbacks_;
+                    reuseJacobian = false;
+
+                    linearizeTimer_.start();
+                    asImp_().linearizeDomain_();
+                    linearizeTimer_.stop();
+
+                    updateTimer_.start();
+                    {
+                        Ewoms::TraceScope prepareTraceScope("prepareLinearSolver", "newton");
+                        linearSolver_.prepare(jacobian, residual);
+                    }
+                    updateTimer_.stop();
+                }
+
+                if (reuseJacobian) {
+                    ++ numJacobianReuses_;
+                    ++ numConsecutiveJacobianReuses_;
+                    ++ totalJacobianReuses_;
+                }
+                else
+                    numConsecutiveJacobianReuses_ = 0;
+
                 asImp_().linearizeAuxiliaryEquations_();
 
                 if (!asImp_().proceed_()) {
@@ -407,7 +524,11 @@ public:
 
                 // solve A x = b, where b is the residual, A is its Jacobian and x is the
                 // update of the solution
-                bool converged = linearSolver_.solve(solutionUpdate);
+                bool converged;
+                {
+                    Ewoms::TraceScope solveTraceScope("linearSolve", "newton");
+                    converged = linearSolver_.solve(solutionUpdate);
+                }
                 solveTimer_.stop();
 
                 if (!converged) {
@@ -432,10 +553,13 @@ public:
                 // update the current solution (i.e. uOld) with the delta
                 // (i.e. u). The result is stored in u
                 updateTimer_.start();
-                asImp_().postSolve_(currentSolution,
-                                    residual,
-                                    solutionUpdate);
-                asImp_().update_(nextSolution, currentSolution, solutionUpdate, residual);
+                {
+                    Ewoms::TraceScope updateTraceScope("updateSolution", "newton");
+                    asImp_().postSolve_(currentSolution,
+                                        residual,
+                                        solutionUpdate);
+                    asImp_().update_(nextSolution, currentSolution, solutionUpdate, residual);
+                }
                 updateTimer_.stop();
 
                 if (asImp_().verbose_() && isatty(fileno(stdout)))
@@ -498,6 +622,9 @@ public:
                       << updateTimer_.realTimeElapsed() << "("
                       << 100 * updateTimer_.realTimeElapsed()/elapsedTot << "%)"
                       << "\n" << std::flush;
+            if (numJacobianReuses_ > 0)
+                std::cout << "Jacobian reused in " << numJacobianReuses_ << " of "
+                          << numIterations_ << " iterations\n" << std::flush;
         }
 
 
@@ -598,6 +725,8 @@ protected:
     void begin_(const SolutionVector& u  OPM_UNUSED)
     {
         numIterations_ = 0;
+        numJacobianReuses_ = 0;
+        numConsecutiveJacobianReuses_ = 0;
 
         if (EWOMS_GET_PARAM(TypeTag, bool, NewtonWriteConvergence))
             convergenceWriter_.beginTimeStep();
@@ -648,6 +777,56 @@ protected:
         model().linearizer().linearizeDomain();
     }
 
+    /*!
+     * \brief Evaluate the residual of the spatial domain for the current solution
+     *        without updating the Jacobian matrix.
+     */
+    void linearizeDomainResidual_()
+    {
+        model().linearizer().linearizeDomainResidual();
+    }
+
+    /*!
+     * \brief Returns true if the Jacobian matrix and the preconditioner of the previous
+     *        iteration ought to be reused for the current one.
+     *
+     * The Jacobian is never reused for the first iteration of a time step, for more
+     * than NewtonMaxJacobianReuse consecutive iterations, or if auxiliary equations
+     * are present, because these add their terms to the Jacobian matrix anyway. It is
+     * also never reused if the linear solver backend does not provide a
+     * setResidual(Vector&) method which replaces the right hand side of the linear
+     * system while keeping its matrix and preconditioner.
+     */
+    bool reuseJacobian_() const
+    {
+        if (!linearSolverCanSetResidual)
+            return false;
+
+        int maxReuse = EWOMS_GET_PARAM(TypeTag, int, NewtonMaxJacobianReuse);
+        if (maxReuse <= 0 || numIterations_ == 0)
+            return false;
+        else if (numConsecutiveJacobianReuses_ >= maxReuse)
+            return false;
+
+        return model().numAuxiliaryModules() == 0;
+    }
+
+    /*!
+     * \brief Returns true if the error of an iteration which reused the Jacobian matrix
+     *        was reduced sufficiently.
+     *
+     * This is called after preSolve_(), i.e., error_ is the error of the current
+     * solution while lastError_ is the one of the previous iteration.
+     */
+    bool jacobianReuseSucceeded_() const
+    {
+        if (asImp_().converged())
+            return true;
+
+        Scalar maxContraction = EWOMS_GET_PARAM(TypeTag, Scalar, NewtonJacobianReuseMaxContraction);
+        return error_ <= maxContraction*lastError_;
+    }
+
     void linearizeAuxiliaryEquations_()
     {
         model().linearizer().linearizeAuxiliaryEquations();
@@ -964,6 +1143,12 @@ protected:
     // actual number of iterations done so far
     int numIterations_;
 
+    // the number of iterations which reused the Jacobian matrix of a previous one
+    int numJacobianReuses_;
+    int numConsecutiveJacobianReuses_;
+    long totalJacobianReuses_;
+    long totalJacobianReuseFallbacks_;
+
     // the linear solver
     LinearSolverBackend linearSolver_;
 
@@ -976,6 +1161,20 @@ protected:
     ConvergenceWriter convergenceWriter_;
 
 private:
+    template <class Jacobian>
+    void setLinearSolverResidual_(Jacobian& jacobian OPM_UNUSED,
+                                  GlobalEqVector& residual,
+                                  std::true_type)
+    { linearSolver_.setResidual(residual); }
+
+    // the Jacobian is not reused if the linear solver backend cannot replace the
+    // residual, so this is never called
+    template <class Jacobian>
+    void setLinearSolverResidual_(Jacobian& jacobian,
+                                  GlobalEqVector& residual,
+                                  std::false_type)
+    { linearSolver_.prepare(jacobian, residual); }
+
     Implementation& asImp_()
     { return *static_cast<Implementation *>(this); }
     const Implementation& asImp_() const
@@ -0,0 +1,351 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \copydoc Ewoms::GridHaloExchange
+ */
+#ifndef EWOMS_GRID_HALO_EXCHANGE_HH
+#define EWOMS_GRID_HALO_EXCHANGE_HH
+
+#if HAVE_MPI
+#include <mpi.h>
+#endif
+
+#include <ewoms/common/tracer.hh>
+
+#include <opm/material/common/Unused.hpp>
+
+#include <dune/grid/common/datahandleif.hh>
+#include <dune/grid/common/gridenums.hh>
+
+#include <algorithm>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <map>
+#include <cassert>
+
+namespace Ewoms {
+
+/*!
+ * \brief Exchanges the values attached to the degrees of freedom on the process
+ *        boundaries using precomputed lists of indices.
+ *
+ * In contrast to the data handles of gridcommhandles.hh, the grid's generic
+ * communication mechanism is only used once to determine which degrees of freedom need
+ * to be sent to and received from which peer process. Afterwards, the values are packed
+ * into contiguous buffers and exchanged directly using non-blocking MPI.
+ *
+ * The index lists depend on the grid, so update() must be called each time the grid
+ * changes. This is supposed to happen in a sequential context.
+ */
+template <class GridView, class DofMapper, int commCodim>
+class GridHaloExchange
+{
+    typedef std::pair<int, unsigned> PeerDof; // (index on peer, local index)
+
+    // data handle which is used to find out the indices of the overlapping degrees of
+    // freedom on the peer processes
+    class SetupHandle_
+        : public Dune::CommDataHandleIF<SetupHandle_, int>
+    {
+    public:
+        SetupHandle_(const DofMapper& dofMapper,
+                     int myRank,
+                     std::map<int, std::vector<PeerDof> >& recvDofs)
+            : dofMapper_(dofMapper)
+            , myRank_(myRank)
+            , recvDofs_(recvDofs)
+        {}
+
+        bool contains(int dim OPM_UNUSED, int codim) const
+        { return codim == commCodim; }
+
+        bool fixedsize(int dim OPM_UNUSED, int codim OPM_UNUSED) const
+        { return true; }
+
+        template <class EntityType>
+        size_t size(const EntityType& e OPM_UNUSED) const
+        { return 2; }
+
+        template <class MessageBufferImp, class EntityType>
+        void gather(MessageBufferImp& buff, const EntityType& e) const
+        {
+            buff.write(myRank_);
+            buff.write(static_cast<int>(dofMapper_.index(e)));
+        }
+
+        template <class MessageBufferImp, class EntityType>
+        void scatter(MessageBufferImp& buff, const EntityType& e, size_t n OPM_UNUSED)
+        {
+            int peerRank;
+            int peerDofIdx;
+            buff.read(peerRank);
+            buff.read(peerDofIdx);
+
+            unsigned dofIdx = static_cast<unsigned>(dofMapper_.index(e));
+            recvDofs_[peerRank].push_back(PeerDof(peerDofIdx, dofIdx));
+        }
+
+    private:
+        const DofMapper& dofMapper_;
+        int myRank_;
+        std::map<int, std::vector<PeerDof> >& recvDofs_;
+    };
+
+public:
+    GridHaloExchange()
+        : isInitialized_(false)
+    {
+#if HAVE_MPI
+        comm_ = MPI_COMM_NULL;
+#endif
+    }
+
+    /*!
+     * \brief Returns true if the index lists have been set up.
+     */
+    bool isInitialized() const
+    { return isInitialized_; }
+
+    /*!
+     * \brief Determine the indices which must be exchanged with each peer process.
+     *
+     * \param gridView The grid view on which the degrees of freedom are defined
+     * \param dofMapper The mapper from the grid entities to the degrees of freedom
+     * \param iface The Dune communication interface which the exchange ought to emulate
+     *              (using forward communication)
+     */
+    void update(const GridView& gridView,
+                const DofMapper& dofMapper,
+                Dune::InterfaceType iface = Dune::InteriorBorder_All_Interface)
+    {
+        peerRanks_.clear();
+        sendIndices_.clear();
+        recvIndices_.clear();
+        isInitialized_ = true;
+
+#if HAVE_MPI
+        // the peer ranks are the ones of the grid's communicator, which is not
+        // necessarily MPI_COMM_WORLD
+        comm_ = static_cast<MPI_Comm>(gridView.comm());
+
+        int numRanks = gridView.comm().size();
+        if (numRanks < 2)
+            return;
+
+        int myRank = gridView.comm().rank();
+
+        // use the grid's communication to find out which of the local degrees of
+        // freedom get their values from which index of which peer process
+        std::map<int, std::vector<PeerDof> > recvDofs;
+        SetupHandle_ setupHandle(dofMapper, myRank, recvDofs);
+        gridView.communicate(setupHandle, iface, Dune::ForwardCommunication);
+
+        // the order of the received values is given by the index on the peer process
+        std::vector<int> numRecv(static_cast<size_t>(numRanks), 0);
+        for (auto& peerEntry : recvDofs) {
+            auto& peerDofs = peerEntry.second;
+            std::sort(peerDofs.begin(), peerDofs.end());
+            numRecv[static_cast<size_t>(peerEntry.first)] = static_cast<int>(peerDofs.size());
+        }
+
+        // tell every process how many values it is expected to send to us
+        std::vector<int> numSend(static_cast<size_t>(numRanks), 0);
+        MPI_Alltoall(numRecv.data(), 1, MPI_INT,
+                     numSend.data(), 1, MPI_INT,
+                     comm_);
+
+        // send the requested indices to the peers and receive the indices which are
+        // requested from us
+        std::vector<MPI_Request> requests;
+        std::map<int, std::vector<int> > requestedIndices;
+        for (int peerRank = 0; peerRank < numRanks; ++peerRank) {
+            int n = numSend[static_cast<size_t>(peerRank)];
+            if (n == 0)
+                continue;
+
+            auto& indices = requestedIndices[peerRank];
+            indices.resize(static_cast<size_t>(n));
+            requests.emplace_back();
+            MPI_Irecv(indices.data(), n, MPI_INT, peerRank, setupTag_, comm_,
+                      &requests.back());
+        }
+
+        std::map<int, std::vector<int> > wantedIndices;
+        for (const auto& peerEntry : recvDofs) {
+            int peerRank = peerEntry.first;
+            auto& indices = wantedIndices[peerRank];
+            std::vector<unsigned> localIndices;
+            for (const auto& peerDof : peerEntry.second) {
+                indices.push_back(peerDof.first);
+                localIndices.push_back(peerDof.second);
+            }
+            recvIndices_[peerRank] = std::move(localIndices);
+
+            requests.emplace_back();
+            MPI_Isend(indices.data(), static_cast<int>(indices.size()), MPI_INT, peerRank,
+                      setupTag_, comm_, &requests.back());
+        }
+
+        MPI_Waitall(static_cast<int>(requests.size()), requests.data(), MPI_STATUSES_IGNORE);
+
+        for (const auto& peerEntry : requestedIndices) {
+            std::vector<unsigned> localIndices(peerEntry.second.begin(),
+                                               peerEntry.second.end());
+            sendIndices_[peerEntry.first] = std::move(localIndices);
+        }
+
+        // the set of peer processes
+        for (const auto& peerEntry : sendIndices_)
+            peerRanks_.push_back(peerEntry.first);
+        for (const auto& peerEntry : recvIndices_)
+            peerRanks_.push_back(peerEntry.first);
+        std::sort(peerRanks_.begin(), peerRanks_.end());
+        peerRanks_.erase(std::unique(peerRanks_.begin(), peerRanks_.end()), peerRanks_.end());
+#endif // HAVE_MPI
+    }
+
+    /*!
+     * \brief Set the values of the received degrees of freedom to the ones of their
+     *        respective master process.
+     *
+     * This is the equivalent of using a GridCommHandleGhostSync data handle.
+     */
+    template <class Container>
+    void sync(Container& container) const
+    {
+        typedef typename std::decay<decltype(container[0])>::type ValueType;
+        exchange_<ValueType>(container,
+                             [](ValueType& dest, const ValueType& src)
+                             { dest = src; });
+    }
+
+    /*!
+     * \brief Add the values of the peer processes to the ones of the received degrees
+     *        of freedom.
+     *
+     * This is the equivalent of using a GridCommHandleSum data handle.
+     */
+    template <class Container>
+    void syncAdd(Container& container) const
+    {
+        typedef typename std::decay<decltype(container[0])>::type ValueType;
+        exchange_<ValueType>(container,
+                             [](ValueType& dest, const ValueType& src)
+                             { dest += src; });
+    }
+
+    /*!
+     * \brief Returns the number of processes with which data is exchanged.
+     */
+    size_t numPeers() const
+    { return peerRanks_.size(); }
+
+private:
+    template <class ValueType, class Container, class ScatterFn>
+    void exchange_(Container& container OPM_UNUSED, ScatterFn scatter OPM_UNUSED) const
+    {
+        static_assert(std::is_trivially_copyable<ValueType>::value,
+                      "The values exchanged by the halo exchange are sent as raw bytes "
+                      "and thus must be trivially copyable");
+
+        assert(isInitialized_);
+
+#if HAVE_MPI
+        if (peerRanks_.empty())
+            return;
+
+        Ewoms::TraceScope traceScope("haloExchange", "communication");
+
+        std::vector<MPI_Request> recvRequests;
+        std::vector<MPI_Request> sendRequests;
+        std::vector<std::vector<ValueType> > recvBuffers(recvIndices_.size());
+        std::vector<std::vector<ValueType> > sendBuffers(sendIndices_.size());
+
+        // post all receives before starting to pack the send buffers
+        unsigned bufferIdx = 0;
+        for (const auto& peerEntry : recvIndices_) {
+            auto& buffer = recvBuffers[bufferIdx++];
+            buffer.resize(peerEntry.second.size());
+
+            recvRequests.emplace_back();
+            MPI_Irecv(buffer.data(),
+                      static_cast<int>(buffer.size()*sizeof(ValueType)),
+                      MPI_BYTE,
+                      peerEntry.first,
+                      exchangeTag_,
+                      comm_,
+                      &recvRequests.back());
+        }
+
+        // gather the values which are sent from the local process. this happens before
+        // any value is scattered, i.e., the peer processes get the original values.
+        bufferIdx = 0;
+        for (const auto& peerEntry : sendIndices_) {
+            const auto& indices = peerEntry.second;
+            auto& buffer = sendBuffers[bufferIdx++];
+            buffer.resize(indices.size());
+            for (unsigned i = 0; i < indices.size(); ++i)
+                buffer[i] = container[indices[i]];
+
+            sendRequests.emplace_back();
+            MPI_Isend(buffer.data(),
+                      static_cast<int>(buffer.size()*sizeof(ValueType)),
+                      MPI_BYTE,
+                      peerEntry.first,
+                      exchangeTag_,
+                      comm_,
+                      &sendRequests.back());
+        }
+
+        MPI_Waitall(static_cast<int>(recvRequests.size()), recvRequests.data(), MPI_STATUSES_IGNORE);
+
+        bufferIdx = 0;
+        for (const auto& peerEntry : recvIndices_) {
+            const auto& indices = peerEntry.second;
+            const auto& buffer = recvBuffers[bufferIdx++];
+            for (unsigned i = 0; i < indices.size(); ++i)
+                scatter(container[indices[i]], buffer[i]);
+        }
+
+        MPI_Waitall(static_cast<int>(sendRequests.size()), sendRequests.data(), MPI_STATUSES_IGNORE);
+#endif // HAVE_MPI
+    }
+
+    static const int setupTag_ = 4271;
+    static const int exchangeTag_ = 4272;
+
+    bool isInitialized_;
+#if HAVE_MPI
+    MPI_Comm comm_;
+#endif
+    std::vector<int> peerRanks_;
+    std::map<int, std::vector<unsigned> > sendIndices_;
+    std::map<int, std::vector<unsigned> > recvIndices_;
+};
+
+} // namespace Ewoms
+
+#endif
@@ -30,8 +30,14 @@
 #include <stdexcept>
 #include <cassert>
 #include <thread>
-#include <queue>
+#include <deque>
+#include <chrono>
+#include <cstdint>
 #include <mutex>
+#include <atomic>
+#include <future>
+#include <memory>
+#include <vector>
 #include <iostream>
 #include <condition_variable>
 
@@ -48,18 +54,21 @@ public:
     TaskletInterface(int refCount = 1)
         : referenceCount_(refCount)
     {}
+    TaskletInterface(const TaskletInterface& other)
+        : referenceCount_(other.referenceCount())
+    {}
     virtual ~TaskletInterface() {}
     virtual void run() = 0;
-    virtual bool isEndMarker () const { return false; }
 
     void dereference()
     { -- referenceCount_; }
 
     int referenceCount() const
-    { return referenceCount_; }
+    { return referenceCount_.load(); }
 
 private:
-    int referenceCount_;
+    // the invocations of a tasklet may be run by multiple worker threads concurrently
+    std::atomic<int> referenceCount_;
 };
 
 /*!
@@ -82,6 +91,151 @@ private:
     const Fn& fn_;
 };
 
+/*!
+ * \brief A double-ended queue for work stealing.
+ *
+ * The thread which owns the queue pushes and pops objects at its bottom, while all other
+ * threads may only steal objects from its top. None of these operations requires a
+ * lock. This is the algorithm by Chase and Lev using the memory orderings proposed by Le
+ * et al. (PPoPP 2013).
+ *
+ * The queue only stores pointers and does not take ownership of the objects.
+ */
+template <class T>
+class WorkStealingDeque_
+{
+    class Array_
+    {
+    public:
+        Array_(size_t capacity)
+            : capacity_(capacity)
+            , items_(new std::atomic<T*>[capacity])
+        {}
+
+        size_t capacity() const
+        { return capacity_; }
+
+        T* get(int64_t idx) const
+        { return items_[static_cast<size_t>(idx) & (capacity_ - 1)].load(std::memory_order_relaxed); }
+
+        void put(int64_t idx, T* item)
+        { items_[static_cast<size_t>(idx) & (capacity_ - 1)].store(item, std::memory_order_relaxed); }
+
+    private:
+        size_t capacity_;
+        std::unique_ptr<std::atomic<T*>[]> items_;
+    };
+
+public:
+    WorkStealingDeque_(size_t initialCapacity = 64)
+        : top_(0)
+        , bottom_(0)
+    {
+        // the capacity must be a power of two
+        assert(initialCapacity > 0 && (initialCapacity & (initialCapacity - 1)) == 0);
+
+        arrays_.emplace_back(new Array_(initialCapacity));
+        array_.store(arrays_.back().get(), std::memory_order_relaxed);
+    }
+
+    WorkStealingDeque_(const WorkStealingDeque_&) = delete;
+
+    /*!
+     * \brief Add an object at the bottom of the queue.
+     *
+     * This may only be called by the thread which owns the queue.
+     */
+    void push(T* item)
+    {
+        int64_t b = bottom_.load(std::memory_order_relaxed);
+        int64_t t = top_.load(std::memory_order_acquire);
+        Array_* a = array_.load(std::memory_order_relaxed);
+        if (b - t > static_cast<int64_t>(a->capacity()) - 1)
+            a = grow_(a, t, b);
+
+        a->put(b, item);
+        std::atomic_thread_fence(std::memory_order_release);
+        bottom_.store(b + 1, std::memory_order_relaxed);
+    }
+
+    /*!
+     * \brief Remove the object at the bottom of the queue.
+     *
+     * This may only be called by the thread which owns the queue. If the queue is empty,
+     * nullptr is returned.
+     */
+    T* pop()
+    {
+        int64_t b = bottom_.load(std::memory_order_relaxed) - 1;
+        Array_* a = array_.load(std::memory_order_relaxed);
+        bottom_.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t t = top_.load(std::memory_order_relaxed);
+
+        if (t > b) {
+            // the queue is empty
+            bottom_.store(b + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        T* item = a->get(b);
+        if (t == b) {
+            // this is the last object, so we compete with the stealing threads for it
+            if (!top_.compare_exchange_strong(t, t + 1,
+                                              std::memory_order_seq_cst,
+                                              std::memory_order_relaxed))
+                item = nullptr;
+            bottom_.store(b + 1, std::memory_order_relaxed);
+        }
+
+        return item;
+    }
+
+    /*!
+     * \brief Remove the object at the top of the queue.
+     *
+     * This may be called by any thread. If the queue is empty or if another thread was
+     * faster, nullptr is returned.
+     */
+    T* steal()
+    {
+        int64_t t = top_.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t b = bottom_.load(std::memory_order_acquire);
+
+        if (t >= b)
+            return nullptr;
+
+        Array_* a = array_.load(std::memory_order_acquire);
+        T* item = a->get(t);
+        if (!top_.compare_exchange_strong(t, t + 1,
+                                          std::memory_order_seq_cst,
+                                          std::memory_order_relaxed))
+            return nullptr;
+
+        return item;
+    }
+
+private:
+    Array_* grow_(Array_* oldArray, int64_t t, int64_t b)
+    {
+        // stealing threads may still access the old array, so it is only deleted when
+        // the queue is destroyed.
+        arrays_.emplace_back(new Array_(2*oldArray->capacity()));
+        Array_* newArray = arrays_.back().get();
+        for (int64_t i = t; i < b; ++i)
+            newArray->put(i, oldArray->get(i));
+
+        array_.store(newArray, std::memory_order_release);
+        return newArray;
+    }
+
+    std::atomic<int64_t> top_;
+    std::atomic<int64_t> bottom_;
+    std::atomic<Array_*> array_;
+    std::vector<std::unique_ptr<Array_> > arrays_;
+};
+
 class TaskletRunner;
 
 // this class stores the thread local static attributes for the TaskletRunner class. we
@@ -106,59 +260,43 @@ thread_local int TaskletRunnerHelper_<Dummy>::workerThreadIndex_ = -1;
  *
  * Depending on the number of worker threads, a tasklet can either be run in a separate
  * worker thread or by the main thread.
+ *
+ * Each worker thread owns a work stealing queue: Tasklets which are dispatched by a
+ * worker thread are put into its own queue and idle worker threads steal from the queues
+ * of the others. Tasklets which are dispatched by any other thread are put into a common
+ * queue, which is processed in first-in-first-out order. This means that tasklets which
+ * are dispatched by the main thread are run in order if there is a single worker thread.
  */
 class TaskletRunner
 {
-    /// \brief Implements a barrier. This class can only be used in the asynchronous case.
-    class BarrierTasklet : public TaskletInterface
+    // a single invocation of a tasklet
+    struct Job_
     {
-    public:
-        BarrierTasklet(unsigned numWorkers)
-            : TaskletInterface(/*refCount=*/numWorkers)
-        {
-            numWorkers_ = numWorkers;
-            numWaiting_ = 0;
-        }
-
-        void run()
-        { wait(); }
-
-        void wait()
-        {
-            std::unique_lock<std::mutex> lock(barrierMutex_);
-
-            numWaiting_ += 1;
-            if (numWaiting_ >= numWorkers_ + 1) {
-                lock.unlock();
-                barrierCondition_.notify_all();
-            }
-            else {
-                const auto& areAllWaiting =
-                    [this]() -> bool
-                    { return this->numWaiting_ >= this->numWorkers_ + 1; };
-
-                barrierCondition_.wait(lock, /*predicate=*/areAllWaiting);
-            }
-        }
-
-    private:
-        unsigned numWorkers_;
-        unsigned numWaiting_;
+        Job_(const std::shared_ptr<TaskletInterface>& t)
+            : tasklet(t)
+        {}
 
-        std::condition_variable barrierCondition_;
-        std::mutex barrierMutex_;
+        std::shared_ptr<TaskletInterface> tasklet;
     };
 
-    /// \brief TerminateThreadTasklet class
-    /// Empty tasklet marking thread termination.
-    class TerminateThreadTasklet : public TaskletInterface
+    // a tasklet which provides the result of a function via a future
+    template <class ResultType>
+    class PackagedTaskTasklet_ : public TaskletInterface
     {
     public:
-        void run()
-        { }
+        template <class Fn>
+        PackagedTaskTasklet_(Fn fn)
+            : task_(fn)
+        {}
+
+        std::future<ResultType> future()
+        { return task_.get_future(); }
 
-        bool isEndMarker() const
-        { return true; }
+        void run() override
+        { task_(); }
+
+    private:
+        std::packaged_task<ResultType()> task_;
     };
 
 public:
@@ -173,6 +311,15 @@ public:
      */
     TaskletRunner(unsigned numWorkers)
     {
+        numPendingInvocations_ = 0;
+        numPendingWaiters_ = 0;
+        numQueuedJobs_ = 0;
+        numSleepingWorkers_ = 0;
+        stopRequested_ = false;
+
+        for (unsigned i = 0; i < numWorkers; ++i)
+            queues_.emplace_back(new WorkStealingDeque_<Job_>());
+
         threads_.resize(numWorkers);
         for (unsigned i = 0; i < numWorkers; ++i)
             // create a worker thread
@@ -189,8 +336,11 @@ public:
     ~TaskletRunner()
     {
         if (threads_.size() > 0) {
-            // dispatch a tasklet which will terminate the worker thread
-            dispatch(std::make_shared<TerminateThreadTasklet>());
+            // complete all dispatched tasklets before terminating the worker threads
+            waitUntilPendingAtMost(0);
+
+            stopRequested_ = true;
+            wakeWorkers_(/*numJobs=*/threads_.size(), /*force=*/true);
 
             // wait until all worker threads have terminated
             for (auto& thread : threads_)
@@ -219,7 +369,9 @@ public:
     /*!
      * \brief Add a new tasklet.
      *
-     * The tasklet is either run immediately or deferred to a separate thread.
+     * The tasklet is either run immediately or deferred to a separate thread. If the
+     * tasklet needs to be run multiple times, the individual invocations may be run by
+     * different worker threads concurrently.
      */
     void dispatch(std::shared_ptr<TaskletInterface> tasklet)
     {
@@ -239,16 +391,29 @@ public:
             }
         }
         else {
-            // lock mutex for the tasklet queue to make sure that nobody messes with the
-            // task queue
-            taskletQueueMutex_.lock();
+            int numInvocations = tasklet->referenceCount();
+            if (numInvocations <= 0)
+                return;
 
-            // add the tasklet to the queue
-            taskletQueue_.push(tasklet);
+            // account for the tasklet before a worker thread can possibly complete it
+            numPendingInvocations_ += static_cast<unsigned>(numInvocations);
 
-            taskletQueueMutex_.unlock();
+            int workerIdx = workerThreadIndex();
+            if (workerIdx >= 0) {
+                // tasklets dispatched by a worker thread go to its own queue. if the other
+                // worker threads are idle, they will steal them from there.
+                auto& queue = *queues_[static_cast<size_t>(workerIdx)];
+                for (int i = 0; i < numInvocations; ++i)
+                    queue.push(new Job_(tasklet));
+            }
+            else {
+                std::lock_guard<std::mutex> lock(commonQueueMutex_);
+                for (int i = 0; i < numInvocations; ++i)
+                    commonQueue_.push_back(new Job_(tasklet));
+            }
 
-            workAvailableCondition_.notify_all();
+            numQueuedJobs_ += numInvocations;
+            wakeWorkers_(static_cast<unsigned>(numInvocations));
         }
     }
 
@@ -264,21 +429,81 @@ public:
         return tasklet;
     }
 
+    /*!
+     * \brief Dispatch a function and return a future for its result.
+     *
+     * Exceptions thrown by the function are not printed but passed on to the future.
+     * Worker threads which need the result of a nested tasklet should use wait() instead
+     * of blocking on the future.
+     */
+    template <class Fn>
+    auto dispatchWithFuture(Fn fn) -> std::future<decltype(fn())>
+    {
+        typedef decltype(fn()) ResultType;
+        typedef PackagedTaskTasklet_<ResultType> Tasklet;
+
+        auto tasklet = std::make_shared<Tasklet>(fn);
+        auto future = tasklet->future();
+        this->dispatch(tasklet);
+        return future;
+    }
+
+    /*!
+     * \brief Wait until a future becomes ready and return its result.
+     *
+     * If this is called by a worker thread, it runs other tasklets in the mean time.
+     * This avoids dead locks if the future belongs to a tasklet which was dispatched by
+     * the worker thread itself.
+     */
+    template <class ResultType>
+    ResultType wait(std::future<ResultType>& future)
+    {
+        int workerIdx = workerThreadIndex();
+        if (workerIdx >= 0) {
+            while (future.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+                Job_* job = findJob_(static_cast<unsigned>(workerIdx));
+                if (job)
+                    runJob_(job);
+                else
+                    std::this_thread::yield();
+            }
+        }
+
+        return future.get();
+    }
+
     /*!
      * \brief Make sure that all tasklets have been completed after this method has been called
+     *
+     * This must not be called from within a tasklet.
      */
     void barrier()
+    { waitUntilPendingAtMost(0); }
+
+    /*!
+     * \brief Wait until at most a given number of tasklet invocations are still
+     *        outstanding.
+     *
+     * In contrast to barrier(), this allows to pipeline the work, e.g., to keep a new
+     * output request in flight while the previous one is still being written. In
+     * synchronous mode, this method returns immediately. Like barrier(), this must not be
+     * called from within a tasklet.
+     */
+    void waitUntilPendingAtMost(unsigned maxPending)
     {
-        unsigned numWorkers = threads_.size();
-        if (numWorkers == 0)
-            // nothing needs to be done to implement a barrier in synchronous mode
+        if (threads_.empty())
             return;
 
-        // dispatch a barrier tasklet and wait until it has been run by the worker thread
-        auto barrierTasklet = std::make_shared<BarrierTasklet>(numWorkers);
-        dispatch(barrierTasklet);
+        assert(workerThreadIndex() < 0);
+
+        std::unique_lock<std::mutex> lock(pendingMutex_);
+        ++ numPendingWaiters_;
+        const auto& isDone =
+            [this, maxPending]() -> bool
+            { return this->numPendingInvocations_.load() <= maxPending; };
 
-        barrierTasklet->wait();
+        pendingCondition_.wait(lock, /*predicate=*/isDone);
+        -- numPendingWaiters_;
     }
 
 protected:
@@ -288,60 +513,129 @@ protected:
         TaskletRunnerHelper_<void>::taskletRunner_ = taskletRunner;
         TaskletRunnerHelper_<void>::workerThreadIndex_ = workerThreadIndex;
 
-        taskletRunner->run_();
+        taskletRunner->run_(static_cast<unsigned>(workerThreadIndex));
     }
 
-    //! do the work until the queue received an end tasklet
-    void run_()
+    //! do the work until the tasklet runner is destroyed
+    void run_(unsigned workerIdx)
     {
+        // the number of unsuccessful attempts to find work after which the thread goes
+        // to sleep
+        static const int maxIdleRounds = 64;
+
+        int numIdleRounds = 0;
         while (true) {
-            // wait until tasklets have been pushed to the queue. first we need to lock
-            // mutex for access to taskletQueue_
-            std::unique_lock<std::mutex> lock(taskletQueueMutex_);
+            Job_* job = findJob_(workerIdx);
+            if (job) {
+                runJob_(job);
+                numIdleRounds = 0;
+                continue;
+            }
 
-            const auto& workIsAvailable =
+            if (stopRequested_)
+                return;
+
+            // spin a bit before going to sleep, so that fine grained work which is
+            // dispatched in quick succession does not need to wake up the thread
+            if (++ numIdleRounds < maxIdleRounds) {
+                std::this_thread::yield();
+                continue;
+            }
+            numIdleRounds = 0;
+
+            std::unique_lock<std::mutex> lock(sleepMutex_);
+            ++ numSleepingWorkers_;
+            const auto& mustWakeUp =
                 [this]() -> bool
-                { return !taskletQueue_.empty(); };
+                { return this->numQueuedJobs_.load() > 0 || this->stopRequested_.load(); };
 
-            if (!workIsAvailable())
-                workAvailableCondition_.wait(lock, /*predicate=*/workIsAvailable);
+            workAvailableCondition_.wait(lock, /*predicate=*/mustWakeUp);
+            -- numSleepingWorkers_;
+        }
+    }
 
-            // remove tasklet from queue
-            std::shared_ptr<TaskletInterface> tasklet = taskletQueue_.front();
+    // take a job from the worker's own queue, from the common queue or from the queue of
+    // another worker (in that order). returns nullptr if no job is available.
+    Job_* findJob_(unsigned workerIdx)
+    {
+        Job_* job = queues_[workerIdx]->pop();
 
-            // if tasklet is an end marker, terminate the thread and DO NOT remove the
-            // tasklet.
-            if (tasklet->isEndMarker()) {
-                if(taskletQueue_.size() > 1)
-                    throw std::logic_error("TaskletRunner: Not all queued tasklets were executed");
-                taskletQueueMutex_.unlock();
-                return;
+        if (!job) {
+            std::lock_guard<std::mutex> lock(commonQueueMutex_);
+            if (!commonQueue_.empty()) {
+                job = commonQueue_.front();
+                commonQueue_.pop_front();
             }
+        }
 
-            tasklet->dereference();
-            if (tasklet->referenceCount() == 0)
-                // remove tasklets from the queue as soon as their reference count
-                // reaches zero, i.e. the tasklet has been run often enough.
-                taskletQueue_.pop();
-            lock.unlock();
+        for (unsigned i = 1; !job && i < queues_.size(); ++i)
+            job = queues_[(workerIdx + i) % queues_.size()]->steal();
 
-            // execute tasklet
-            try {
-                tasklet->run();
-            }
-            catch (const std::exception& e) {
-                std::cerr << "ERROR: Uncaught std::exception when running tasklet: " << e.what() << ". Trying to continue.\n";
-            }
-            catch (...) {
-                std::cerr << "ERROR: Uncaught exception when running tasklet. Trying to continue.\n";
-            }
+        if (job)
+            -- numQueuedJobs_;
+
+        return job;
+    }
+
+    void runJob_(Job_* job)
+    {
+        std::shared_ptr<TaskletInterface> tasklet = std::move(job->tasklet);
+        delete job;
+
+        tasklet->dereference();
+        try {
+            tasklet->run();
+        }
+        catch (const std::exception& e) {
+            std::cerr << "ERROR: Uncaught std::exception when running tasklet: " << e.what() << ". Trying to continue.\n";
+        }
+        catch (...) {
+            std::cerr << "ERROR: Uncaught exception when running tasklet. Trying to continue.\n";
+        }
+
+        -- numPendingInvocations_;
+        if (numPendingWaiters_.load() > 0) {
+            // make sure that the waiting thread either has not checked the number of
+            // pending invocations yet or is already waiting for the notification
+            { std::lock_guard<std::mutex> lock(pendingMutex_); }
+            pendingCondition_.notify_all();
         }
     }
 
+    void wakeWorkers_(unsigned numJobs, bool force = false)
+    {
+        if (!force && numSleepingWorkers_.load() == 0)
+            return;
+
+        // make sure that sleeping workers either have not checked for work yet or are
+        // already waiting for the notification
+        { std::lock_guard<std::mutex> lock(sleepMutex_); }
+        if (numJobs == 1)
+            workAvailableCondition_.notify_one();
+        else
+            workAvailableCondition_.notify_all();
+    }
+
     std::vector<std::unique_ptr<std::thread> > threads_;
-    std::queue<std::shared_ptr<TaskletInterface> > taskletQueue_;
-    std::mutex taskletQueueMutex_;
+
+    // the work stealing queues of the worker threads and the queue for the tasklets
+    // dispatched by other threads
+    std::vector<std::unique_ptr<WorkStealingDeque_<Job_> > > queues_;
+    std::deque<Job_*> commonQueue_;
+    std::mutex commonQueueMutex_;
+
+    // the number of jobs in all queues, used to decide whether a worker may go to sleep
+    std::atomic<int> numQueuedJobs_;
+    std::atomic<unsigned> numSleepingWorkers_;
+    std::atomic<bool> stopRequested_;
+    std::mutex sleepMutex_;
     std::condition_variable workAvailableCondition_;
+
+    // the number of dispatched tasklet invocations which have not been completed yet
+    std::atomic<unsigned> numPendingInvocations_;
+    std::atomic<unsigned> numPendingWaiters_;
+    std::mutex pendingMutex_;
+    std::condition_variable pendingCondition_;
 };
 
 } // end namespace Opm
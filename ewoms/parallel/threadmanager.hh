@@ -31,6 +31,7 @@
 #include <omp.h>
 #endif
 
+#include <ewoms/common/hugepageallocator.hh>
 #include <ewoms/common/parametersystem.hh>
 #include <ewoms/common/propertysystem.hh>
 
@@ -38,9 +39,23 @@
 
 #include <dune/common/version.hh>
 
+#ifdef __linux__
+#include <sched.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#endif
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
 BEGIN_PROPERTIES
 
 NEW_PROP_TAG(ThreadsPerProcess);
+NEW_PROP_TAG(ThreadPinning);
 
 END_PROPERTIES
 
@@ -70,6 +85,10 @@ public:
         EWOMS_REGISTER_PARAM(TypeTag, int, ThreadsPerProcess,
                              "The maximum number of threads to be instantiated per process "
                              "('-1' means 'automatic')");
+        EWOMS_REGISTER_PARAM(TypeTag, std::string, ThreadPinning,
+                             "Specify how the threads are bound to CPU cores. Possible values: "
+                             "'none', 'compact' (fill one NUMA node after the other) and "
+                             "'scatter' (distribute the threads evenly over the NUMA nodes)");
     }
 
     static void init()
@@ -103,6 +122,107 @@ public:
 
         numThreads_ = omp_get_max_threads();
 #endif
+
+        const std::string& pinning = EWOMS_GET_PARAM(TypeTag, std::string, ThreadPinning);
+        if (pinning != "none" && pinning != "compact" && pinning != "scatter")
+            throw std::invalid_argument("Unknown value '"+pinning+"' for the thread-pinning "
+                                        "parameter. Valid values are 'none', 'compact' and "
+                                        "'scatter'");
+
+        threadNumaNode_.clear();
+        if (pinning != "none")
+            pinThreads_(/*scatter=*/pinning == "scatter");
+    }
+
+    /*!
+     * \brief Distribute the memory pages of an array over the NUMA nodes of the threads.
+     *
+     * The array is split into one contiguous block per thread and the pages of each
+     * block are moved to the NUMA node on which the respective thread runs. This has the
+     * same effect as if the block was first touched by its thread, but it also works for
+     * containers which are initialized by the main thread.
+     *
+     * This is only done if the threads are pinned and if they run on more than a single
+     * NUMA node. Otherwise, or if the operating system does not support it, this method
+     * is a no-op.
+     *
+     * Arrays which were allocated by hugePageAlloc() at huge page boundaries are moved
+     * in units of whole huge pages. Moving their individual 4 KiB pages would make the
+     * kernel split the huge pages.
+     */
+    static void distributeMemory(const void* data, size_t numBytes)
+    {
+#if defined(__linux__) && defined(SYS_move_pages)
+        if (!isNumaDistributed_())
+            return;
+
+        size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        if (isInHugePageBlock(data))
+            pageSize = hugePageSize;
+
+        uintptr_t begin = reinterpret_cast<uintptr_t>(data);
+        uintptr_t end = begin + numBytes;
+        // only move the pages which are completely occupied by the array
+        begin = (begin + pageSize - 1)/pageSize*pageSize;
+        end = end/pageSize*pageSize;
+        if (end <= begin)
+            return;
+
+        size_t numPages = (end - begin)/pageSize;
+        size_t numThreads = threadNumaNode_.size();
+        if (numPages < numThreads)
+            return;
+
+        std::vector<void*> pages;
+        std::vector<int> nodes;
+        pages.reserve(numPages);
+        nodes.reserve(numPages);
+        for (size_t pageIdx = 0; pageIdx < numPages; ++pageIdx) {
+            int node = threadNumaNode_[pageIdx*numThreads/numPages];
+            if (node < 0)
+                // the thread could not be pinned
+                continue;
+
+            pages.push_back(reinterpret_cast<void*>(begin + pageIdx*pageSize));
+            nodes.push_back(node);
+        }
+
+        // MPOL_MF_MOVE from <linux/mempolicy.h>: only move the pages which are
+        // exclusively used by the current process. failures are not critical, they only
+        // lead to non-local memory accesses.
+        const int moveExclusivePages = 1 << 1;
+        std::vector<int> status(pages.size());
+        syscall(SYS_move_pages, /*pid=*/0, pages.size(), pages.data(), nodes.data(),
+                status.data(), moveExclusivePages);
+#else
+        (void) data;
+        (void) numBytes;
+#endif
+    }
+
+    /*!
+     * \brief Distribute the memory pages of the entries of a contiguous container over
+     *        the NUMA nodes of the threads.
+     *
+     * \copydetails distributeMemory()
+     */
+    template <class Container>
+    static void distributeContainer(const Container& container)
+    {
+        if (container.size() > 0)
+            distributeMemory(&container[0], container.size()*sizeof(container[0]));
+    }
+
+    /*!
+     * \brief Return the NUMA node on which a given thread runs.
+     *
+     * If this is unknown, e.g. because the threads are not pinned, -1 is returned.
+     */
+    static int numaNode(unsigned threadId)
+    {
+        if (threadId >= threadNumaNode_.size())
+            return -1;
+        return threadNumaNode_[threadId];
     }
 
     /*!
@@ -124,11 +244,142 @@ public:
     }
 
 private:
+    // bind each thread to a single CPU core. the pinning persists for all following
+    // parallel regions because the OpenMP runtime reuses its threads.
+    static void pinThreads_(bool scatter)
+    {
+#ifdef __linux__
+        // only use the cores on which the process is allowed to run, e.g. because the
+        // MPI launcher bound each process to a socket
+        cpu_set_t allowedCpus;
+        CPU_ZERO(&allowedCpus);
+        if (sched_getaffinity(/*pid=*/0, sizeof(allowedCpus), &allowedCpus) != 0)
+            return;
+
+        const auto& nodeCpus = numaNodeCpus_(allowedCpus);
+
+        // the order in which the cores get assigned to threads as (cpu, NUMA node) pairs
+        std::vector<std::pair<int, int> > cpuOrder;
+        if (scatter) {
+            size_t maxCpusPerNode = 0;
+            for (const auto& node : nodeCpus)
+                maxCpusPerNode = std::max(maxCpusPerNode, node.second.size());
+
+            for (size_t i = 0; i < maxCpusPerNode; ++i)
+                for (const auto& node : nodeCpus)
+                    if (i < node.second.size())
+                        cpuOrder.emplace_back(node.second[i], node.first);
+        }
+        else {
+            for (const auto& node : nodeCpus)
+                for (int cpu : node.second)
+                    cpuOrder.emplace_back(cpu, node.first);
+        }
+
+        if (cpuOrder.empty())
+            return;
+
+        threadNumaNode_.resize(static_cast<size_t>(numThreads_), -1);
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+        {
+            unsigned threadId = ThreadManager::threadId();
+            const auto& cpu = cpuOrder[threadId % cpuOrder.size()];
+
+            cpu_set_t cpuSet;
+            CPU_ZERO(&cpuSet);
+            CPU_SET(cpu.first, &cpuSet);
+            // a pid of 0 refers to the calling thread
+            if (sched_setaffinity(/*pid=*/0, sizeof(cpuSet), &cpuSet) == 0)
+                threadNumaNode_[threadId] = cpu.second;
+        }
+#else
+        (void) scatter;
+#endif
+    }
+
+    // returns true if the threads are pinned to cores of more than a single NUMA node
+    static bool isNumaDistributed_()
+    {
+        for (int node : threadNumaNode_)
+            if (node >= 0 && node != threadNumaNode_[0])
+                return true;
+        return false;
+    }
+
+#ifdef __linux__
+    // returns the allowed CPU cores of each NUMA node as (node index, cores) pairs. if
+    // the NUMA topology is unknown, all cores are attributed to node 0.
+    static std::vector<std::pair<int, std::vector<int> > > numaNodeCpus_(const cpu_set_t& allowedCpus)
+    {
+        std::vector<std::pair<int, std::vector<int> > > result;
+
+        const std::string sysfsDir("/sys/devices/system/node/");
+        for (int node : parseCpuList_(readFirstLine_(sysfsDir + "online"))) {
+            std::vector<int> cpus;
+            for (int cpu : parseCpuList_(readFirstLine_(sysfsDir + "node" + std::to_string(node) + "/cpulist")))
+                if (0 <= cpu && cpu < CPU_SETSIZE && CPU_ISSET(cpu, &allowedCpus))
+                    cpus.push_back(cpu);
+
+            if (!cpus.empty())
+                result.emplace_back(node, cpus);
+        }
+
+        if (result.empty()) {
+            std::vector<int> cpus;
+            for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+                if (CPU_ISSET(cpu, &allowedCpus))
+                    cpus.push_back(cpu);
+            result.emplace_back(0, cpus);
+        }
+
+        return result;
+    }
+
+    static std::string readFirstLine_(const std::string& fileName)
+    {
+        std::ifstream is(fileName);
+        std::string line;
+        std::getline(is, line);
+        return line;
+    }
+
+    // parse a list of the form "0-3,8,10-11" as used by the Linux kernel
+    static std::vector<int> parseCpuList_(const std::string& list)
+    {
+        std::vector<int> result;
+        std::istringstream is(list);
+        std::string range;
+        while (std::getline(is, range, ',')) {
+            if (range.empty())
+                continue;
+
+            size_t dashPos = range.find('-');
+            try {
+                int first = std::stoi(range.substr(0, dashPos));
+                int last = (dashPos == std::string::npos) ? first : std::stoi(range.substr(dashPos + 1));
+                for (int i = first; i <= last; ++i)
+                    result.push_back(i);
+            }
+            catch (const std::exception&) {
+                return std::vector<int>();
+            }
+        }
+
+        return result;
+    }
+#endif
+
     static int numThreads_;
+    static std::vector<int> threadNumaNode_;
 };
 
 template <class TypeTag>
 int ThreadManager<TypeTag>::numThreads_ = 1;
+
+template <class TypeTag>
+std::vector<int> ThreadManager<TypeTag>::threadNumaNode_;
 } // namespace Ewoms
 
 #endif
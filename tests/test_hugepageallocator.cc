@@ -0,0 +1,163 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \brief This file tests the huge page allocator and the memory arena.
+ */
+#include "config.h"
+
+#include <ewoms/common/hugepageallocator.hh>
+#include <ewoms/common/memoryarena.hh>
+
+#include <dune/common/fvector.hh>
+#include <dune/istl/bvector.hh>
+
+#include <cstdint>
+#include <iostream>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+template <class Vector>
+void checkVector(Vector& v, size_t n, size_t alignment)
+{
+    v.resize(n);
+    std::iota(v.begin(), v.end(), 0.0);
+
+    if (reinterpret_cast<std::uintptr_t>(v.data()) % alignment != 0)
+        throw std::logic_error("Memory is not aligned correctly");
+
+    // if huge pages were requested, large arrays must start at a huge page boundary
+    if (Ewoms::hugePageMode() != Ewoms::HugePageMode::None
+        && n*sizeof(v[0]) >= Ewoms::hugePageSize
+        && reinterpret_cast<std::uintptr_t>(v.data()) % Ewoms::hugePageSize != 0)
+        throw std::logic_error("Large array does not start at a huge page boundary");
+
+    double sum = std::accumulate(v.begin(), v.end(), 0.0);
+    if (sum != 0.5*n*(n - 1))
+        throw std::logic_error("Wrong content of the vector");
+}
+
+int main()
+{
+    typedef Ewoms::HugePageAllocator<double, 64> HugePageAllocator;
+    typedef Ewoms::ArenaAllocator<double, 64> ArenaAllocator;
+
+    for (auto mode : { Ewoms::HugePageMode::None,
+                       Ewoms::HugePageMode::Transparent,
+                       Ewoms::HugePageMode::Explicit })
+    {
+        Ewoms::setHugePageMode(mode);
+
+        // small and large allocations
+        for (size_t n : { 10, 1000*1000, 3*1000*1000 }) {
+            std::vector<double, HugePageAllocator> v;
+            checkVector(v, n, 64);
+
+            // the pages of large arrays must only be moved as whole huge pages if they
+            // were mapped at huge page boundaries
+            bool isMapped =
+                mode != Ewoms::HugePageMode::None
+                && n*sizeof(double) >= Ewoms::hugePageSize;
+            if (Ewoms::isInHugePageBlock(v.data()) != isMapped
+                || Ewoms::isInHugePageBlock(&v.back()) != isMapped)
+                throw std::logic_error("Mapped huge page blocks are not detected correctly");
+        }
+
+        // the global vectors of the discretizations use the allocator for their blocks
+        typedef Dune::FieldVector<double, 3> Block;
+        Dune::BlockVector<Block, Ewoms::HugePageAllocator<Block> > blockVector(200*1000);
+        blockVector = 1.0;
+        if (blockVector.two_norm2() != 3*200*1000)
+            throw std::logic_error("Wrong content of the block vector");
+
+        // objects which are not trivially constructible
+        std::vector<std::string, Ewoms::HugePageAllocator<std::string> > strings(1000, "foo");
+        if (strings.back() != "foo")
+            throw std::logic_error("Wrong content of the string vector");
+
+        // allocations from an arena
+        Ewoms::MemoryArena arena(/*chunkSize=*/1024*1024);
+        {
+            std::vector<double, ArenaAllocator> v1{ArenaAllocator(&arena)};
+            std::vector<double, ArenaAllocator> v2{ArenaAllocator(&arena)};
+            std::vector<double, ArenaAllocator> v3{ArenaAllocator(&arena)};
+            checkVector(v1, 17, 64);
+            checkVector(v2, 100*1000, 64);
+            checkVector(v3, 1000*1000, 64);
+
+            // copy assignment within the same arena reuses the memory
+            std::vector<double, ArenaAllocator> v4(1000*1000, 0.0, ArenaAllocator(&arena));
+            size_t bytesUsed = arena.bytesUsed();
+            const double* data = v4.data();
+            v4 = v3;
+            if (v4.data() != data || arena.bytesUsed() != bytesUsed)
+                throw std::logic_error("Copy assignment allocated new memory");
+            if (v4 != v3)
+                throw std::logic_error("Copy assignment is wrong");
+        }
+        if (arena.bytesReserved() < arena.bytesUsed())
+            throw std::logic_error("The arena hands out more memory than it reserved");
+
+        arena.release();
+        if (arena.bytesUsed() != 0 || arena.bytesReserved() != 0)
+            throw std::logic_error("The memory of the arena was not released");
+
+        // the arena can be used again after it was released
+        std::vector<double, ArenaAllocator> v{ArenaAllocator(&arena)};
+        checkVector(v, 1000, 64);
+    }
+
+    // memory must be released correctly even if the huge page mode was changed after it
+    // was allocated
+    for (auto mode : { Ewoms::HugePageMode::Transparent,
+                       Ewoms::HugePageMode::Explicit })
+    {
+        Ewoms::setHugePageMode(mode);
+        std::vector<double, HugePageAllocator> mappedVector;
+        checkVector(mappedVector, 1000*1000, 64);
+
+        Ewoms::setHugePageMode(Ewoms::HugePageMode::None);
+        std::vector<double, HugePageAllocator> plainVector;
+        checkVector(plainVector, 1000*1000, 64);
+
+        Ewoms::setHugePageMode(mode);
+    }
+    Ewoms::setHugePageMode(Ewoms::HugePageMode::None);
+
+    bool caught = false;
+    try {
+        Ewoms::parseHugePageMode("foo");
+    }
+    catch (const std::invalid_argument&) {
+        caught = true;
+    }
+    if (!caught)
+        throw std::logic_error("Invalid huge page mode was accepted");
+
+    std::cout << "all huge page allocator tests passed" << std::endl;
+
+    return 0;
+}
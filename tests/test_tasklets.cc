@@ -74,6 +74,23 @@ void sleepAndPrintFunction()
 
 int SleepTasklet::numInstantiated_ = 0;
 
+// recursively sum up the integers in [begin, end) by dispatching nested tasklets
+long parallelSum(long begin, long end);
+long parallelSum(long begin, long end)
+{
+    if (end - begin < 1000) {
+        long sum = 0;
+        for (long i = begin; i < end; ++i)
+            sum += i;
+        return sum;
+    }
+
+    long mid = (begin + end)/2;
+    auto lowerFuture = runner->dispatchWithFuture([begin, mid]() { return parallelSum(begin, mid); });
+    long upperSum = parallelSum(mid, end);
+    return runner->wait(lowerFuture) + upperSum;
+}
+
 int main()
 {
     int numWorkers = 2;
@@ -93,6 +110,30 @@ int main()
     runner->barrier();
     std::cout << "after barrier" << std::endl;
 
+    // keep at most one tasklet in flight while dispatching new ones
+    for (int i = 0; i < 3; ++ i) {
+        runner->waitUntilPendingAtMost(1);
+        runner->dispatch(std::make_shared<SleepTasklet>(50));
+    }
+    runner->waitUntilPendingAtMost(0);
+    std::cout << "all pipelined tasklets completed" << std::endl;
+
+    // fine grained nested tasklets which are distributed by work stealing
+    long n = 1000*1000;
+    auto sumFuture = runner->dispatchWithFuture([n]() { return parallelSum(0, n); });
+    long sum = runner->wait(sumFuture);
+    if (sum != n*(n - 1)/2)
+        throw std::logic_error("The result of the nested tasklets is wrong");
+    std::cout << "nested tasklets completed" << std::endl;
+
+    // exceptions are passed on to the future
+    auto throwingFuture = runner->dispatchWithFuture([]() -> int { throw std::runtime_error("expected"); });
+    try {
+        runner->wait(throwingFuture);
+        throw std::logic_error("The exception of the tasklet was not passed on");
+    }
+    catch (const std::runtime_error&) {}
+
     runner->dispatchFunction(sleepAndPrintFunction);
     runner->dispatchFunction(sleepAndPrintFunction, /*numInvokations=*/6);
 